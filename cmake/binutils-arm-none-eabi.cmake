@@ -19,6 +19,8 @@
 ## CMake arm-none-eabi binutils integration and helper functions
 ##
 
+# Get the path of this module
+set(BINUTILS_MODULE_DIR ${CMAKE_CURRENT_LIST_DIR})
 
 #---------------------------------------------------------------------------------------
 # Set tools
@@ -48,3 +50,20 @@ endfunction()
 function(create_bin_output TARGET)
     add_custom_target(${TARGET}.bin ALL DEPENDS ${TARGET} COMMAND ${CMAKE_OBJCOPY} -Obinary ${TARGET} ${TARGET}.bin)
 endfunction()
+
+#---------------------------------------------------------------------------------------
+# Creates a <target>.footprint target generating a per module flash/RAM usage report
+# (<target>.footprint.csv) out of the linker map file.
+# When FOOTPRINT_BASELINE points to a previously generated report the differences are
+# printed and written to <target>.footprint.csv.diff.csv
+#---------------------------------------------------------------------------------------
+function(create_footprint_report TARGET)
+    set(FOOTPRINT_BASELINE "" CACHE FILEPATH "Baseline footprint report used for comparison")
+    add_custom_target(${TARGET}.footprint DEPENDS ${TARGET}
+        COMMAND ${CMAKE_COMMAND}
+            -DMAP_FILE=${CMAKE_CURRENT_BINARY_DIR}/${CMAKE_PROJECT_NAME}.map
+            -DREPORT_FILE=${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.footprint.csv
+            -DBASELINE_FILE=${FOOTPRINT_BASELINE}
+            -P ${BINUTILS_MODULE_DIR}/footprint-report.cmake
+    )
+endfunction()
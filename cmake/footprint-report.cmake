@@ -0,0 +1,230 @@
+##
+##   ______                              _
+##  / _____)             _              | |
+## ( (____  _____ ____ _| |_ _____  ____| |__
+##  \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+##  _____) ) ____| | | || |_| ____( (___| | | |
+## (______/|_____)_|_|_| \__)_____)\____)_| |_|
+## (C)2013-2017 Semtech
+##  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+## / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+## \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+## |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+## embedded.connectivity.solutions.==============
+##
+## License:  Revised BSD License, see LICENSE.TXT file included in the project
+## Authors:  Johannes Bruder ( STACKFORCE ), Miguel Luis ( Semtech )
+##
+##
+## Flash/RAM footprint report generator.
+##
+## Parses the GNU ld map file of a linked target and reports the flash and RAM
+## consumed by every input object, grouped by the CMake object library it comes
+## from (mac, radio, system, peripherals, board, application, toolchain).
+## Only the input sections kept by the linker are accounted, so the report
+## reflects the effect of --gc-sections.
+##
+## Usage:
+##   cmake -DMAP_FILE=<file.map> -DREPORT_FILE=<report.csv>
+##         [-DBASELINE_FILE=<previous report.csv>] -P footprint-report.cmake
+##
+## The report is a CSV file with the columns "module,object,flash,ram". The
+## last rows hold the per module totals (object "*") and the global total
+## (module "TOTAL"). When a baseline report is given the differences are
+## printed and written to <report>.diff.csv
+##
+
+# math(EXPR) hexadecimal input support
+cmake_minimum_required(VERSION 3.13)
+
+if(NOT DEFINED MAP_FILE OR NOT EXISTS ${MAP_FILE})
+    message(FATAL_ERROR "Footprint: map file not found (MAP_FILE=${MAP_FILE})")
+endif()
+if(NOT DEFINED REPORT_FILE)
+    message(FATAL_ERROR "Footprint: REPORT_FILE not defined")
+endif()
+
+#---------------------------------------------------------------------------------------
+# Returns the module and object names of a map file input object path
+#---------------------------------------------------------------------------------------
+function(footprint_classify_object PATH MODULE_VAR OBJECT_VAR)
+    if(PATH MATCHES "CMakeFiles/([^/]+)\\.dir/(.+)\\.(o|obj)$")
+        set(${MODULE_VAR} ${CMAKE_MATCH_1} PARENT_SCOPE)
+        set(${OBJECT_VAR} ${CMAKE_MATCH_2} PARENT_SCOPE)
+    elseif(PATH MATCHES "([^/\\\\]+\\.a)\\(([^)]+)\\)$")
+        set(${MODULE_VAR} "toolchain" PARENT_SCOPE)
+        set(${OBJECT_VAR} "${CMAKE_MATCH_1}:${CMAKE_MATCH_2}" PARENT_SCOPE)
+    else()
+        get_filename_component(OBJECT_NAME ${PATH} NAME)
+        set(${MODULE_VAR} "toolchain" PARENT_SCOPE)
+        set(${OBJECT_VAR} ${OBJECT_NAME} PARENT_SCOPE)
+    endif()
+endfunction()
+
+#---------------------------------------------------------------------------------------
+# Map file parsing
+#---------------------------------------------------------------------------------------
+file(STRINGS ${MAP_FILE} MAP_LINES)
+
+set(IN_MEMORY_MAP FALSE)
+set(PENDING_SECTION "")
+set(OBJECT_KEYS "")
+
+foreach(LINE IN LISTS MAP_LINES)
+    if(NOT IN_MEMORY_MAP)
+        # Skip the "Discarded input sections" part
+        if(LINE MATCHES "^Linker script and memory map")
+            set(IN_MEMORY_MAP TRUE)
+        endif()
+        continue()
+    endif()
+
+    if(LINE MATCHES "^ ([.A-Za-z_][^ ]*)$")
+        # Long section names are printed alone, the address/size follow on the next line
+        set(PENDING_SECTION ${CMAKE_MATCH_1})
+        continue()
+    endif()
+
+    if(NOT LINE MATCHES "^ ([.A-Za-z_][^ ]*)?[ ]+0x[0-9a-fA-F]+[ ]+(0x[0-9a-fA-F]+) (.+)$")
+        set(PENDING_SECTION "")
+        continue()
+    endif()
+
+    set(SECTION "${CMAKE_MATCH_1}")
+    set(SIZE_HEX ${CMAKE_MATCH_2})
+    string(STRIP "${CMAKE_MATCH_3}" OBJECT_PATH)
+    if("${SECTION}" STREQUAL "")
+        set(SECTION "${PENDING_SECTION}")
+    endif()
+    set(PENDING_SECTION "")
+
+    if(SECTION MATCHES "^\\.(text|rodata|isr_vector|ARM|glue_7|vfp11_veneer|v4_bx|init|fini|preinit_array|init_array|fini_array)")
+        set(SECTION_KIND FLASH)
+    elseif(SECTION MATCHES "^\\.data")
+        set(SECTION_KIND DATA)
+    elseif(SECTION MATCHES "^(\\.bss|COMMON)")
+        set(SECTION_KIND RAM)
+    else()
+        # Debug information, comments, attributes...
+        continue()
+    endif()
+
+    math(EXPR SIZE "${SIZE_HEX}")
+    if(SIZE EQUAL 0)
+        continue()
+    endif()
+
+    footprint_classify_object("${OBJECT_PATH}" MODULE OBJECT)
+    string(MAKE_C_IDENTIFIER "${MODULE}/${OBJECT}" KEY)
+    if(NOT DEFINED FP_FLASH_${KEY})
+        list(APPEND OBJECT_KEYS ${KEY})
+        set(FP_MODULE_${KEY} ${MODULE})
+        set(FP_OBJECT_${KEY} ${OBJECT})
+        set(FP_FLASH_${KEY} 0)
+        set(FP_RAM_${KEY} 0)
+    endif()
+
+    if(SECTION_KIND STREQUAL FLASH)
+        math(EXPR FP_FLASH_${KEY} "${FP_FLASH_${KEY}} + ${SIZE}")
+    elseif(SECTION_KIND STREQUAL RAM)
+        math(EXPR FP_RAM_${KEY} "${FP_RAM_${KEY}} + ${SIZE}")
+    else()
+        # Initialized data lives in RAM and has its initial values stored in flash
+        math(EXPR FP_FLASH_${KEY} "${FP_FLASH_${KEY}} + ${SIZE}")
+        math(EXPR FP_RAM_${KEY} "${FP_RAM_${KEY}} + ${SIZE}")
+    endif()
+endforeach()
+
+if(NOT IN_MEMORY_MAP)
+    message(FATAL_ERROR "Footprint: ${MAP_FILE} is not a GNU ld map file")
+endif()
+
+#---------------------------------------------------------------------------------------
+# Report generation
+#---------------------------------------------------------------------------------------
+set(MODULES "")
+set(TOTAL_FLASH 0)
+set(TOTAL_RAM 0)
+set(REPORT "module,object,flash,ram\n")
+
+list(SORT OBJECT_KEYS)
+foreach(KEY IN LISTS OBJECT_KEYS)
+    set(MODULE ${FP_MODULE_${KEY}})
+    if(NOT DEFINED MODULE_FLASH_${MODULE})
+        list(APPEND MODULES ${MODULE})
+        set(MODULE_FLASH_${MODULE} 0)
+        set(MODULE_RAM_${MODULE} 0)
+    endif()
+    math(EXPR MODULE_FLASH_${MODULE} "${MODULE_FLASH_${MODULE}} + ${FP_FLASH_${KEY}}")
+    math(EXPR MODULE_RAM_${MODULE} "${MODULE_RAM_${MODULE}} + ${FP_RAM_${KEY}}")
+    string(APPEND REPORT "${MODULE},${FP_OBJECT_${KEY}},${FP_FLASH_${KEY}},${FP_RAM_${KEY}}\n")
+endforeach()
+
+foreach(MODULE IN LISTS MODULES)
+    math(EXPR TOTAL_FLASH "${TOTAL_FLASH} + ${MODULE_FLASH_${MODULE}}")
+    math(EXPR TOTAL_RAM "${TOTAL_RAM} + ${MODULE_RAM_${MODULE}}")
+    string(APPEND REPORT "${MODULE},*,${MODULE_FLASH_${MODULE}},${MODULE_RAM_${MODULE}}\n")
+    message(STATUS "Footprint: ${MODULE} flash ${MODULE_FLASH_${MODULE}} ram ${MODULE_RAM_${MODULE}}")
+endforeach()
+string(APPEND REPORT "TOTAL,*,${TOTAL_FLASH},${TOTAL_RAM}\n")
+message(STATUS "Footprint: TOTAL flash ${TOTAL_FLASH} ram ${TOTAL_RAM}")
+
+file(WRITE ${REPORT_FILE} "${REPORT}")
+
+#---------------------------------------------------------------------------------------
+# Baseline comparison
+#---------------------------------------------------------------------------------------
+if(NOT DEFINED BASELINE_FILE OR BASELINE_FILE STREQUAL "")
+    return()
+endif()
+if(NOT EXISTS ${BASELINE_FILE})
+    message(WARNING "Footprint: baseline ${BASELINE_FILE} not found, comparison skipped")
+    return()
+endif()
+
+# Loads a report into <PREFIX>_KEYS, <PREFIX>_FLASH_<key> and <PREFIX>_RAM_<key>
+macro(footprint_load_report FILE PREFIX)
+    file(STRINGS ${FILE} REPORT_LINES)
+    set(${PREFIX}_KEYS "")
+    foreach(REPORT_LINE IN LISTS REPORT_LINES)
+        if(REPORT_LINE MATCHES "^([^,]+),([^,]+),([0-9]+),([0-9]+)$")
+            set(ROW_ID "${CMAKE_MATCH_1},${CMAKE_MATCH_2}")
+            string(MAKE_C_IDENTIFIER "${ROW_ID}" ROW_KEY)
+            list(APPEND ${PREFIX}_KEYS ${ROW_KEY})
+            set(${PREFIX}_ID_${ROW_KEY} ${ROW_ID})
+            set(${PREFIX}_FLASH_${ROW_KEY} ${CMAKE_MATCH_3})
+            set(${PREFIX}_RAM_${ROW_KEY} ${CMAKE_MATCH_4})
+        endif()
+    endforeach()
+endmacro()
+
+footprint_load_report(${BASELINE_FILE} BASE)
+footprint_load_report(${REPORT_FILE} CUR)
+
+set(ALL_KEYS ${BASE_KEYS} ${CUR_KEYS})
+list(REMOVE_DUPLICATES ALL_KEYS)
+
+set(DIFF "module,object,flash,ram,flash_delta,ram_delta\n")
+foreach(KEY IN LISTS ALL_KEYS)
+    foreach(PREFIX BASE CUR)
+        if(NOT DEFINED ${PREFIX}_FLASH_${KEY})
+            set(${PREFIX}_FLASH_${KEY} 0)
+            set(${PREFIX}_RAM_${KEY} 0)
+        endif()
+    endforeach()
+    if(DEFINED CUR_ID_${KEY})
+        set(ROW_ID ${CUR_ID_${KEY}})
+    else()
+        set(ROW_ID ${BASE_ID_${KEY}})
+    endif()
+    math(EXPR FLASH_DELTA "${CUR_FLASH_${KEY}} - ${BASE_FLASH_${KEY}}")
+    math(EXPR RAM_DELTA "${CUR_RAM_${KEY}} - ${BASE_RAM_${KEY}}")
+    if(NOT FLASH_DELTA EQUAL 0 OR NOT RAM_DELTA EQUAL 0)
+        string(APPEND DIFF "${ROW_ID},${CUR_FLASH_${KEY}},${CUR_RAM_${KEY}},${FLASH_DELTA},${RAM_DELTA}\n")
+        if(ROW_ID MATCHES ",\\*$")
+            message(STATUS "Footprint delta: ${ROW_ID} flash ${FLASH_DELTA} ram ${RAM_DELTA}")
+        endif()
+    endif()
+endforeach()
+
+file(WRITE ${REPORT_FILE}.diff.csv "${DIFF}")
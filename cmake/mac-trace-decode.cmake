@@ -0,0 +1,199 @@
+##
+##   ______                              _
+##  / _____)             _              | |
+## ( (____  _____ ____ _| |_ _____  ____| |__
+##  \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+##  _____) ) ____| | | || |_| ____( (___| | | |
+## (______/|_____)_|_|_| \__)_____)\____)_| |_|
+## (C)2013-2017 Semtech
+##  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+## / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+## \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+## |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+## embedded.connectivity.solutions.==============
+##
+## License:  Revised BSD License, see LICENSE.TXT file included in the project
+## Authors:  Johannes Bruder ( STACKFORCE ), Miguel Luis ( Semtech )
+##
+##
+## LoRaMac binary trace decoder.
+##
+## Renders as a timeline the LoRaMacTrace buffer (src/mac/LoRaMacTrace.h)
+## dumped from the target, for example with GDB:
+##   (gdb) dump binary value mac-trace.bin LoRaMacTrace
+##
+## Usage:
+##   cmake -DTRACE_FILE=<mac-trace.bin> [-DREPORT_FILE=<timeline.csv>] -P mac-trace-decode.cmake
+##
+## The timeline is printed with one line per record, oldest first:
+##   <time [ms]> <+delta [ms]> <event> <arguments>
+## When REPORT_FILE is defined the timeline is also written as a CSV file with
+## the columns "time,delta,event,arg8,arg16,details".
+##
+
+cmake_minimum_required(VERSION 3.6)
+
+if(NOT DEFINED TRACE_FILE)
+    message(FATAL_ERROR "MAC trace: TRACE_FILE must be defined")
+endif()
+if(NOT EXISTS ${TRACE_FILE})
+    message(FATAL_ERROR "MAC trace: ${TRACE_FILE} not found")
+endif()
+
+# Buffer header size and record size, in bytes
+set(TRACE_HEADER_SIZE 12)
+set(TRACE_RECORD_SIZE 8)
+
+set(TRACE_EVENTS
+    MAC_STATE RADIO_TX RADIO_RX RADIO_TX_DONE RADIO_RX_DONE RADIO_TX_TIMEOUT RADIO_RX_ERROR RADIO_RX_TIMEOUT
+    TIMER_START TIMER_STOP TIMER_EXPIRED MCPS_REQUEST MLME_REQUEST MCPS_CONFIRM MLME_CONFIRM MCPS_INDICATION
+)
+set(TRACE_TIMERS TX_DELAYED RX_WINDOW_1 RX_WINDOW_2 ACK_TIMEOUT)
+set(TRACE_RX_SLOTS RX1 RX2 RXC RXC_MULTICAST PING_SLOT MULTICAST_PING_SLOT NONE)
+set(TRACE_MAC_STATES STOPPED TX_RUNNING RX - ACK_RETRY TX_DELAYED TX_CONFIG RX_ABORT)
+set(TRACE_MAC_FLAGS MCPS_REQ MCPS_IND MLME_REQ MLME_IND MLME_SCHED_UPLINK_IND MAC_DONE)
+
+#---------------------------------------------------------------------------------------
+# Helpers
+#---------------------------------------------------------------------------------------
+
+# Reads a little endian unsigned value of SIZE bytes at byte OFFSET of the trace
+function(trace_read OFFSET SIZE RESULT)
+    set(VALUE 0)
+    math(EXPR INDEX "${OFFSET} + ${SIZE} - 1")
+    while(NOT INDEX LESS OFFSET)
+        math(EXPR HEX_INDEX "${INDEX} * 2")
+        string(SUBSTRING "${TRACE_HEX}" ${HEX_INDEX} 2 BYTE)
+        math(EXPR VALUE "(${VALUE} << 8) | 0x${BYTE}")
+        math(EXPR INDEX "${INDEX} - 1")
+    endwhile()
+    set(${RESULT} ${VALUE} PARENT_SCOPE)
+endfunction()
+
+# Converts a bit field into the list of the names of its set bits
+function(trace_bits VALUE NAMES RESULT)
+    set(TEXT "")
+    set(BIT 0)
+    foreach(NAME ${${NAMES}})
+        math(EXPR IS_SET "(${VALUE} >> ${BIT}) & 1")
+        if(IS_SET AND NOT NAME STREQUAL "-")
+            set(TEXT "${TEXT}|${NAME}")
+        endif()
+        math(EXPR BIT "${BIT} + 1")
+    endforeach()
+    string(REGEX REPLACE "^\\|" "" TEXT "${TEXT}")
+    set(${RESULT} "${TEXT}" PARENT_SCOPE)
+endfunction()
+
+# Gets the INDEX-th name of the NAMES list, or the index itself when out of range
+function(trace_name INDEX NAMES RESULT)
+    list(LENGTH ${NAMES} COUNT)
+    if(INDEX LESS COUNT)
+        list(GET ${NAMES} ${INDEX} NAME)
+    else()
+        set(NAME "${INDEX}")
+    endif()
+    set(${RESULT} "${NAME}" PARENT_SCOPE)
+endfunction()
+
+#---------------------------------------------------------------------------------------
+# Decoding
+#---------------------------------------------------------------------------------------
+
+file(READ ${TRACE_FILE} TRACE_HEX HEX)
+string(LENGTH "${TRACE_HEX}" TRACE_HEX_LENGTH)
+math(EXPR TRACE_FILE_SIZE "${TRACE_HEX_LENGTH} / 2")
+
+if(TRACE_FILE_SIZE LESS TRACE_HEADER_SIZE)
+    message(FATAL_ERROR "MAC trace: ${TRACE_FILE} is too small")
+endif()
+string(SUBSTRING "${TRACE_HEX}" 0 8 TRACE_MAGIC)
+if(NOT TRACE_MAGIC STREQUAL "4d545243")
+    message(FATAL_ERROR "MAC trace: ${TRACE_FILE} is not a LoRaMacTrace dump")
+endif()
+
+trace_read(4 4 TRACE_SIZE)
+trace_read(8 4 TRACE_COUNT)
+math(EXPR TRACE_EXPECTED_SIZE "${TRACE_HEADER_SIZE} + ${TRACE_SIZE} * ${TRACE_RECORD_SIZE}")
+if(TRACE_SIZE EQUAL 0 OR TRACE_FILE_SIZE LESS TRACE_EXPECTED_SIZE)
+    message(FATAL_ERROR "MAC trace: ${TRACE_FILE} is truncated")
+endif()
+
+# Index of the oldest record and number of valid records
+if(TRACE_COUNT LESS TRACE_SIZE)
+    set(FIRST 0)
+    set(NB_RECORDS ${TRACE_COUNT})
+else()
+    math(EXPR FIRST "${TRACE_COUNT} % ${TRACE_SIZE}")
+    set(NB_RECORDS ${TRACE_SIZE})
+    math(EXPR NB_LOST "${TRACE_COUNT} - ${TRACE_SIZE}")
+    message(STATUS "MAC trace: ${NB_LOST} older records overwritten")
+endif()
+message(STATUS "MAC trace: ${NB_RECORDS} records")
+
+if(DEFINED REPORT_FILE)
+    file(WRITE ${REPORT_FILE} "time,delta,event,arg8,arg16,details\n")
+endif()
+
+set(PREVIOUS_TIME "")
+set(N 0)
+while(N LESS NB_RECORDS)
+    math(EXPR OFFSET "${TRACE_HEADER_SIZE} + ((${FIRST} + ${N}) % ${TRACE_SIZE}) * ${TRACE_RECORD_SIZE}")
+    trace_read(${OFFSET} 4 TIME)
+    math(EXPR OFFSET "${OFFSET} + 4")
+    trace_read(${OFFSET} 1 EVENT)
+    math(EXPR OFFSET "${OFFSET} + 1")
+    trace_read(${OFFSET} 1 ARG8)
+    math(EXPR OFFSET "${OFFSET} + 1")
+    trace_read(${OFFSET} 2 ARG16)
+
+    if(PREVIOUS_TIME STREQUAL "")
+        set(DELTA 0)
+    else()
+        math(EXPR DELTA "(${TIME} - ${PREVIOUS_TIME}) & 0xFFFFFFFF")
+    endif()
+    set(PREVIOUS_TIME ${TIME})
+
+    trace_name(${EVENT} TRACE_EVENTS EVENT_NAME)
+    if(EVENT_NAME STREQUAL "MAC_STATE")
+        if(ARG16 EQUAL 0)
+            set(STATE "IDLE")
+        else()
+            trace_bits(${ARG16} TRACE_MAC_STATES STATE)
+        endif()
+        trace_bits(${ARG8} TRACE_MAC_FLAGS FLAGS)
+        set(DETAILS "state=${STATE} flags=${FLAGS}")
+    elseif(EVENT_NAME STREQUAL "RADIO_TX")
+        set(DETAILS "channel=${ARG8} size=${ARG16}")
+    elseif(EVENT_NAME STREQUAL "RADIO_RX")
+        trace_name(${ARG8} TRACE_RX_SLOTS SLOT)
+        set(DETAILS "slot=${SLOT} timeout=${ARG16}")
+    elseif(EVENT_NAME STREQUAL "RADIO_RX_DONE")
+        # RSSI is a signed 16 bits value
+        if(ARG16 GREATER 32767)
+            math(EXPR ARG16_SIGNED "${ARG16} - 65536")
+        else()
+            set(ARG16_SIGNED ${ARG16})
+        endif()
+        set(DETAILS "size=${ARG8} rssi=${ARG16_SIGNED}")
+    elseif(EVENT_NAME MATCHES "^TIMER_")
+        trace_name(${ARG8} TRACE_TIMERS TIMER)
+        if(EVENT_NAME STREQUAL "TIMER_START")
+            set(DETAILS "timer=${TIMER} timeout=${ARG16}")
+        else()
+            set(DETAILS "timer=${TIMER}")
+        endif()
+    elseif(EVENT_NAME MATCHES "^MCPS_INDICATION")
+        set(DETAILS "port=${ARG8} status=${ARG16}")
+    elseif(EVENT_NAME MATCHES "^(MCPS|MLME)_")
+        set(DETAILS "type=${ARG8} status=${ARG16}")
+    else()
+        set(DETAILS "")
+    endif()
+
+    message("${TIME} +${DELTA} ${EVENT_NAME} ${DETAILS}")
+    if(DEFINED REPORT_FILE)
+        file(APPEND ${REPORT_FILE} "${TIME},${DELTA},${EVENT_NAME},${ARG8},${ARG16},${DETAILS}\n")
+    endif()
+    math(EXPR N "${N} + 1")
+endwhile()
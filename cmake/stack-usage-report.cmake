@@ -0,0 +1,248 @@
+##
+##   ______                              _
+##  / _____)             _              | |
+## ( (____  _____ ____ _| |_ _____  ____| |__
+##  \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+##  _____) ) ____| | | || |_| ____( (___| | | |
+## (______/|_____)_|_|_| \__)_____)\____)_| |_|
+## (C)2013-2017 Semtech
+##  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+## / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+## \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+## |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+## embedded.connectivity.solutions.==============
+##
+## License:  Revised BSD License, see LICENSE.TXT file included in the project
+## Authors:  Johannes Bruder ( STACKFORCE ), Miguel Luis ( Semtech )
+##
+##
+## Worst case stack usage analyser.
+##
+## Parses the call graph files (*.ci) generated by GCC with the
+## -fcallgraph-info=su option and computes, for every entry point, the worst
+## case stack usage along its call tree.
+##
+## Indirect calls (function pointers: timer callbacks, radio driver, MAC events)
+## are resolved conservatively: an indirect call may reach any function whose
+## name matches INDIRECT_REGEX. The indirect call cost is iterated until it
+## becomes stable, so that callbacks calling other callbacks are accounted.
+##
+## Usage:
+##   cmake -DSEARCH_DIR=<build directory> -DREPORT_FILE=<report.csv>
+##         [-DENTRY_REGEX=<regex>] [-DINDIRECT_REGEX=<regex>] -P stack-usage-report.cmake
+##
+## The report is a CSV file with the columns "entry,stack,flags,path", sorted
+## as found. Flags:
+##   dynamic   - a function on the path uses unbounded dynamic stack (alloca, VLA)
+##   recursion - a recursive call was found and counted once
+##   unknown   - a called function has no stack information (precompiled libraries)
+##   indirect  - the path goes through an indirect call
+##   unbounded - the indirect call cost did not converge
+##
+
+cmake_minimum_required(VERSION 3.6)
+
+if(NOT DEFINED SEARCH_DIR OR NOT DEFINED REPORT_FILE)
+    message(FATAL_ERROR "Stack usage: SEARCH_DIR and REPORT_FILE must be defined")
+endif()
+if(NOT DEFINED ENTRY_REGEX OR ENTRY_REGEX STREQUAL "")
+    set(ENTRY_REGEX "^(main|.+_IRQHandler|.+_Handler)$")
+endif()
+if(NOT DEFINED INDIRECT_REGEX OR INDIRECT_REGEX STREQUAL "")
+    set(INDIRECT_REGEX "^(On[A-Z]|Radio[A-Z]|SX12[0-9x]+[A-Z]|Lmhp[A-Z])")
+endif()
+
+# Maximum number of indirect call cost iterations
+set(INDIRECT_MAX_ITERATIONS 8)
+
+set(INDIRECT_NODE "__indirect_call")
+
+#---------------------------------------------------------------------------------------
+# Call graph parsing
+#---------------------------------------------------------------------------------------
+file(GLOB_RECURSE CI_FILES ${SEARCH_DIR}/*.ci)
+if(NOT CI_FILES)
+    message(FATAL_ERROR "Stack usage: no call graph file found in ${SEARCH_DIR}, is STACK_USAGE enabled?")
+endif()
+
+set(NODES "")
+foreach(CI_FILE IN LISTS CI_FILES)
+    file(STRINGS ${CI_FILE} CI_LINES)
+    foreach(LINE IN LISTS CI_LINES)
+        if(LINE MATCHES "^node: { title: \"([^\"]+)\" label: \"([^\\\\\"]+)(.*)\"")
+            set(TITLE "${CMAKE_MATCH_1}")
+            set(NAME "${CMAKE_MATCH_2}")
+            set(INFO "${CMAKE_MATCH_3}")
+            string(MAKE_C_IDENTIFIER "${TITLE}" KEY)
+            if(NOT DEFINED NAME_${KEY})
+                list(APPEND NODES ${KEY})
+                set(NAME_${KEY} "${NAME}")
+                set(CALLEES_${KEY} "")
+            endif()
+            # Nodes without stack information are declarations of external functions
+            if(INFO MATCHES "\\\\n([0-9]+) bytes \\(([a-z,]+)\\)")
+                set(STACK_${KEY} ${CMAKE_MATCH_1})
+                if(CMAKE_MATCH_2 STREQUAL "dynamic")
+                    set(DYNAMIC_${KEY} TRUE)
+                endif()
+            endif()
+        elseif(LINE MATCHES "^edge: { sourcename: \"([^\"]+)\" targetname: \"([^\"]+)\"")
+            string(MAKE_C_IDENTIFIER "${CMAKE_MATCH_1}" SOURCE_KEY)
+            string(MAKE_C_IDENTIFIER "${CMAKE_MATCH_2}" TARGET_KEY)
+            list(APPEND CALLEES_${SOURCE_KEY} ${TARGET_KEY})
+        endif()
+    endforeach()
+endforeach()
+
+set(ENTRIES "")
+set(INDIRECT_TARGETS "")
+foreach(KEY IN LISTS NODES)
+    if(NOT DEFINED STACK_${KEY})
+        continue()
+    endif()
+    if(NAME_${KEY} MATCHES "${ENTRY_REGEX}")
+        list(APPEND ENTRIES ${KEY})
+    endif()
+    if(NAME_${KEY} MATCHES "${INDIRECT_REGEX}")
+        list(APPEND INDIRECT_TARGETS ${KEY})
+    endif()
+endforeach()
+
+#---------------------------------------------------------------------------------------
+# Computes the worst case stack usage of NODE. Results are memoized in global
+# properties as the call graph is shared by all entry points.
+#---------------------------------------------------------------------------------------
+function(stack_usage_worst NODE)
+    get_property(DONE GLOBAL PROPERTY SU_DONE_${NODE})
+    get_property(GENERATION GLOBAL PROPERTY SU_GENERATION)
+    if(DONE STREQUAL GENERATION)
+        return()
+    endif()
+
+    get_property(VISITING GLOBAL PROPERTY SU_VISITING)
+    if(NODE IN_LIST VISITING)
+        # Recursive call, the cycle is only counted once
+        set_property(GLOBAL PROPERTY SU_CYCLE TRUE)
+        return()
+    endif()
+
+    set(FLAGS "")
+    set(WORST 0)
+    set(PATH "")
+
+    if(NODE STREQUAL INDIRECT_NODE)
+        get_property(WORST GLOBAL PROPERTY SU_INDIRECT_COST)
+        get_property(PATH GLOBAL PROPERTY SU_INDIRECT_PATH)
+        get_property(FLAGS GLOBAL PROPERTY SU_INDIRECT_FLAGS)
+        list(APPEND FLAGS indirect)
+    else()
+        if(DEFINED STACK_${NODE})
+            set(OWN ${STACK_${NODE}})
+        else()
+            set(OWN 0)
+            list(APPEND FLAGS unknown)
+        endif()
+        if(DYNAMIC_${NODE})
+            list(APPEND FLAGS dynamic)
+        endif()
+
+        set_property(GLOBAL APPEND PROPERTY SU_VISITING ${NODE})
+        set(CHILD_WORST 0)
+        foreach(CALLEE IN LISTS CALLEES_${NODE})
+            set_property(GLOBAL PROPERTY SU_CYCLE FALSE)
+            stack_usage_worst(${CALLEE})
+            get_property(CYCLE GLOBAL PROPERTY SU_CYCLE)
+            if(CYCLE)
+                list(APPEND FLAGS recursion)
+                continue()
+            endif()
+            get_property(CALLEE_WORST GLOBAL PROPERTY SU_WORST_${CALLEE})
+            get_property(CALLEE_FLAGS GLOBAL PROPERTY SU_FLAGS_${CALLEE})
+            list(APPEND FLAGS ${CALLEE_FLAGS})
+            if(CALLEE_WORST GREATER CHILD_WORST)
+                set(CHILD_WORST ${CALLEE_WORST})
+                get_property(PATH GLOBAL PROPERTY SU_PATH_${CALLEE})
+            endif()
+        endforeach()
+        get_property(VISITING GLOBAL PROPERTY SU_VISITING)
+        list(REMOVE_ITEM VISITING ${NODE})
+        set_property(GLOBAL PROPERTY SU_VISITING ${VISITING})
+
+        math(EXPR WORST "${OWN} + ${CHILD_WORST}")
+        set(PATH ${NAME_${NODE}} ${PATH})
+    endif()
+
+    if(FLAGS)
+        list(REMOVE_DUPLICATES FLAGS)
+    endif()
+    set_property(GLOBAL PROPERTY SU_DONE_${NODE} ${GENERATION})
+    set_property(GLOBAL PROPERTY SU_WORST_${NODE} ${WORST})
+    set_property(GLOBAL PROPERTY SU_FLAGS_${NODE} ${FLAGS})
+    set_property(GLOBAL PROPERTY SU_PATH_${NODE} ${PATH})
+    set_property(GLOBAL PROPERTY SU_CYCLE FALSE)
+endfunction()
+
+# Invalidates the memoized results
+set_property(GLOBAL PROPERTY SU_GENERATION 0)
+macro(stack_usage_reset)
+    get_property(GENERATION GLOBAL PROPERTY SU_GENERATION)
+    math(EXPR GENERATION "${GENERATION} + 1")
+    set_property(GLOBAL PROPERTY SU_GENERATION ${GENERATION})
+    set_property(GLOBAL PROPERTY SU_VISITING "")
+endmacro()
+
+#---------------------------------------------------------------------------------------
+# Indirect call cost computation
+#---------------------------------------------------------------------------------------
+set_property(GLOBAL PROPERTY SU_INDIRECT_COST 0)
+set_property(GLOBAL PROPERTY SU_INDIRECT_PATH "")
+set_property(GLOBAL PROPERTY SU_INDIRECT_FLAGS "")
+set(INDIRECT_COST 0)
+set(CONVERGED FALSE)
+foreach(ITERATION RANGE 1 ${INDIRECT_MAX_ITERATIONS})
+    stack_usage_reset()
+    set(NEW_COST 0)
+    set(NEW_PATH "")
+    set(NEW_FLAGS "")
+    foreach(KEY IN LISTS INDIRECT_TARGETS)
+        stack_usage_worst(${KEY})
+        get_property(TARGET_WORST GLOBAL PROPERTY SU_WORST_${KEY})
+        get_property(TARGET_FLAGS GLOBAL PROPERTY SU_FLAGS_${KEY})
+        list(APPEND NEW_FLAGS ${TARGET_FLAGS})
+        if(TARGET_WORST GREATER NEW_COST)
+            set(NEW_COST ${TARGET_WORST})
+            get_property(NEW_PATH GLOBAL PROPERTY SU_PATH_${KEY})
+        endif()
+    endforeach()
+    list(REMOVE_ITEM NEW_FLAGS indirect)
+    set_property(GLOBAL PROPERTY SU_INDIRECT_COST ${NEW_COST})
+    set_property(GLOBAL PROPERTY SU_INDIRECT_PATH ${NEW_PATH})
+    set_property(GLOBAL PROPERTY SU_INDIRECT_FLAGS ${NEW_FLAGS})
+    if(NEW_COST EQUAL INDIRECT_COST)
+        set(CONVERGED TRUE)
+        break()
+    endif()
+    set(INDIRECT_COST ${NEW_COST})
+endforeach()
+if(NOT CONVERGED)
+    set_property(GLOBAL APPEND PROPERTY SU_INDIRECT_FLAGS unbounded)
+endif()
+
+#---------------------------------------------------------------------------------------
+# Report generation
+#---------------------------------------------------------------------------------------
+stack_usage_reset()
+set(REPORT "entry,stack,flags,path\n")
+foreach(KEY IN LISTS ENTRIES)
+    stack_usage_worst(${KEY})
+    get_property(WORST GLOBAL PROPERTY SU_WORST_${KEY})
+    get_property(FLAGS GLOBAL PROPERTY SU_FLAGS_${KEY})
+    get_property(PATH GLOBAL PROPERTY SU_PATH_${KEY})
+    string(REPLACE ";" " " FLAGS "${FLAGS}")
+    string(REPLACE ";" " > " PATH "${PATH}")
+    string(APPEND REPORT "${NAME_${KEY}},${WORST},${FLAGS},${PATH}\n")
+    message(STATUS "Stack usage: ${NAME_${KEY}} ${WORST} bytes ${FLAGS}")
+endforeach()
+message(STATUS "Stack usage: indirect call cost ${INDIRECT_COST} bytes")
+
+file(WRITE ${REPORT_FILE} "${REPORT}")
@@ -0,0 +1,47 @@
+##
+##   ______                              _
+##  / _____)             _              | |
+## ( (____  _____ ____ _| |_ _____  ____| |__
+##  \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+##  _____) ) ____| | | || |_| ____( (___| | | |
+## (______/|_____)_|_|_| \__)_____)\____)_| |_|
+## (C)2013-2017 Semtech
+##  ___ _____ _   ___ _  _____ ___  ___  ___ ___
+## / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+## \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+## |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+## embedded.connectivity.solutions.==============
+##
+## License:  Revised BSD License, see LICENSE.TXT file included in the project
+## Authors:  Johannes Bruder ( STACKFORCE ), Miguel Luis ( Semtech )
+##
+##
+## Worst case stack usage analysis helper functions
+##
+
+# Get the path of this module
+set(STACK_USAGE_MODULE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+#---------------------------------------------------------------------------------------
+# Creates a <target>.stack target generating the worst case stack usage report
+# (<target>.stack.csv) of every entry point (main and interrupt handlers).
+# Requires the STACK_USAGE option to be enabled (GCC 10 or later).
+#---------------------------------------------------------------------------------------
+function(create_stack_usage_report TARGET)
+    if(NOT STACK_USAGE)
+        return()
+    endif()
+
+    set(STACK_USAGE_ENTRY_REGEX "" CACHE STRING "Regular expression matching the stack usage entry points (Default main and interrupt handlers)")
+    set(STACK_USAGE_INDIRECT_REGEX "" CACHE STRING "Regular expression matching the functions reachable through function pointers (Default callbacks and radio driver)")
+
+    add_custom_target(${TARGET}.stack DEPENDS ${TARGET}
+        COMMAND ${CMAKE_COMMAND}
+            -DSEARCH_DIR=${CMAKE_BINARY_DIR}
+            -DREPORT_FILE=${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.stack.csv
+            -DENTRY_REGEX=${STACK_USAGE_ENTRY_REGEX}
+            -DINDIRECT_REGEX=${STACK_USAGE_INDIRECT_REGEX}
+            -P ${STACK_USAGE_MODULE_DIR}/stack-usage-report.cmake
+        VERBATIM
+    )
+endfunction()
@@ -19,6 +19,8 @@
  * \author    Miguel Luis ( Semtech )
  */
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #include "utilities.h"
 #include "CayenneLpp.h"
@@ -28,6 +30,105 @@
 static uint8_t CayenneLppBuffer[CAYENNE_LPP_MAXBUFFER_SIZE];
 static uint8_t CayenneLppCursor = 0;
 
+/*!
+ * Data type encoding description
+ */
+typedef struct sCayenneLppTypeInfo
+{
+    uint8_t Type;
+    /*!
+     * Number of values
+     */
+    uint8_t NbValues;
+    /*!
+     * Size of each value in bytes
+     */
+    uint8_t ValueSize;
+    /*!
+     * Values are signed
+     */
+    bool IsSigned;
+}CayenneLppTypeInfo_t;
+
+static const CayenneLppTypeInfo_t CayenneLppTypeInfos[] =
+{
+    { LPP_DIGITAL_INPUT,       1, 1, false },
+    { LPP_DIGITAL_OUTPUT,      1, 1, false },
+    { LPP_ANALOG_INPUT,        1, 2, true  },
+    { LPP_ANALOG_OUTPUT,       1, 2, true  },
+    { LPP_LUMINOSITY,          1, 2, false },
+    { LPP_PRESENCE,            1, 1, false },
+    { LPP_TEMPERATURE,         1, 2, true  },
+    { LPP_RELATIVE_HUMIDITY,   1, 1, false },
+    { LPP_ACCELEROMETER,       3, 2, true  },
+    { LPP_BAROMETRIC_PRESSURE, 1, 2, false },
+    { LPP_GYROMETER,           3, 2, true  },
+    { LPP_GPS,                 3, 3, true  },
+};
+
+static const CayenneLppTypeInfo_t* GetTypeInfo( uint8_t type )
+{
+    for( uint8_t i = 0; i < ( sizeof( CayenneLppTypeInfos ) / sizeof( CayenneLppTypeInfo_t ) ); i++ )
+    {
+        if( CayenneLppTypeInfos[i].Type == type )
+        {
+            return &CayenneLppTypeInfos[i];
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \brief Writes the values data, most significant byte first
+ *
+ * \retval size Number of bytes written
+ */
+static uint8_t WriteData( uint8_t* buffer, const CayenneLppTypeInfo_t* info, const int32_t* values )
+{
+    uint8_t size = 0;
+
+    for( uint8_t i = 0; i < info->NbValues; i++ )
+    {
+        for( int8_t j = info->ValueSize - 1; j >= 0; j-- )
+        {
+            buffer[size++] = values[i] >> ( j * 8 );
+        }
+    }
+    return size;
+}
+
+/*!
+ * \brief Reads the values data, most significant byte first
+ *
+ * \retval size Number of bytes read
+ */
+static uint8_t ReadData( const uint8_t* buffer, const CayenneLppTypeInfo_t* info, int32_t* values )
+{
+    uint8_t size = 0;
+
+    for( uint8_t i = 0; i < info->NbValues; i++ )
+    {
+        uint32_t value = 0;
+
+        for( uint8_t j = 0; j < info->ValueSize; j++ )
+        {
+            value = ( value << 8 ) | buffer[size++];
+        }
+        if( ( info->IsSigned == true ) && ( info->ValueSize < 4 ) &&
+            ( ( value & ( 1UL << ( ( info->ValueSize * 8 ) - 1 ) ) ) != 0 ) )
+        {
+            // Sign extension
+            value |= 0xFFFFFFFFUL << ( info->ValueSize * 8 );
+        }
+        values[i] = ( int32_t )value;
+    }
+    for( uint8_t i = info->NbValues; i < LPP_MAX_NB_VALUES; i++ )
+    {
+        values[i] = 0;
+    }
+    return size;
+}
+
 void CayenneLppInit( void )
 {
     CayenneLppCursor = 0;
@@ -255,3 +356,125 @@ uint8_t CayenneLppAddGps( uint8_t channel, float latitude, float longitude, floa
 
     return CayenneLppCursor;
 }
+
+uint8_t CayenneLppGetDataSize( uint8_t type )
+{
+    const CayenneLppTypeInfo_t* info = GetTypeInfo( type );
+
+    if( info == NULL )
+    {
+        return 0;
+    }
+    return info->NbValues * info->ValueSize;
+}
+
+uint8_t CayenneLppAddBatch( const CayenneLppValue_t* values, uint8_t nbValues )
+{
+    uint16_t size = 0;
+
+    for( uint8_t i = 0; i < nbValues; i++ )
+    {
+        uint8_t dataSize = CayenneLppGetDataSize( values[i].Type );
+
+        if( dataSize == 0 )
+        {
+            return 0;
+        }
+        size += 2 + dataSize;
+    }
+    if( ( CayenneLppCursor + size ) > CAYENNE_LPP_MAXBUFFER_SIZE )
+    {
+        return 0;
+    }
+
+    for( uint8_t i = 0; i < nbValues; i++ )
+    {
+        CayenneLppBuffer[CayenneLppCursor++] = values[i].Channel;
+        CayenneLppBuffer[CayenneLppCursor++] = values[i].Type;
+        CayenneLppCursor += WriteData( CayenneLppBuffer + CayenneLppCursor, GetTypeInfo( values[i].Type ),
+                                       values[i].Values );
+    }
+
+    return CayenneLppCursor;
+}
+
+uint8_t CayenneLppEncodeSchema( const CayenneLppSchema_t* schema, const int32_t* values )
+{
+    uint16_t size = 1;
+
+    for( uint8_t i = 0; i < schema->NbEntries; i++ )
+    {
+        uint8_t dataSize = CayenneLppGetDataSize( schema->Entries[i].Type );
+
+        if( dataSize == 0 )
+        {
+            return 0;
+        }
+        size += dataSize;
+    }
+    if( size > CAYENNE_LPP_MAXBUFFER_SIZE )
+    {
+        return 0;
+    }
+
+    CayenneLppCursor = 0;
+    CayenneLppBuffer[CayenneLppCursor++] = schema->Id;
+    for( uint8_t i = 0; i < schema->NbEntries; i++ )
+    {
+        const CayenneLppTypeInfo_t* info = GetTypeInfo( schema->Entries[i].Type );
+
+        CayenneLppCursor += WriteData( CayenneLppBuffer + CayenneLppCursor, info, values );
+        values += info->NbValues;
+    }
+
+    return CayenneLppCursor;
+}
+
+uint8_t CayenneLppDecode( const uint8_t* buffer, uint8_t size, CayenneLppValue_t* value )
+{
+    const CayenneLppTypeInfo_t* info;
+
+    if( size < 2 )
+    {
+        return 0;
+    }
+    info = GetTypeInfo( buffer[1] );
+    if( ( info == NULL ) || ( size < ( 2 + ( info->NbValues * info->ValueSize ) ) ) )
+    {
+        return 0;
+    }
+
+    value->Channel = buffer[0];
+    value->Type = buffer[1];
+    return 2 + ReadData( buffer + 2, info, value->Values );
+}
+
+bool CayenneLppDecodeSchema( const CayenneLppSchema_t* schema, const uint8_t* buffer, uint8_t size,
+                             CayenneLppValue_t* values )
+{
+    uint16_t expectedSize = 1;
+    uint8_t cursor = 1;
+
+    for( uint8_t i = 0; i < schema->NbEntries; i++ )
+    {
+        expectedSize += CayenneLppGetDataSize( schema->Entries[i].Type );
+    }
+    if( ( size != expectedSize ) || ( buffer[0] != schema->Id ) )
+    {
+        return false;
+    }
+
+    for( uint8_t i = 0; i < schema->NbEntries; i++ )
+    {
+        const CayenneLppTypeInfo_t* info = GetTypeInfo( schema->Entries[i].Type );
+
+        if( info == NULL )
+        {
+            return false;
+        }
+        values[i].Channel = schema->Entries[i].Channel;
+        values[i].Type = schema->Entries[i].Type;
+        cursor += ReadData( buffer + cursor, info, values[i].Values );
+    }
+    return true;
+}
@@ -22,6 +22,7 @@
 #define __CAYENNE_LPP_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define LPP_DIGITAL_INPUT       0       // 1 byte
 #define LPP_DIGITAL_OUTPUT      1       // 1 byte
@@ -51,6 +52,63 @@
 #define LPP_GYROMETER_SIZE           8
 #define LPP_GPS_SIZE                 11
 
+// Maximum number of values of a data type
+#define LPP_MAX_NB_VALUES            3
+
+/*!
+ * Decoded or to be encoded value
+ */
+typedef struct sCayenneLppValue
+{
+    /*!
+     * Data ID
+     */
+    uint8_t Channel;
+    /*!
+     * Data type
+     */
+    uint8_t Type;
+    /*!
+     * Raw values in the data type resolution (e.g. 0.1 degC for
+     * LPP_TEMPERATURE). Accelerometer, gyrometer and GPS use 3 values.
+     */
+    int32_t Values[LPP_MAX_NB_VALUES];
+}CayenneLppValue_t;
+
+/*!
+ * Schema entry. Data ID and type of a value
+ */
+typedef struct sCayenneLppSchemaEntry
+{
+    uint8_t Channel;
+    uint8_t Type;
+}CayenneLppSchemaEntry_t;
+
+/*!
+ * Fixed sensor set known by both the device and the application server.
+ *
+ * A schema payload holds the schema identifier followed by the values data
+ * only. The data ID and type bytes are omitted.
+ *
+ * \remark Schema payloads must be sent on a dedicated port as they cannot be
+ *         told apart from standard payloads
+ */
+typedef struct sCayenneLppSchema
+{
+    /*!
+     * Schema identifier. First byte of the payload
+     */
+    uint8_t Id;
+    /*!
+     * Values data ID and type, in payload order
+     */
+    const CayenneLppSchemaEntry_t* Entries;
+    /*!
+     * Number of entries
+     */
+    uint8_t NbEntries;
+}CayenneLppSchema_t;
+
 void CayenneLppInit( void );
 
 void CayenneLppReset( void );
@@ -73,4 +131,61 @@ uint8_t CayenneLppAddBarometricPressure( uint8_t channel, float hpa );
 uint8_t CayenneLppAddGyrometer( uint8_t channel, float x, float y, float z );
 uint8_t CayenneLppAddGps( uint8_t channel, float latitude, float longitude, float meters );
 
+/*!
+ * \brief Gets the data size of a data type
+ *
+ * \param [IN] type Data type
+ *
+ * \retval size Data size without the data ID and type bytes. 0 if the type is unknown
+ */
+uint8_t CayenneLppGetDataSize( uint8_t type );
+
+/*!
+ * \brief Adds many values at once. The buffer space is checked once for the
+ *        whole batch.
+ *
+ * \param [IN] values   Values to be added
+ * \param [IN] nbValues Number of values
+ *
+ * \retval cursor Buffer size. 0 if a type is unknown or if the batch does not
+ *                fit, in which case nothing is added
+ */
+uint8_t CayenneLppAddBatch( const CayenneLppValue_t* values, uint8_t nbValues );
+
+/*!
+ * \brief Encodes the values of a schema. Replaces the buffer content.
+ *
+ * \param [IN] schema Schema to be used
+ * \param [IN] values Raw values, in schema order. Types with many values
+ *                    (accelerometer, gyrometer, GPS) use consecutive values
+ *
+ * \retval cursor Buffer size. 0 if a type is unknown or if the values do not fit
+ */
+uint8_t CayenneLppEncodeSchema( const CayenneLppSchema_t* schema, const int32_t* values );
+
+/*!
+ * \brief Decodes the first value of a standard payload
+ *
+ * \param [IN]  buffer Payload to be decoded
+ * \param [IN]  size   Payload size
+ * \param [OUT] value  Decoded value
+ *
+ * \retval size Number of bytes decoded. 0 at the end of the payload or if the
+ *              payload is malformed
+ */
+uint8_t CayenneLppDecode( const uint8_t* buffer, uint8_t size, CayenneLppValue_t* value );
+
+/*!
+ * \brief Decodes a schema payload
+ *
+ * \param [IN]  schema Schema to be used
+ * \param [IN]  buffer Payload to be decoded
+ * \param [IN]  size   Payload size
+ * \param [OUT] values Decoded values. Array of schema->NbEntries values
+ *
+ * \retval status True if the payload matches the schema identifier and size
+ */
+bool CayenneLppDecodeSchema( const CayenneLppSchema_t* schema, const uint8_t* buffer, uint8_t size,
+                             CayenneLppValue_t* values );
+
 #endif // __CAYENNE_LPP_H__
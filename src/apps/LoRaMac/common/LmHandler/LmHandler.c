@@ -696,6 +696,7 @@ static void McpsConfirm( McpsConfirm_t *mcpsConfirm )
     TxParams.TxPower = mcpsConfirm->TxPower;
     TxParams.Channel = mcpsConfirm->Channel;
     TxParams.AckReceived = mcpsConfirm->AckReceived;
+    TxParams.TxPreparationTime = mcpsConfirm->TxPreparationTime;
 
     LmHandlerCallbacks->OnTxData( &TxParams );
 
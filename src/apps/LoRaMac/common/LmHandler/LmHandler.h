@@ -53,6 +53,7 @@ typedef struct LmHandlerTxParams_s
     LmHandlerAppData_t AppData;
     int8_t TxPower;
     uint8_t Channel;
+    TimerTime_t TxPreparationTime;
 }LmHandlerTxParams_t;
 
 typedef struct LmHandlerRxParams_s
@@ -62,6 +62,20 @@ typedef struct ComplianceTestState_s
     uint8_t NbGateways;
 }ComplianceTestState_t;
 
+/*!
+ * LoRaWAN compliance tests timing measurements
+ */
+typedef struct ComplianceTestTiming_s
+{
+    LmhpComplianceStats_t Stats;
+    TimerTime_t LastTxTime;
+    TimerTime_t TxTimerExpiryTime;
+    bool TxTimerExpired;
+    TimerTime_t EchoRxTime;
+    uint32_t TxPeriodSum;
+    uint32_t EchoTurnaroundSum;
+}ComplianceTestTiming_t;
+
 /*!
  * Timer to handle the application data transmission duty cycle
  */
@@ -87,6 +101,11 @@ static ComplianceTestState_t ComplianceTestState =
     .NbGateways = 0
 };
 
+/*!
+ * Holds the compliance test timing measurements
+ */
+static ComplianceTestTiming_t ComplianceTestTiming;
+
 /*!
  * LoRaWAN compliance tests protocol handler parameters
  */
@@ -151,6 +170,18 @@ static void OnComplianceTxNextPacketTimerEvent( void *context );
  */
 static LmHandlerErrorStatus_t LmhpComplianceTxProcess( void );
 
+/*!
+ * Updates the timing statistics on a compliance uplink request
+ *
+ * \param [IN] isEcho Indicates if the uplink answers an echo command
+ */
+static void ComplianceTimingOnTx( bool isEcho );
+
+/*!
+ * Notifies the compliance test end to the application
+ */
+static void ComplianceTimingOnTestStop( void );
+
 LmhPackage_t LmhpCompliancePackage =
 {
     .Port = COMPLIANCE_PORT,
@@ -221,6 +252,65 @@ static void LmhpComplianceOnMlmeConfirm( MlmeConfirm_t *mlmeConfirm )
     }
 }
 
+void LmhpComplianceGetStats( LmhpComplianceStats_t* stats )
+{
+    if( stats == NULL )
+    {
+        return;
+    }
+    *stats = ComplianceTestTiming.Stats;
+    if( stats->NbUplinks > 1 )
+    {
+        stats->TxPeriodAvg = ComplianceTestTiming.TxPeriodSum / ( stats->NbUplinks - 1 );
+    }
+    if( stats->NbEchoes > 0 )
+    {
+        stats->EchoTurnaroundAvg = ComplianceTestTiming.EchoTurnaroundSum / stats->NbEchoes;
+    }
+}
+
+static void ComplianceTimingOnTx( bool isEcho )
+{
+    LmhpComplianceStats_t* stats = &ComplianceTestTiming.Stats;
+    TimerTime_t now = TimerGetCurrentTime( );
+
+    if( stats->NbUplinks > 0 )
+    {
+        TimerTime_t period = now - ComplianceTestTiming.LastTxTime;
+
+        stats->TxPeriodMin = MIN( stats->TxPeriodMin, period );
+        stats->TxPeriodMax = MAX( stats->TxPeriodMax, period );
+        ComplianceTestTiming.TxPeriodSum += period;
+    }
+    if( ComplianceTestTiming.TxTimerExpired == true )
+    {
+        ComplianceTestTiming.TxTimerExpired = false;
+        stats->TxLatencyMax = MAX( stats->TxLatencyMax, now - ComplianceTestTiming.TxTimerExpiryTime );
+    }
+    if( isEcho == true )
+    {
+        TimerTime_t turnaround = now - ComplianceTestTiming.EchoRxTime;
+
+        stats->EchoTurnaroundMin = MIN( stats->EchoTurnaroundMin, turnaround );
+        stats->EchoTurnaroundMax = MAX( stats->EchoTurnaroundMax, turnaround );
+        ComplianceTestTiming.EchoTurnaroundSum += turnaround;
+        stats->NbEchoes++;
+    }
+    ComplianceTestTiming.LastTxTime = now;
+    stats->NbUplinks++;
+}
+
+static void ComplianceTimingOnTestStop( void )
+{
+    LmhpComplianceStats_t stats;
+
+    if( LmhpComplianceParams->OnTestStop != NULL )
+    {
+        LmhpComplianceGetStats( &stats );
+        LmhpComplianceParams->OnTestStop( &stats );
+    }
+}
+
 static LmHandlerErrorStatus_t LmhpComplianceTxProcess( void )
 {
     if( ComplianceTestState.Initialized == false )
@@ -228,6 +318,8 @@ static LmHandlerErrorStatus_t LmhpComplianceTxProcess( void )
         return LORAMAC_HANDLER_ERROR;
     }
 
+    ComplianceTimingOnTx( ( ComplianceTestState.LinkCheck == false ) && ( ComplianceTestState.State == 4 ) );
+
     if( ComplianceTestState.LinkCheck == true )
     {
         ComplianceTestState.LinkCheck = false;
@@ -305,6 +397,11 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
             ComplianceTestState.IsRunning = true;
             ComplianceTestState.State = 1;
 
+            // Reset the timing measurements
+            memset1( ( uint8_t* )&ComplianceTestTiming, 0, sizeof( ComplianceTestTiming ) );
+            ComplianceTestTiming.Stats.TxPeriodMin = ( TimerTime_t )-1;
+            ComplianceTestTiming.Stats.EchoTurnaroundMin = ( TimerTime_t )-1;
+
             // Enable ADR while in compliance test mode
             mibReq.Type = MIB_ADR;
             mibReq.Param.AdrEnable = true;
@@ -332,6 +429,7 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
     {
         // Increment the compliance certification protocol downlink counter
         ComplianceTestState.DownLinkCounter++;
+        ComplianceTestTiming.Stats.NbDownlinks++;
 
         // Parse compliance test protocol
         ComplianceTestState.State = mcpsIndication->Buffer[0];
@@ -360,6 +458,8 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
                 {
                     LmhpComplianceParams->StartPeripherals( );
                 }
+
+                ComplianceTimingOnTestStop( );
             }
             break;
         case 1: // (iii, iv)
@@ -374,6 +474,7 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
             ComplianceTestState.State = 1;
             break;
         case 4: // (vii)
+            ComplianceTestTiming.EchoRxTime = TimerGetCurrentTime( );
             ComplianceTestState.DataBufferSize = mcpsIndication->BufferSize;
 
             ComplianceTestState.DataBuffer[0] = 4;
@@ -414,6 +515,8 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
                     LmhpComplianceParams->StartPeripherals( );
                 }
 
+                ComplianceTimingOnTestStop( );
+
                 LmhpCompliancePackage.OnJoinRequest( true );
             }
             break;
@@ -484,5 +587,7 @@ static void LmhpComplianceProcess( void )
 
 static void OnComplianceTxNextPacketTimerEvent( void* context )
 {
+    ComplianceTestTiming.TxTimerExpiryTime = TimerGetCurrentTime( );
+    ComplianceTestTiming.TxTimerExpired = true;
     ComplianceTestState.TxPending = true;
 }
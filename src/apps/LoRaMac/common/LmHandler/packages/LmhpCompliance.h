@@ -22,6 +22,7 @@
 #define __LMHP_COMPLIANCE__
 
 #include "LoRaMac.h"
+#include "timer.h"
 #include "LmHandlerTypes.h"
 #include "LmhPackage.h"
 
@@ -32,6 +33,55 @@
  */
 #define PACKAGE_ID_COMPLIANCE                       0
 
+/*!
+ * Compliance test timing statistics
+ *
+ * \remark Times are given in [ms]
+ */
+typedef struct LmhpComplianceStats_s
+{
+    /*!
+     * Number of compliance uplinks requested
+     */
+    uint16_t NbUplinks;
+    /*!
+     * Number of compliance downlinks received
+     */
+    uint16_t NbDownlinks;
+    /*!
+     * Number of echo commands answered
+     */
+    uint16_t NbEchoes;
+    /*!
+     * Minimum time between two consecutive uplink requests
+     */
+    TimerTime_t TxPeriodMin;
+    /*!
+     * Maximum time between two consecutive uplink requests
+     */
+    TimerTime_t TxPeriodMax;
+    /*!
+     * Average time between two consecutive uplink requests
+     */
+    TimerTime_t TxPeriodAvg;
+    /*!
+     * Maximum time between the transmission timer expiry and the uplink request
+     */
+    TimerTime_t TxLatencyMax;
+    /*!
+     * Minimum time between an echo command reception and its answer request
+     */
+    TimerTime_t EchoTurnaroundMin;
+    /*!
+     * Maximum time between an echo command reception and its answer request
+     */
+    TimerTime_t EchoTurnaroundMax;
+    /*!
+     * Average time between an echo command reception and its answer request
+     */
+    TimerTime_t EchoTurnaroundAvg;
+}LmhpComplianceStats_t;
+
 /*!
  * Compliance test protocol handler parameters
  */
@@ -61,8 +111,23 @@ typedef struct LmhpComplianceParams_s
      *         reduce the power consumption.
      */
     void ( *StartPeripherals )( void );
+    /*!
+     * Notifies the compliance test end with its timing statistics.
+     *
+     * \remark Optional, may be NULL.
+     */
+    void ( *OnTestStop )( LmhpComplianceStats_t* stats );
 }LmhpComplianceParams_t;
 
 LmhPackage_t *LmphCompliancePackageFactory( void );
 
+/*!
+ * \brief Gets the timing statistics of the current or last compliance test
+ *
+ * \remark The statistics are reset on the compliance test activation
+ *
+ * \param [OUT] stats Compliance test timing statistics
+ */
+void LmhpComplianceGetStats( LmhpComplianceStats_t* stats );
+
 #endif // __LMHP_COMPLIANCE__
@@ -312,6 +312,7 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
     }
 
     printf( "TX POWER    : %d\r\n", params->TxPower );
+    printf( "TX PREP     : %lu ms\r\n", params->TxPreparationTime );
 
     mibGet.Type  = MIB_CHANNELS_MASK;
     if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
@@ -428,6 +429,23 @@ void DisplayClassUpdate( DeviceClass_t deviceClass )
     printf( "\r\n\r\n###### ===== Switch to Class %c done.  ===== ######\r\n\r\n", "ABC"[deviceClass] );
 }
 
+void DisplayComplianceStats( LmhpComplianceStats_t* stats )
+{
+    printf( "\r\n###### ===== COMPLIANCE TEST STATISTICS ==== ######\r\n" );
+    printf( "UPLINKS     : %u\r\n", stats->NbUplinks );
+    printf( "DOWNLINKS   : %u\r\n", stats->NbDownlinks );
+    if( stats->NbUplinks > 1 )
+    {
+        printf( "TX PERIOD   : min %lu, avg %lu, max %lu ms\r\n", stats->TxPeriodMin, stats->TxPeriodAvg, stats->TxPeriodMax );
+        printf( "TX LATENCY  : max %lu ms\r\n", stats->TxLatencyMax );
+    }
+    printf( "ECHOES      : %u\r\n", stats->NbEchoes );
+    if( stats->NbEchoes > 0 )
+    {
+        printf( "ECHO TURN   : min %lu, avg %lu, max %lu ms\r\n", stats->EchoTurnaroundMin, stats->EchoTurnaroundAvg, stats->EchoTurnaroundMax );
+    }
+}
+
 void DisplayAppInfo( const char* appName, const Version_t* appVersion, const Version_t* gitHubVersion )
 {
     printf( "\r\n###### ===================================== ######\r\n\r\n" );
@@ -24,6 +24,7 @@
 
 #include "utilities.h"
 #include "LmHandler.h"
+#include "LmhpCompliance.h"
 
 /*!
  * \brief Displays NVM context operation state
@@ -92,6 +93,13 @@ void DisplayBeaconUpdate( LoRaMAcHandlerBeaconParams_t* params );
  */
 void DisplayClassUpdate( DeviceClass_t deviceClass );
 
+/*!
+ * \brief Displays compliance test timing statistics
+ *
+ * \param [IN] stats Compliance test timing statistics
+ */
+void DisplayComplianceStats( LmhpComplianceStats_t* stats );
+
 /*!
  * \brief Displays application information
  */
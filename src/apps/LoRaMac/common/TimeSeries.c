@@ -0,0 +1,540 @@
+/*!
+ * \file      TimeSeries.c
+ *
+ * \brief     Delta and run-length time series payload codec
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "utilities.h"
+#include "LoRaMac.h"
+#include "LoRaMacCrypto.h"
+#include "TimeSeries.h"
+
+/*!
+ * Keyframe flag of the record header first byte
+ */
+#define TIME_SERIES_KEYFRAME_FLAG                   0x80
+
+/*!
+ * Maximum number of samples of a record
+ */
+#define TIME_SERIES_RECORD_MAX_SAMPLES              0x7F
+
+/*!
+ * Number of bits of a value width field
+ */
+#define TIME_SERIES_WIDTH_BITS                      6
+
+/*!
+ * Number of bits of a run length field
+ */
+#define TIME_SERIES_RUN_BITS                        4
+
+/*!
+ * Maximum run length of unchanged samples
+ */
+#define TIME_SERIES_RUN_MAX                         ( 1 << TIME_SERIES_RUN_BITS )
+
+/*!
+ * Maximum FCntUp distance between a record and its keyframe
+ */
+#define TIME_SERIES_KEYFRAME_MAX_DISTANCE           255
+
+/*!
+ * Bit stream writer/reader. A NULL buffer only counts the bits.
+ */
+typedef struct sBitStream
+{
+    uint8_t* Buffer;
+    const uint8_t* ReadBuffer;
+    uint16_t Size;
+    uint16_t BitIndex;
+}BitStream_t;
+
+/*!
+ * Number of channels of a sample
+ */
+static uint8_t NbChannels;
+
+/*!
+ * Samples ring buffer
+ */
+static int32_t Samples[TIME_SERIES_MAX_SAMPLES][TIME_SERIES_MAX_CHANNELS];
+
+/*!
+ * Ring buffer index of the oldest sample
+ */
+static uint8_t SamplesHead;
+
+/*!
+ * Number of buffered samples
+ */
+static uint8_t NbSamples;
+
+/*!
+ * Sequence number of the oldest buffered sample
+ */
+static uint16_t SampleSeq;
+
+/*!
+ * Last sample of the last sent keyframe
+ */
+static int32_t KeyframeValues[TIME_SERIES_MAX_CHANNELS];
+
+/*!
+ * FCntUp of the last sent keyframe
+ */
+static uint32_t KeyframeFCnt;
+
+/*!
+ * Number of records sent since the last keyframe
+ */
+static uint8_t RecordsSinceKeyframe;
+
+/*!
+ * Set when the next record must be a keyframe
+ */
+static bool KeyframeRequested;
+
+/*!
+ * Last encoded record, applied by TimeSeriesCommit
+ */
+static struct sPendingRecord
+{
+    uint8_t NbSamples;
+    bool IsKeyframe;
+    uint32_t FCnt;
+}PendingRecord;
+
+static void BitStreamWrite( BitStream_t* stream, uint32_t value, uint8_t nbBits )
+{
+    while( nbBits > 0 )
+    {
+        nbBits--;
+        if( stream->Buffer != NULL )
+        {
+            uint8_t mask = 0x80 >> ( stream->BitIndex & 0x07 );
+
+            if( ( ( value >> nbBits ) & 0x01 ) != 0 )
+            {
+                stream->Buffer[stream->BitIndex >> 3] |= mask;
+            }
+            else
+            {
+                stream->Buffer[stream->BitIndex >> 3] &= ~mask;
+            }
+        }
+        stream->BitIndex++;
+    }
+}
+
+static bool BitStreamRead( BitStream_t* stream, uint8_t nbBits, uint32_t* value )
+{
+    if( ( stream->BitIndex + nbBits ) > ( stream->Size * 8 ) )
+    {
+        return false;
+    }
+    *value = 0;
+    while( nbBits > 0 )
+    {
+        nbBits--;
+        *value = ( *value << 1 ) | ( ( stream->ReadBuffer[stream->BitIndex >> 3] >> ( 7 - ( stream->BitIndex & 0x07 ) ) ) & 0x01 );
+        stream->BitIndex++;
+    }
+    return true;
+}
+
+static uint32_t ZigzagEncode( int32_t value )
+{
+    return ( ( uint32_t )value << 1 ) ^ ( uint32_t )( value >> 31 );
+}
+
+static int32_t ZigzagDecode( uint32_t value )
+{
+    return ( int32_t )( ( value >> 1 ) ^ ( ~( value & 0x01 ) + 1 ) );
+}
+
+static uint8_t GetBitWidth( uint32_t value )
+{
+    uint8_t width = 0;
+
+    while( value != 0 )
+    {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+/*!
+ * Deltas are computed with the unsigned wrap around arithmetic, the decoder
+ * reverses it exactly whatever the sample values.
+ */
+static int32_t Delta( int32_t value, int32_t reference )
+{
+    return ( int32_t )( ( uint32_t )value - ( uint32_t )reference );
+}
+
+static int32_t* GetSample( uint8_t index )
+{
+    return Samples[( SamplesHead + index ) % TIME_SERIES_MAX_SAMPLES];
+}
+
+static bool IsSampleUnchanged( const int32_t* sample, const int32_t* previous )
+{
+    for( uint8_t c = 0; c < NbChannels; c++ )
+    {
+        if( sample[c] != previous[c] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Writes the record bit stream of the nbSamples oldest samples
+ *
+ * \param [IN/OUT] stream     Bit stream, only counts the bits when the buffer is NULL
+ * \param [IN]     nbSamples  Number of samples of the record
+ * \param [IN]     isKeyframe Encodes the first sample as absolute values
+ */
+static void EncodeSamples( BitStream_t* stream, uint8_t nbSamples, bool isKeyframe )
+{
+    const int32_t* previous = KeyframeValues;
+    uint8_t widths[TIME_SERIES_MAX_CHANNELS] = { 0 };
+    uint8_t first = 0;
+
+    if( isKeyframe == true )
+    {
+        previous = GetSample( 0 );
+        for( uint8_t c = 0; c < NbChannels; c++ )
+        {
+            uint32_t value = ZigzagEncode( previous[c] );
+            uint8_t width = GetBitWidth( value );
+
+            BitStreamWrite( stream, width, TIME_SERIES_WIDTH_BITS );
+            BitStreamWrite( stream, value, width );
+        }
+        first = 1;
+    }
+
+    // Delta widths
+    for( uint8_t i = first; i < nbSamples; i++ )
+    {
+        const int32_t* reference = ( i == 0 ) ? KeyframeValues : GetSample( i - 1 );
+
+        for( uint8_t c = 0; c < NbChannels; c++ )
+        {
+            widths[c] = MAX( widths[c], GetBitWidth( ZigzagEncode( Delta( GetSample( i )[c], reference[c] ) ) ) );
+        }
+    }
+    for( uint8_t c = 0; ( c < NbChannels ) && ( first < nbSamples ); c++ )
+    {
+        BitStreamWrite( stream, widths[c], TIME_SERIES_WIDTH_BITS );
+    }
+
+    // Tokens
+    for( uint8_t i = first; i < nbSamples; )
+    {
+        const int32_t* sample = GetSample( i );
+        uint8_t run = 0;
+
+        while( ( ( i + run ) < nbSamples ) && ( run < TIME_SERIES_RUN_MAX ) &&
+               ( IsSampleUnchanged( GetSample( i + run ), previous ) == true ) )
+        {
+            run++;
+        }
+        if( run > 0 )
+        {
+            BitStreamWrite( stream, 1, 1 );
+            BitStreamWrite( stream, run - 1, TIME_SERIES_RUN_BITS );
+            i += run;
+            continue;
+        }
+
+        BitStreamWrite( stream, 0, 1 );
+        for( uint8_t c = 0; c < NbChannels; c++ )
+        {
+            BitStreamWrite( stream, ZigzagEncode( Delta( sample[c], previous[c] ) ), widths[c] );
+        }
+        previous = sample;
+        i++;
+    }
+}
+
+static uint16_t GetRecordSize( uint8_t nbSamples, bool isKeyframe )
+{
+    BitStream_t stream = { .Buffer = NULL, .BitIndex = 0 };
+
+    EncodeSamples( &stream, nbSamples, isKeyframe );
+    return TIME_SERIES_HEADER_SIZE + ( ( stream.BitIndex + 7 ) >> 3 );
+}
+
+void TimeSeriesInit( uint8_t nbChannels )
+{
+    NbChannels = MIN( nbChannels, TIME_SERIES_MAX_CHANNELS );
+    SamplesHead = 0;
+    NbSamples = 0;
+    SampleSeq = 0;
+    RecordsSinceKeyframe = 0;
+    KeyframeRequested = true;
+    PendingRecord.NbSamples = 0;
+}
+
+bool TimeSeriesAddSample( const int32_t* values )
+{
+    bool status = true;
+
+    if( NbSamples >= TIME_SERIES_MAX_SAMPLES )
+    {
+        // Drop the oldest sample, the sequence number gap reports it
+        SamplesHead = ( SamplesHead + 1 ) % TIME_SERIES_MAX_SAMPLES;
+        NbSamples--;
+        SampleSeq++;
+        // The last encoded record no longer matches the buffer
+        PendingRecord.NbSamples = 0;
+        status = false;
+    }
+    memcpy1( ( uint8_t* )GetSample( NbSamples ), ( const uint8_t* )values, NbChannels * sizeof( int32_t ) );
+    NbSamples++;
+    return status;
+}
+
+uint8_t TimeSeriesGetNbPendingSamples( void )
+{
+    return NbSamples;
+}
+
+void TimeSeriesRequestKeyframe( void )
+{
+    KeyframeRequested = true;
+}
+
+uint8_t TimeSeriesEncode( uint32_t fCntUp, uint8_t maxSize, uint8_t* buffer )
+{
+    uint8_t maxSamples = MIN( NbSamples, TIME_SERIES_RECORD_MAX_SAMPLES );
+    uint8_t nbSamples = 0;
+    bool isKeyframe = false;
+    BitStream_t stream = { .Buffer = buffer + TIME_SERIES_HEADER_SIZE, .BitIndex = 0 };
+
+    PendingRecord.NbSamples = 0;
+
+    if( ( buffer == NULL ) || ( maxSamples == 0 ) || ( maxSize <= TIME_SERIES_HEADER_SIZE ) )
+    {
+        return 0;
+    }
+
+    if( ( KeyframeRequested == true ) || ( RecordsSinceKeyframe >= ( TIME_SERIES_KEYFRAME_PERIOD - 1 ) ) ||
+        ( ( fCntUp - KeyframeFCnt ) == 0 ) || ( ( fCntUp - KeyframeFCnt ) > TIME_SERIES_KEYFRAME_MAX_DISTANCE ) )
+    {
+        isKeyframe = true;
+    }
+
+    // The record size grows with the number of samples
+    while( ( nbSamples < maxSamples ) && ( GetRecordSize( nbSamples + 1, isKeyframe ) <= maxSize ) )
+    {
+        nbSamples++;
+    }
+    if( nbSamples == 0 )
+    {
+        return 0;
+    }
+
+    buffer[0] = ( isKeyframe == true ) ? ( TIME_SERIES_KEYFRAME_FLAG | nbSamples ) : nbSamples;
+    buffer[1] = ( isKeyframe == true ) ? 0 : ( uint8_t )( fCntUp - KeyframeFCnt );
+    buffer[2] = SampleSeq & 0xFF;
+    buffer[3] = ( SampleSeq >> 8 ) & 0xFF;
+    EncodeSamples( &stream, nbSamples, isKeyframe );
+    // Zero padding
+    BitStreamWrite( &stream, 0, ( 8 - ( stream.BitIndex & 0x07 ) ) & 0x07 );
+
+    PendingRecord.NbSamples = nbSamples;
+    PendingRecord.IsKeyframe = isKeyframe;
+    PendingRecord.FCnt = fCntUp;
+
+    return TIME_SERIES_HEADER_SIZE + ( stream.BitIndex >> 3 );
+}
+
+void TimeSeriesCommit( void )
+{
+    if( PendingRecord.NbSamples == 0 )
+    {
+        return;
+    }
+
+    if( PendingRecord.IsKeyframe == true )
+    {
+        memcpy1( ( uint8_t* )KeyframeValues, ( const uint8_t* )GetSample( PendingRecord.NbSamples - 1 ), NbChannels * sizeof( int32_t ) );
+        KeyframeFCnt = PendingRecord.FCnt;
+        KeyframeRequested = false;
+        RecordsSinceKeyframe = 0;
+    }
+    else
+    {
+        RecordsSinceKeyframe++;
+    }
+
+    SamplesHead = ( SamplesHead + PendingRecord.NbSamples ) % TIME_SERIES_MAX_SAMPLES;
+    NbSamples -= PendingRecord.NbSamples;
+    SampleSeq += PendingRecord.NbSamples;
+    PendingRecord.NbSamples = 0;
+}
+
+LmHandlerErrorStatus_t TimeSeriesSend( uint8_t port, uint8_t* buffer, uint8_t bufferSize, LmHandlerMsgTypes_t isTxConfirmed )
+{
+    LoRaMacTxInfo_t txInfo;
+    LmHandlerAppData_t appData;
+    uint32_t fCntUp = 0;
+
+    if( LmHandlerIsBusy( ) == true )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+
+    txInfo.MaxPossibleApplicationDataSize = 0;
+    // The maximum application payload size already accounts for the pending MAC commands
+    LoRaMacQueryTxPossible( 0, &txInfo );
+    if( LoRaMacCryptoGetFCntUp( &fCntUp ) != LORAMAC_CRYPTO_SUCCESS )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+
+    appData.Port = port;
+    appData.Buffer = buffer;
+    // An empty record still sends the pending MAC commands, the samples are kept
+    appData.BufferSize = TimeSeriesEncode( fCntUp, MIN( bufferSize, txInfo.MaxPossibleApplicationDataSize ), buffer );
+
+    if( LmHandlerSend( &appData, isTxConfirmed ) != LORAMAC_HANDLER_SUCCESS )
+    {
+        PendingRecord.NbSamples = 0;
+        return LORAMAC_HANDLER_ERROR;
+    }
+    TimeSeriesCommit( );
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+void TimeSeriesDecoderInit( TimeSeriesDecoder_t* decoder, uint8_t nbChannels )
+{
+    decoder->NbChannels = MIN( nbChannels, TIME_SERIES_MAX_CHANNELS );
+    decoder->KeyframeValid = false;
+    decoder->KeyframeFCnt = 0;
+}
+
+int16_t TimeSeriesDecode( TimeSeriesDecoder_t* decoder, uint32_t fCntUp, const uint8_t* buffer, uint8_t size,
+                          uint16_t* firstSeq, int32_t values[][TIME_SERIES_MAX_CHANNELS], uint8_t maxSamples )
+{
+    BitStream_t stream = { .BitIndex = 0 };
+    int32_t reference[TIME_SERIES_MAX_CHANNELS];
+    uint8_t widths[TIME_SERIES_MAX_CHANNELS];
+    uint8_t nbChannels = decoder->NbChannels;
+    uint8_t nbSamples;
+    uint8_t i = 0;
+    uint32_t value;
+    bool isKeyframe;
+
+    if( ( buffer == NULL ) || ( size < TIME_SERIES_HEADER_SIZE ) )
+    {
+        return -1;
+    }
+    stream.ReadBuffer = buffer + TIME_SERIES_HEADER_SIZE;
+    stream.Size = size - TIME_SERIES_HEADER_SIZE;
+    isKeyframe = ( buffer[0] & TIME_SERIES_KEYFRAME_FLAG ) != 0;
+    nbSamples = buffer[0] & TIME_SERIES_RECORD_MAX_SAMPLES;
+    *firstSeq = ( uint16_t )buffer[2] | ( ( uint16_t )buffer[3] << 8 );
+
+    if( ( nbSamples == 0 ) || ( nbSamples > maxSamples ) )
+    {
+        return -1;
+    }
+    if( isKeyframe == false )
+    {
+        // The referred keyframe must be the last received one
+        if( ( decoder->KeyframeValid == false ) || ( ( fCntUp - decoder->KeyframeFCnt ) != buffer[1] ) )
+        {
+            return -1;
+        }
+        memcpy1( ( uint8_t* )reference, ( const uint8_t* )decoder->KeyframeValues, nbChannels * sizeof( int32_t ) );
+    }
+    else
+    {
+        for( uint8_t c = 0; c < nbChannels; c++ )
+        {
+            if( ( BitStreamRead( &stream, TIME_SERIES_WIDTH_BITS, &value ) == false ) ||
+                ( value > 32 ) || ( BitStreamRead( &stream, value, &value ) == false ) )
+            {
+                return -1;
+            }
+            reference[c] = ZigzagDecode( value );
+            values[0][c] = reference[c];
+        }
+        i = 1;
+    }
+
+    for( uint8_t c = 0; ( c < nbChannels ) && ( i < nbSamples ); c++ )
+    {
+        if( ( BitStreamRead( &stream, TIME_SERIES_WIDTH_BITS, &value ) == false ) || ( value > 32 ) )
+        {
+            return -1;
+        }
+        widths[c] = value;
+    }
+
+    while( i < nbSamples )
+    {
+        if( BitStreamRead( &stream, 1, &value ) == false )
+        {
+            return -1;
+        }
+        if( value != 0 )
+        {
+            if( BitStreamRead( &stream, TIME_SERIES_RUN_BITS, &value ) == false )
+            {
+                return -1;
+            }
+            for( uint8_t run = 0; run <= value; run++ )
+            {
+                if( i >= nbSamples )
+                {
+                    return -1;
+                }
+                memcpy1( ( uint8_t* )values[i++], ( const uint8_t* )reference, nbChannels * sizeof( int32_t ) );
+            }
+            continue;
+        }
+        for( uint8_t c = 0; c < nbChannels; c++ )
+        {
+            if( BitStreamRead( &stream, widths[c], &value ) == false )
+            {
+                return -1;
+            }
+            reference[c] = ( int32_t )( ( uint32_t )reference[c] + ( uint32_t )ZigzagDecode( value ) );
+            values[i][c] = reference[c];
+        }
+        i++;
+    }
+
+    if( isKeyframe == true )
+    {
+        memcpy1( ( uint8_t* )decoder->KeyframeValues, ( const uint8_t* )values[nbSamples - 1], nbChannels * sizeof( int32_t ) );
+        decoder->KeyframeFCnt = fCntUp;
+        decoder->KeyframeValid = true;
+    }
+    return nbSamples;
+}
@@ -0,0 +1,192 @@
+/*!
+ * \file      TimeSeries.h
+ *
+ * \brief     Delta and run-length time series payload codec
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  TIMESERIES Time series codec
+ *            Buffers the periodic samples of up to TIME_SERIES_MAX_CHANNELS
+ *            channels and packs as many of them as possible in each uplink.
+ *
+ *            Record format:
+ *            - byte 0    bit 7: keyframe, bits 6..0: number of samples
+ *            - byte 1    keyframe: 0, otherwise FCntUp distance to the keyframe
+ *                        the record refers to
+ *            - bytes 2-3 sequence number of the first sample (little endian)
+ *            - bit stream, MSB first, zero padded to the byte boundary:
+ *              - keyframe only: per channel, 6 bits width followed by the
+ *                zigzag encoded absolute value of the first sample
+ *              - per channel, 6 bits width of the zigzag encoded deltas,
+ *                omitted when the record holds a single keyframe sample
+ *              - one token per remaining sample:
+ *                - '0' followed by the zigzag encoded delta of each channel
+ *                - '1' followed by 4 bits, run of 1 to 16 unchanged samples
+ *
+ *            The deltas are computed against the previous sample. The first
+ *            sample of a non keyframe record is encoded against the last
+ *            sample of the keyframe it refers to, so that a lost record only
+ *            loses its own samples.
+ *            A keyframe is sent every TIME_SERIES_KEYFRAME_PERIOD records or
+ *            when the referred keyframe is too old to be addressed.
+ * \{
+ */
+#ifndef __TIME_SERIES_H__
+#define __TIME_SERIES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LmHandler.h"
+
+/*!
+ * Maximum number of channels of a sample
+ */
+#ifndef TIME_SERIES_MAX_CHANNELS
+#define TIME_SERIES_MAX_CHANNELS                    4
+#endif
+
+/*!
+ * Number of samples which can be buffered
+ */
+#ifndef TIME_SERIES_MAX_SAMPLES
+#define TIME_SERIES_MAX_SAMPLES                     32
+#endif
+
+/*!
+ * Number of records after which a keyframe is sent
+ */
+#ifndef TIME_SERIES_KEYFRAME_PERIOD
+#define TIME_SERIES_KEYFRAME_PERIOD                 8
+#endif
+
+/*!
+ * Size of the record header
+ */
+#define TIME_SERIES_HEADER_SIZE                     4
+
+/*!
+ * Time series decoder context (network server side)
+ */
+typedef struct sTimeSeriesDecoder
+{
+    /*!
+     * Number of channels of a sample
+     */
+    uint8_t NbChannels;
+    /*!
+     * Set once a keyframe has been decoded
+     */
+    bool KeyframeValid;
+    /*!
+     * FCntUp of the last decoded keyframe
+     */
+    uint32_t KeyframeFCnt;
+    /*!
+     * Last sample of the last decoded keyframe
+     */
+    int32_t KeyframeValues[TIME_SERIES_MAX_CHANNELS];
+}TimeSeriesDecoder_t;
+
+/*!
+ * \brief Initializes the time series encoder and drops the buffered samples
+ *
+ * \param [IN] nbChannels Number of channels of a sample
+ */
+void TimeSeriesInit( uint8_t nbChannels );
+
+/*!
+ * \brief Buffers a sample. The oldest sample is dropped when the buffer is full
+ *
+ * \param [IN] values Sample values, one per channel
+ *
+ * \retval status [true: sample buffered, false: oldest sample dropped]
+ */
+bool TimeSeriesAddSample( const int32_t* values );
+
+/*!
+ * \brief Gets the number of buffered samples
+ *
+ * \retval nbSamples Number of samples waiting to be sent
+ */
+uint8_t TimeSeriesGetNbPendingSamples( void );
+
+/*!
+ * \brief Forces the next record to be a keyframe
+ *
+ * \remark To be called when the network server reports a decoding failure
+ */
+void TimeSeriesRequestKeyframe( void );
+
+/*!
+ * \brief Encodes a record holding as many of the oldest buffered samples as
+ *        fit in the given size
+ *
+ * \remark The samples stay buffered until TimeSeriesCommit is called
+ *
+ * \param [IN]  fCntUp  FCntUp of the uplink carrying the record
+ * \param [IN]  maxSize Maximum record size
+ * \param [OUT] buffer  Record buffer
+ *
+ * \retval size Record size, 0 if no sample fits
+ */
+uint8_t TimeSeriesEncode( uint32_t fCntUp, uint8_t maxSize, uint8_t* buffer );
+
+/*!
+ * \brief Drops the samples of the last encoded record once it has been sent
+ */
+void TimeSeriesCommit( void );
+
+/*!
+ * \brief Encodes a record fitting in the next uplink at the current datarate
+ *        and sends it
+ *
+ * \param [IN] port          Application port
+ * \param [IN] buffer        Record buffer
+ * \param [IN] bufferSize    Record buffer size
+ * \param [IN] isTxConfirmed Indicates if the uplink requires an acknowledgement
+ *
+ * \retval status [LORAMAC_HANDLER_SUCCESS, LORAMAC_HANDLER_ERROR]
+ */
+LmHandlerErrorStatus_t TimeSeriesSend( uint8_t port, uint8_t* buffer, uint8_t bufferSize, LmHandlerMsgTypes_t isTxConfirmed );
+
+/*!
+ * \brief Initializes a time series decoder context
+ *
+ * \param [OUT] decoder    Decoder context
+ * \param [IN]  nbChannels Number of channels of a sample
+ */
+void TimeSeriesDecoderInit( TimeSeriesDecoder_t* decoder, uint8_t nbChannels );
+
+/*!
+ * \brief Decodes a record
+ *
+ * \param [IN/OUT] decoder    Decoder context
+ * \param [IN]     fCntUp     FCntUp of the uplink carrying the record
+ * \param [IN]     buffer     Record buffer
+ * \param [IN]     size       Record size
+ * \param [OUT]    firstSeq   Sequence number of the first decoded sample
+ * \param [OUT]    values     Decoded samples
+ * \param [IN]     maxSamples Maximum number of samples values can hold
+ *
+ * \retval nbSamples Number of decoded samples, -1 if the record is malformed
+ *                   or refers to a keyframe which has not been received
+ */
+int16_t TimeSeriesDecode( TimeSeriesDecoder_t* decoder, uint32_t fCntUp, const uint8_t* buffer, uint8_t size,
+                          uint16_t* firstSeq, int32_t values[][TIME_SERIES_MAX_CHANNELS], uint8_t maxSamples );
+
+/*! \} defgroup TIMESERIES */
+
+#endif // __TIME_SERIES_H__
@@ -223,6 +223,7 @@ static LmhpComplianceParams_t LmhpComplianceParams =
     .DutyCycleEnabled = LORAWAN_DUTYCYCLE_ON,
     .StopPeripherals = NULL,
     .StartPeripherals = NULL,
+    .OnTestStop = DisplayComplianceStats,
 };
 
 /*!
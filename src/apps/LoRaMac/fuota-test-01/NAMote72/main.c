@@ -215,7 +215,8 @@ static LmhpComplianceParams_t LmhpComplianceParams =
     .AdrEnabled = LORAWAN_ADR_STATE,
     .DutyCycleEnabled = LORAWAN_DUTYCYCLE_ON,
     .StopPeripherals = GpsStop,
-    .StartPeripherals = GpsStart
+    .StartPeripherals = GpsStart,
+    .OnTestStop = DisplayComplianceStats
 };
 
 /*!
@@ -221,6 +221,7 @@ static LmhpComplianceParams_t LmhpComplianceParams =
     .DutyCycleEnabled = LORAWAN_DUTYCYCLE_ON,
     .StopPeripherals = NULL,
     .StartPeripherals = NULL,
+    .OnTestStop = DisplayComplianceStats,
 };
 
 /*!
@@ -441,6 +442,8 @@ static void StartTxProcess( LmHandlerTxEvents_t txEvent )
         {
             // Schedule 1st packet transmission
             TimerInit( &TxTimer, OnTxTimerEvent );
+            // The period is randomized anyway, let the uplink share a wake up
+            TimerSetSlack( &TxTimer, APP_TX_DUTYCYCLE_RND );
             TimerSetValue( &TxTimer, APP_TX_DUTYCYCLE  + randr( -APP_TX_DUTYCYCLE_RND, APP_TX_DUTYCYCLE_RND ) );
             OnTxTimerEvent( NULL );
         }
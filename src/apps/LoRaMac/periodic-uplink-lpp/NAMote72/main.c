@@ -213,7 +213,8 @@ static LmhpComplianceParams_t LmhpComplianceParams =
     .AdrEnabled = LORAWAN_ADR_STATE,
     .DutyCycleEnabled = LORAWAN_DUTYCYCLE_ON,
     .StopPeripherals = GpsStop,
-    .StartPeripherals = GpsStart
+    .StartPeripherals = GpsStart,
+    .OnTestStop = DisplayComplianceStats
 };
 
 /*!
@@ -470,6 +471,8 @@ static void StartTxProcess( LmHandlerTxEvents_t txEvent )
         {
             // Schedule 1st packet transmission
             TimerInit( &TxTimer, OnTxTimerEvent );
+            // The period is randomized anyway, let the uplink share a wake up
+            TimerSetSlack( &TxTimer, APP_TX_DUTYCYCLE_RND );
             TimerSetValue( &TxTimer, APP_TX_DUTYCYCLE  + randr( -APP_TX_DUTYCYCLE_RND, APP_TX_DUTYCYCLE_RND ) );
             OnTxTimerEvent( NULL );
         }
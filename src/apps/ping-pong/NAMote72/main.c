@@ -28,6 +28,10 @@
 #include "timer.h"
 #include "radio.h"
 
+#if defined( PING_PONG_BENCHMARK )
+#include "PingPongBenchmark.h"
+#endif
+
 #if defined( REGION_AS923 )
 
 #define RF_FREQUENCY                                923000000 // Hz
@@ -167,6 +171,18 @@ int main( void )
     BoardInitMcu( );
     BoardInitPeriph( );
 
+#if defined( PING_PONG_BENCHMARK )
+    // Payload size and modem settings sweep. Replaces the ping-pong application.
+    PingPongBenchmarkInit( RF_FREQUENCY, TX_OUTPUT_POWER );
+
+    while( 1 )
+    {
+        PingPongBenchmarkProcess( );
+
+        BoardLowPowerHandler( );
+    }
+#endif
+
     // Radio initialization
     RadioEvents.TxDone = OnTxDone;
     RadioEvents.RxDone = OnRxDone;
@@ -29,6 +29,10 @@
 #include "timer.h"
 #include "radio.h"
 
+#if defined( PING_PONG_BENCHMARK )
+#include "PingPongBenchmark.h"
+#endif
+
 #if defined( REGION_AS923 )
 
 #define RF_FREQUENCY                                923000000 // Hz
@@ -175,6 +179,21 @@ int main( void )
     BoardInitMcu( );
     BoardInitPeriph( );
 
+#if defined( PING_PONG_BENCHMARK )
+    // Payload size and modem settings sweep. Replaces the ping-pong application.
+    PingPongBenchmarkInit( RF_FREQUENCY, TX_OUTPUT_POWER );
+
+    while( 1 )
+    {
+        // Tick the RTC to execute callback in context of the main loop (in stead of the IRQ)
+        TimerProcess( );
+
+        PingPongBenchmarkProcess( );
+
+        BoardLowPowerHandler( );
+    }
+#endif
+
     // Radio initialization
     RadioEvents.TxDone = OnTxDone;
     RadioEvents.RxDone = OnRxDone;
@@ -0,0 +1,689 @@
+/*!
+ * \file      PingPongBenchmark.c
+ *
+ * \brief     Ping-Pong throughput and latency benchmark
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "utilities.h"
+#include "delay.h"
+#include "timer.h"
+#include "radio.h"
+#include "PingPongBenchmark.h"
+
+#if defined( SX1261MBXBAS ) || defined( SX1262MBXCAS ) || defined( SX1262MBXDAS )
+
+#define FSK_BANDWIDTH                               100000    // Hz >> DSB in sx126x
+#define FSK_AFC_BANDWIDTH                           166666    // Hz >> Unused in sx126x
+
+#else
+
+#define FSK_BANDWIDTH                               50000     // Hz >> SSB in sx127x
+#define FSK_AFC_BANDWIDTH                           83333     // Hz
+
+#endif
+
+#define FSK_FDEV                                    25000     // Hz
+#define FSK_PREAMBLE_LENGTH                         5         // Same for Tx and Rx
+#define LORA_CODINGRATE                             1         // 4/5
+#define LORA_PREAMBLE_LENGTH                        8         // Same for Tx and Rx
+
+/*!
+ * Maximum time allowed to transmit a frame [ms]
+ */
+#define BENCHMARK_TX_TIMEOUT                        5000
+
+/*!
+ * Time added to the frame time on air when waiting for an answer [ms]
+ */
+#define BENCHMARK_RX_MARGIN                         100
+
+/*!
+ * Synchronization frames answer timeout on the control setting [ms]
+ *
+ * \remark A random delay of up to BENCHMARK_SYNC_JITTER is added in order to
+ *         solve the collisions when both devices start at the same time
+ */
+#define BENCHMARK_SYNC_RX_TIMEOUT                   500
+#define BENCHMARK_SYNC_JITTER                       500
+
+/*!
+ * Time after which a test is skipped when the slave does not answer the
+ * synchronization frames [ms]
+ */
+#define BENCHMARK_SYNC_TIMEOUT                      30000
+
+/*!
+ * Time given to the slave to switch to the test setting [ms]
+ */
+#define BENCHMARK_SWITCH_DELAY                      20
+
+/*!
+ * Number of round trip times without PING frame after which the slave goes
+ * back to the control setting
+ */
+#define BENCHMARK_SLAVE_IDLE_RTT                    3
+
+/*!
+ * Frame header. Tag, test index and sequence number
+ */
+#define BENCHMARK_HEADER_SIZE                       7
+
+#define BENCHMARK_BUFFER_SIZE                       255
+
+/*!
+ * Modem setting
+ */
+typedef struct BenchmarkSetting_s
+{
+    /*!
+     * Modem to be used
+     */
+    RadioModems_t Modem;
+    /*!
+     * LoRa bandwidth [0: 125 kHz, 1: 250 kHz, 2: 500 kHz]. Unused for FSK.
+     */
+    uint32_t Bandwidth;
+    /*!
+     * LoRa spreading factor or FSK datarate [bps]
+     */
+    uint32_t Datarate;
+}BenchmarkSetting_t;
+
+/*!
+ * Swept modem settings. The first one is the control setting.
+ */
+static const BenchmarkSetting_t Settings[] =
+{
+    { MODEM_LORA, 0,  7 },
+    { MODEM_LORA, 0,  9 },
+    { MODEM_LORA, 0, 10 },
+    { MODEM_LORA, 1,  7 },
+    { MODEM_LORA, 2,  7 },
+    { MODEM_FSK,  0, 50000 },
+};
+
+#define BENCHMARK_SETTINGS_NB                       ( sizeof( Settings ) / sizeof( Settings[0] ) )
+
+/*!
+ * Swept payload sizes
+ */
+static const uint8_t PayloadSizes[] = { 16, 64, 128, 255 };
+
+#define BENCHMARK_SIZES_NB                          ( sizeof( PayloadSizes ) / sizeof( PayloadSizes[0] ) )
+
+#define BENCHMARK_TESTS_NB                          ( BENCHMARK_SETTINGS_NB * BENCHMARK_SIZES_NB )
+
+/*!
+ * Frame tags
+ */
+static const uint8_t PingMsg[] = "PING";
+static const uint8_t PongMsg[] = "PONG";
+static const uint8_t SyncMsg[] = "SYNC";
+static const uint8_t SyncAckMsg[] = "SACK";
+
+/*!
+ * Radio events
+ */
+typedef enum
+{
+    LOWPOWER,
+    RX,
+    RX_TIMEOUT,
+    RX_ERROR,
+    TX,
+    TX_TIMEOUT,
+}States_t;
+
+/*!
+ * Benchmark phases
+ */
+typedef enum
+{
+    PHASE_SYNC,
+    PHASE_TEST,
+}Phases_t;
+
+/*!
+ * Radio events function pointer
+ */
+static RadioEvents_t RadioEvents;
+
+static uint8_t Buffer[BENCHMARK_BUFFER_SIZE];
+static uint16_t BufferSize = 0;
+
+static volatile States_t State = LOWPOWER;
+
+/*!
+ * Time at which the last frame has been received
+ */
+static TimerTime_t RxTime = 0;
+
+/*!
+ * Tx output power [dBm]
+ */
+static int8_t TxPower = 0;
+
+static bool IsMaster = true;
+static Phases_t Phase = PHASE_SYNC;
+
+/*!
+ * Current test index. Setting index * BENCHMARK_SIZES_NB + payload size index
+ */
+static uint8_t TestIndex = 0;
+
+/*!
+ * Current PING frame sequence number
+ */
+static uint16_t Seq = 0;
+
+/*!
+ * Current test frames time on air and answer timeout [ms]
+ */
+static uint32_t TestTimeOnAir = 0;
+static uint32_t TestRxTimeout = 0;
+
+/*!
+ * Current test statistics
+ */
+static TimerTime_t TestStartTime = 0;
+static TimerTime_t SyncStartTime = 0;
+static TimerTime_t TxTime = 0;
+static uint16_t Received = 0;
+static uint32_t Rtt[BENCHMARK_PACKETS];
+
+/*!
+ * Number of completed sweeps
+ */
+static uint32_t Run = 0;
+
+/*!
+ * \brief Function to be executed on Radio Tx Done event
+ */
+static void OnBenchmarkTxDone( void );
+
+/*!
+ * \brief Function to be executed on Radio Rx Done event
+ */
+static void OnBenchmarkRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr );
+
+/*!
+ * \brief Function executed on Radio Tx Timeout event
+ */
+static void OnBenchmarkTxTimeout( void );
+
+/*!
+ * \brief Function executed on Radio Rx Timeout event
+ */
+static void OnBenchmarkRxTimeout( void );
+
+/*!
+ * \brief Function executed on Radio Rx Error event
+ */
+static void OnBenchmarkRxError( void );
+
+/*!
+ * \brief Configures the radio with the given modem setting
+ *
+ * \param [IN] setting Modem setting
+ */
+static void ApplySetting( const BenchmarkSetting_t *setting )
+{
+    if( setting->Modem == MODEM_LORA )
+    {
+        Radio.SetTxConfig( MODEM_LORA, TxPower, 0, setting->Bandwidth,
+                                       setting->Datarate, LORA_CODINGRATE,
+                                       LORA_PREAMBLE_LENGTH, false,
+                                       true, 0, 0, false, BENCHMARK_TX_TIMEOUT );
+
+        Radio.SetRxConfig( MODEM_LORA, setting->Bandwidth, setting->Datarate,
+                                       LORA_CODINGRATE, 0, LORA_PREAMBLE_LENGTH,
+                                       0, false,
+                                       0, true, 0, 0, false, true );
+    }
+    else
+    {
+        Radio.SetTxConfig( MODEM_FSK, TxPower, FSK_FDEV, 0,
+                                      setting->Datarate, 0,
+                                      FSK_PREAMBLE_LENGTH, false,
+                                      true, 0, 0, 0, BENCHMARK_TX_TIMEOUT );
+
+        Radio.SetRxConfig( MODEM_FSK, FSK_BANDWIDTH, setting->Datarate,
+                                      0, FSK_AFC_BANDWIDTH, FSK_PREAMBLE_LENGTH,
+                                      0, false, 0, true,
+                                      0, 0, false, true );
+    }
+}
+
+/*!
+ * \brief Switches the radio to the current test setting and computes the
+ *        test timings
+ */
+static void ApplyTestSetting( void )
+{
+    const BenchmarkSetting_t *setting = &Settings[TestIndex / BENCHMARK_SIZES_NB];
+
+    ApplySetting( setting );
+    TestTimeOnAir = Radio.TimeOnAir( setting->Modem, PayloadSizes[TestIndex % BENCHMARK_SIZES_NB] );
+    TestRxTimeout = TestTimeOnAir + BENCHMARK_RX_MARGIN;
+}
+
+/*!
+ * \brief Fills the frame header
+ *
+ * \param [IN] tag Frame tag
+ */
+static void SetHeader( const uint8_t *tag )
+{
+    memcpy1( Buffer, tag, 4 );
+    Buffer[4] = TestIndex;
+    Buffer[5] = Seq & 0xFF;
+    Buffer[6] = ( Seq >> 8 ) & 0xFF;
+}
+
+/*!
+ * \brief Checks the received frame header
+ *
+ * \param [IN] tag Expected frame tag
+ *
+ * \retval match True if the received frame is a tag frame
+ */
+static bool IsFrame( const uint8_t *tag )
+{
+    if( BufferSize < BENCHMARK_HEADER_SIZE )
+    {
+        return false;
+    }
+    return strncmp( ( const char* )Buffer, ( const char* )tag, 4 ) == 0;
+}
+
+static uint16_t GetFrameSeq( void )
+{
+    return ( uint16_t )Buffer[5] | ( ( uint16_t )Buffer[6] << 8 );
+}
+
+/*!
+ * \brief Master - Announces the current test on the control setting
+ */
+static void SendSync( void )
+{
+    Phase = PHASE_SYNC;
+    Seq = 0;
+    ApplySetting( &Settings[0] );
+    SetHeader( SyncMsg );
+    DelayMs( 1 );
+    Radio.Send( Buffer, BENCHMARK_HEADER_SIZE );
+}
+
+/*!
+ * \brief Master - Sends the current PING frame
+ */
+static void SendPing( void )
+{
+    uint8_t size = PayloadSizes[TestIndex % BENCHMARK_SIZES_NB];
+
+    SetHeader( PingMsg );
+    // We fill the buffer with numbers for the payload
+    for( uint16_t i = BENCHMARK_HEADER_SIZE; i < size; i++ )
+    {
+        Buffer[i] = i - BENCHMARK_HEADER_SIZE;
+    }
+    TxTime = TimerGetCurrentTime( );
+    Radio.Send( Buffer, size );
+}
+
+/*!
+ * \brief Master - Prints the CSV header
+ */
+static void PrintHeader( void )
+{
+    printf( "\r\n###### ===== Ping-Pong benchmark run %lu ==== ######\r\n", Run );
+    printf( "modem,bw,dr,size,toa,sent,received,per,rtt_min,rtt_med,rtt_p90,rtt_max,rtt_avg,goodput\r\n" );
+}
+
+/*!
+ * \brief Master - Prints the current test results
+ *
+ * \param [IN] sent Number of PING frames sent
+ */
+static void PrintTestResults( uint16_t sent )
+{
+    const BenchmarkSetting_t *setting = &Settings[TestIndex / BENCHMARK_SIZES_NB];
+    uint8_t size = PayloadSizes[TestIndex % BENCHMARK_SIZES_NB];
+    uint32_t bandwidth = ( setting->Modem == MODEM_LORA ) ? setting->Bandwidth : FSK_BANDWIDTH;
+    TimerTime_t duration = TimerGetElapsedTime( TestStartTime );
+    uint32_t per = 1000;
+    uint32_t rttSum = 0;
+    uint32_t goodput = 0;
+
+    // Sorts the round trip times for the distribution
+    for( uint16_t i = 1; i < Received; i++ )
+    {
+        uint32_t rtt = Rtt[i];
+        uint16_t j = i;
+
+        while( ( j > 0 ) && ( Rtt[j - 1] > rtt ) )
+        {
+            Rtt[j] = Rtt[j - 1];
+            j--;
+        }
+        Rtt[j] = rtt;
+    }
+    for( uint16_t i = 0; i < Received; i++ )
+    {
+        rttSum += Rtt[i];
+    }
+    if( sent > 0 )
+    {
+        per = ( ( uint32_t )( sent - Received ) * 1000 ) / sent;
+    }
+    if( duration > 0 )
+    {
+        goodput = ( uint32_t )( ( ( uint64_t )Received * size * 8 * 1000 ) / duration );
+    }
+
+    printf( "%s,%lu,%lu,%u,%lu,%u,%u,%lu,", ( setting->Modem == MODEM_LORA ) ? "LORA" : "FSK",
+            bandwidth, setting->Datarate, size, TestTimeOnAir, sent, Received, per );
+    if( Received > 0 )
+    {
+        printf( "%lu,%lu,%lu,%lu,%lu,%lu\r\n", Rtt[0], Rtt[Received / 2], Rtt[( Received * 9 ) / 10],
+                Rtt[Received - 1], rttSum / Received, goodput );
+    }
+    else
+    {
+        printf( "-,-,-,-,-,0\r\n" );
+    }
+}
+
+/*!
+ * \brief Master - Starts the next test. Starts a new sweep once all the tests
+ *        are done.
+ */
+static void NextTest( void )
+{
+    TestIndex++;
+    TestTimeOnAir = 0;
+    Received = 0;
+    if( TestIndex >= BENCHMARK_TESTS_NB )
+    {
+        TestIndex = 0;
+        Run++;
+        PrintHeader( );
+    }
+    SyncStartTime = TimerGetCurrentTime( );
+    SendSync( );
+}
+
+/*!
+ * \brief Master - Sends the next PING frame or ends the test
+ */
+static void NextPing( void )
+{
+    Seq++;
+    if( Seq >= BENCHMARK_PACKETS )
+    {
+        PrintTestResults( Seq );
+        NextTest( );
+    }
+    else
+    {
+        SendPing( );
+    }
+}
+
+/*!
+ * \brief Slave - Goes back to the control setting and waits for the next
+ *        synchronization frame
+ */
+static void WaitSync( void )
+{
+    Phase = PHASE_SYNC;
+    ApplySetting( &Settings[0] );
+    Radio.Rx( 0 );
+}
+
+static void ProcessSlave( States_t state );
+
+/*!
+ * \brief Master radio events processing
+ */
+static void ProcessMaster( States_t state )
+{
+    switch( state )
+    {
+    case RX:
+        if( Phase == PHASE_SYNC )
+        {
+            if( IsFrame( SyncMsg ) == true )
+            {
+                // A master already exists then become a slave
+                IsMaster = false;
+                ProcessSlave( state );
+            }
+            else if( ( IsFrame( SyncAckMsg ) == true ) && ( Buffer[4] == TestIndex ) )
+            {
+                Phase = PHASE_TEST;
+                Received = 0;
+                ApplyTestSetting( );
+                DelayMs( BENCHMARK_SWITCH_DELAY );
+                TestStartTime = TimerGetCurrentTime( );
+                SendPing( );
+            }
+            else
+            {
+                SendSync( );
+            }
+        }
+        else
+        {
+            if( ( IsFrame( PongMsg ) == true ) && ( Buffer[4] == TestIndex ) && ( GetFrameSeq( ) == Seq ) )
+            {
+                Rtt[Received++] = RxTime - TxTime;
+            }
+            NextPing( );
+        }
+        break;
+    case TX:
+        if( Phase == PHASE_SYNC )
+        {
+            Radio.Rx( BENCHMARK_SYNC_RX_TIMEOUT + ( Radio.Random( ) % BENCHMARK_SYNC_JITTER ) );
+        }
+        else
+        {
+            Radio.Rx( TestRxTimeout );
+        }
+        break;
+    case RX_TIMEOUT:
+    case RX_ERROR:
+    case TX_TIMEOUT:
+        if( Phase == PHASE_SYNC )
+        {
+            if( TimerGetElapsedTime( SyncStartTime ) > BENCHMARK_SYNC_TIMEOUT )
+            {
+                // The slave does not answer. Skip the test.
+                PrintTestResults( 0 );
+                NextTest( );
+            }
+            else
+            {
+                SendSync( );
+            }
+        }
+        else
+        {
+            NextPing( );
+        }
+        break;
+    case LOWPOWER:
+    default:
+        break;
+    }
+}
+
+/*!
+ * \brief Slave radio events processing
+ */
+static void ProcessSlave( States_t state )
+{
+    uint32_t idleTimeout = BENCHMARK_SLAVE_IDLE_RTT * ( 2 * TestTimeOnAir + BENCHMARK_RX_MARGIN );
+
+    switch( state )
+    {
+    case RX:
+        if( Phase == PHASE_SYNC )
+        {
+            if( IsFrame( SyncMsg ) == true )
+            {
+                TestIndex = Buffer[4];
+                Seq = 0;
+                SetHeader( SyncAckMsg );
+                DelayMs( 1 );
+                Radio.Send( Buffer, BENCHMARK_HEADER_SIZE );
+            }
+            else
+            {
+                Radio.Rx( 0 );
+            }
+        }
+        else
+        {
+            if( ( IsFrame( PingMsg ) == true ) && ( Buffer[4] == TestIndex ) )
+            {
+                // Echo the PING frame
+                Seq = GetFrameSeq( );
+                memcpy1( Buffer, PongMsg, 4 );
+                DelayMs( 1 );
+                Radio.Send( Buffer, BufferSize );
+            }
+            else
+            {
+                Radio.Rx( idleTimeout );
+            }
+        }
+        break;
+    case TX:
+        if( Phase == PHASE_SYNC )
+        {
+            // The synchronization acknowledge has been sent
+            Phase = PHASE_TEST;
+            ApplyTestSetting( );
+            Radio.Rx( BENCHMARK_SLAVE_IDLE_RTT * ( 2 * TestTimeOnAir + BENCHMARK_RX_MARGIN ) );
+        }
+        else if( Seq >= ( BENCHMARK_PACKETS - 1 ) )
+        {
+            // Last PONG frame of the test
+            WaitSync( );
+        }
+        else
+        {
+            Radio.Rx( idleTimeout );
+        }
+        break;
+    case RX_ERROR:
+        if( Phase == PHASE_TEST )
+        {
+            Radio.Rx( idleTimeout );
+            break;
+        }
+        WaitSync( );
+        break;
+    case RX_TIMEOUT:
+    case TX_TIMEOUT:
+        WaitSync( );
+        break;
+    case LOWPOWER:
+    default:
+        break;
+    }
+}
+
+void PingPongBenchmarkInit( uint32_t frequency, int8_t power )
+{
+    TxPower = power;
+
+    // Radio initialization
+    RadioEvents.TxDone = OnBenchmarkTxDone;
+    RadioEvents.RxDone = OnBenchmarkRxDone;
+    RadioEvents.TxTimeout = OnBenchmarkTxTimeout;
+    RadioEvents.RxTimeout = OnBenchmarkRxTimeout;
+    RadioEvents.RxError = OnBenchmarkRxError;
+
+    Radio.Init( &RadioEvents );
+
+    Radio.SetChannel( frequency );
+
+    IsMaster = true;
+    TestIndex = 0;
+    Run = 0;
+    PrintHeader( );
+    SyncStartTime = TimerGetCurrentTime( );
+    SendSync( );
+}
+
+void PingPongBenchmarkProcess( void )
+{
+    States_t state;
+
+    CRITICAL_SECTION_BEGIN( );
+    state = State;
+    State = LOWPOWER;
+    CRITICAL_SECTION_END( );
+
+    if( IsMaster == true )
+    {
+        ProcessMaster( state );
+    }
+    else
+    {
+        ProcessSlave( state );
+    }
+}
+
+static void OnBenchmarkTxDone( void )
+{
+    Radio.Sleep( );
+    State = TX;
+}
+
+static void OnBenchmarkRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    RxTime = TimerGetCurrentTime( );
+    Radio.Sleep( );
+    BufferSize = size;
+    memcpy1( Buffer, payload, BufferSize );
+    State = RX;
+}
+
+static void OnBenchmarkTxTimeout( void )
+{
+    Radio.Sleep( );
+    State = TX_TIMEOUT;
+}
+
+static void OnBenchmarkRxTimeout( void )
+{
+    Radio.Sleep( );
+    State = RX_TIMEOUT;
+}
+
+static void OnBenchmarkRxError( void )
+{
+    Radio.Sleep( );
+    State = RX_ERROR;
+}
@@ -0,0 +1,76 @@
+/*!
+ * \file      PingPongBenchmark.h
+ *
+ * \brief     Ping-Pong throughput and latency benchmark
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  PINGPONGBENCHMARK Ping-Pong benchmark
+ *            Sweeps the payload sizes and the LoRa/FSK modem settings and
+ *            reports, for each combination, the round trip latency
+ *            distribution, the goodput and the packet error rate.
+ *
+ *            Both devices run the same firmware. The device which gets its
+ *            synchronization frame answered first becomes the master and the
+ *            other one the slave.
+ *            Before each test the master announces the test index on the
+ *            control setting (LoRa SF7 125 kHz). Both devices then switch to
+ *            the test setting, the master sends BENCHMARK_PACKETS PING frames
+ *            and the slave echoes each of them in a PONG frame.
+ *
+ *            The results are printed by the master on the board UART as CSV
+ *            lines:
+ *            "modem,bw,dr,size,toa,sent,received,per,rtt_min,rtt_med,rtt_p90,rtt_max,rtt_avg,goodput"
+ *            - bw       LoRa [0: 125 kHz, 1: 250 kHz, 2: 500 kHz], FSK [Hz]
+ *            - dr       LoRa spreading factor, FSK datarate [bps]
+ *            - toa      Frame time on air [ms]
+ *            - per      Round trip packet error rate [0.1 %]
+ *            - rtt_*    Round trip time statistics [ms]
+ *            - goodput  Echoed payload bits per second of test duration
+ * \{
+ */
+#ifndef __PING_PONG_BENCHMARK_H__
+#define __PING_PONG_BENCHMARK_H__
+
+#include <stdint.h>
+
+/*!
+ * Number of PING frames sent for each modem setting and payload size
+ */
+#ifndef BENCHMARK_PACKETS
+#define BENCHMARK_PACKETS                           20
+#endif
+
+/*!
+ * \brief Initializes the radio and starts the benchmark
+ *
+ * \remark Replaces the ping-pong radio initialization
+ *
+ * \param [IN] frequency RF frequency [Hz]
+ * \param [IN] power     Tx output power [dBm]
+ */
+void PingPongBenchmarkInit( uint32_t frequency, int8_t power );
+
+/*!
+ * \brief Processes the benchmark radio events
+ *
+ * \remark Must be called from the application main loop
+ */
+void PingPongBenchmarkProcess( void );
+
+/*! \} defgroup PINGPONGBENCHMARK */
+
+#endif // __PING_PONG_BENCHMARK_H__
@@ -31,6 +31,10 @@
 #include "timer.h"
 #include "radio.h"
 
+#if defined( RX_SENSI_PER )
+#include "RxSensiPer.h"
+#endif
+
 #if defined( REGION_AS923 )
 
 #define RF_FREQUENCY                                923000000 // Hz
@@ -119,6 +123,18 @@ int main( void )
     BoardInitMcu( );
     BoardInitPeriph( );
 
+#if defined( RX_SENSI_PER )
+    // Packet error rate sweep. Replaces the continuous reception.
+    RxSensiPerInit( RF_FREQUENCY );
+
+    while( 1 )
+    {
+        RxSensiPerProcess( );
+
+        BoardLowPowerHandler( );
+    }
+#endif
+
     // Radio initialization
     RadioEvents.RxDone = OnRxDone;
 
@@ -30,6 +30,10 @@
 #include "timer.h"
 #include "radio.h"
 
+#if defined( RX_SENSI_PER )
+#include "RxSensiPer.h"
+#endif
+
 #if defined( REGION_AS923 )
 
 #define RF_FREQUENCY                                923000000 // Hz
@@ -139,6 +143,23 @@ int main( void )
     BoardInitMcu( );
     BoardInitPeriph( );
 
+#if defined( RX_SENSI_PER )
+    // Packet error rate sweep. Replaces the continuous reception.
+    RxSensiPerInit( RF_FREQUENCY );
+
+    while( 1 )
+    {
+        RxSensiPerProcess( );
+
+        BoardLowPowerHandler( );
+        // Process Radio IRQ
+        if( Radio.IrqProcess != NULL )
+        {
+            Radio.IrqProcess( );
+        }
+    }
+#endif
+
     // Radio initialization
     RadioEvents.RxDone = OnRxDone;
 
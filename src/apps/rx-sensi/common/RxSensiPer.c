@@ -0,0 +1,556 @@
+/*!
+ * \file      RxSensiPer.c
+ *
+ * \brief     Packet error rate and sensitivity sweep
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "utilities.h"
+#include "delay.h"
+#include "timer.h"
+#include "radio.h"
+#include "RxSensiPer.h"
+
+#define LORA_PREAMBLE_LENGTH                        8         // Same for Tx and Rx
+
+/*!
+ * Control setting output power [dBm]
+ */
+#define RX_SENSI_PER_CONTROL_POWER                  14
+
+/*!
+ * Maximum time allowed to transmit a frame [ms]
+ */
+#define RX_SENSI_PER_TX_TIMEOUT                     5000
+
+/*!
+ * Number of announce frames sent before each step
+ */
+#define RX_SENSI_PER_ANNOUNCES                      3
+
+/*!
+ * Time given to the receiver to switch to the step setting [ms]
+ */
+#define RX_SENSI_PER_SWITCH_DELAY                   50
+
+/*!
+ * Time between two frames [ms]
+ */
+#define RX_SENSI_PER_TX_INTERVAL                    10
+
+/*!
+ * Time added to the step duration before the receiver ends a step [ms]
+ */
+#define RX_SENSI_PER_RX_MARGIN                      200
+
+/*!
+ * Frame header. Tag, step index and sequence number
+ */
+#define RX_SENSI_PER_HEADER_SIZE                    6
+
+#define RX_SENSI_PER_PAYLOAD_SIZE                   16
+
+/*!
+ * LoRa modem setting
+ */
+typedef struct RxSensiPerSetting_s
+{
+    /*!
+     * Bandwidth [0: 125 kHz, 1: 250 kHz, 2: 500 kHz]
+     */
+    uint32_t Bandwidth;
+    /*!
+     * Spreading factor [SF7..SF12]
+     */
+    uint32_t SpreadingFactor;
+    /*!
+     * Coding rate [1: 4/5, 2: 4/6, 3: 4/7, 4: 4/8]
+     */
+    uint8_t CodingRate;
+}RxSensiPerSetting_t;
+
+/*!
+ * Swept modem settings. The first one is the control setting.
+ */
+static const RxSensiPerSetting_t Settings[] =
+{
+    { 0,  7, 1 },
+    { 0,  8, 1 },
+    { 0,  9, 1 },
+    { 0, 10, 1 },
+    { 0, 11, 1 },
+    { 0, 12, 1 },
+    { 1,  7, 1 },
+    { 2,  7, 1 },
+    { 0,  9, 4 },
+};
+
+#define RX_SENSI_PER_SETTINGS_NB                    ( sizeof( Settings ) / sizeof( Settings[0] ) )
+
+/*!
+ * Swept transmitter output powers [dBm]. From the highest to the lowest.
+ */
+static const int8_t Powers[] = { 14, 10, 6, 2 };
+
+#define RX_SENSI_PER_POWERS_NB                      ( sizeof( Powers ) / sizeof( Powers[0] ) )
+
+#define RX_SENSI_PER_STEPS_NB                       ( RX_SENSI_PER_SETTINGS_NB * RX_SENSI_PER_POWERS_NB )
+
+/*!
+ * Frame tags
+ */
+static const uint8_t AnnounceMsg[] = "STP";
+static const uint8_t PerMsg[] = "PER";
+
+/*!
+ * Radio events function pointer
+ */
+static RadioEvents_t RadioEvents;
+
+static uint8_t Buffer[RX_SENSI_PER_PAYLOAD_SIZE];
+
+/*!
+ * Current step index. Setting index * RX_SENSI_PER_POWERS_NB + power index
+ */
+static uint8_t Step = 0;
+
+/*!
+ * Current step duration [ms]
+ */
+static uint32_t StepDuration = 0;
+
+#if defined( RX_SENSI_PER_TRANSMITTER )
+
+/*!
+ * Transmitter phases
+ */
+typedef enum
+{
+    PHASE_ANNOUNCE,
+    PHASE_FRAMES,
+}Phases_t;
+
+static Phases_t Phase = PHASE_ANNOUNCE;
+
+/*!
+ * Number of announce frames sent for the current step
+ */
+static uint8_t Announces = 0;
+
+/*!
+ * Current frame sequence number
+ */
+static uint16_t Seq = 0;
+
+/*!
+ * Set on Radio Tx Done and Tx Timeout events
+ */
+static volatile bool TxDone = false;
+
+#else
+
+/*!
+ * Receiver phases
+ */
+typedef enum
+{
+    PHASE_WAIT_STEP,
+    PHASE_STEP,
+}Phases_t;
+
+static volatile Phases_t Phase = PHASE_WAIT_STEP;
+
+/*!
+ * Step announced by the transmitter
+ */
+static volatile uint8_t AnnouncedStep = 0;
+
+static volatile bool StepStart = false;
+static volatile bool StepDone = false;
+
+/*!
+ * Timer ending the current step when its last frames are missed
+ */
+static TimerEvent_t StepTimer;
+
+/*!
+ * Step announce duration [ms]
+ */
+static uint32_t AnnounceDuration = 0;
+
+/*!
+ * Current step statistics
+ */
+static volatile uint16_t Received = 0;
+static volatile uint16_t CrcErrors = 0;
+static volatile int32_t LastSeq = -1;
+static volatile int32_t RssiSum = 0;
+static volatile int32_t SnrSum = 0;
+
+/*!
+ * Current setting sensitivity. Lowest output power index for which the packet
+ * error rate is below RX_SENSI_PER_THRESHOLD and its average RSSI.
+ */
+static int16_t SensitivitySetting = -1;
+static int16_t SensitivityPowerIndex = -1;
+static int16_t SensitivityRssi = 0;
+
+#endif
+
+/*!
+ * \brief Configures the radio with the given step setting
+ *
+ * \param [IN] setting Modem setting
+ * \param [IN] power   Output power [dBm]
+ */
+static void ApplySetting( const RxSensiPerSetting_t *setting, int8_t power )
+{
+    Radio.Standby( );
+
+    Radio.SetTxConfig( MODEM_LORA, power, 0, setting->Bandwidth,
+                                   setting->SpreadingFactor, setting->CodingRate,
+                                   LORA_PREAMBLE_LENGTH, false,
+                                   true, 0, 0, false, RX_SENSI_PER_TX_TIMEOUT );
+
+    Radio.SetRxConfig( MODEM_LORA, setting->Bandwidth, setting->SpreadingFactor,
+                                   setting->CodingRate, 0, LORA_PREAMBLE_LENGTH,
+                                   0, false,
+                                   0, true, 0, 0, false, true );
+}
+
+/*!
+ * \brief Configures the radio with the current step setting and computes the
+ *        step duration
+ */
+static void ApplyStepSetting( void )
+{
+    ApplySetting( &Settings[Step / RX_SENSI_PER_POWERS_NB], Powers[Step % RX_SENSI_PER_POWERS_NB] );
+    StepDuration = ( Radio.TimeOnAir( MODEM_LORA, RX_SENSI_PER_PAYLOAD_SIZE ) + RX_SENSI_PER_TX_INTERVAL ) *
+                   RX_SENSI_PER_PACKETS;
+}
+
+#if defined( RX_SENSI_PER_TRANSMITTER )
+
+/*!
+ * \brief Function to be executed on Radio Tx Done event
+ */
+static void OnPerTxDone( void )
+{
+    TxDone = true;
+}
+
+/*!
+ * \brief Function executed on Radio Tx Timeout event
+ */
+static void OnPerTxTimeout( void )
+{
+    TxDone = true;
+}
+
+/*!
+ * \brief Sends the current step announce frame on the control setting
+ */
+static void SendAnnounce( void )
+{
+    memcpy1( Buffer, AnnounceMsg, 3 );
+    Buffer[3] = Step;
+    Radio.Send( Buffer, RX_SENSI_PER_HEADER_SIZE );
+}
+
+/*!
+ * \brief Sends the current step frame
+ */
+static void SendFrame( void )
+{
+    memcpy1( Buffer, PerMsg, 3 );
+    Buffer[3] = Step;
+    Buffer[4] = Seq & 0xFF;
+    Buffer[5] = ( Seq >> 8 ) & 0xFF;
+    // We fill the buffer with numbers for the payload
+    for( uint8_t i = RX_SENSI_PER_HEADER_SIZE; i < RX_SENSI_PER_PAYLOAD_SIZE; i++ )
+    {
+        Buffer[i] = i - RX_SENSI_PER_HEADER_SIZE;
+    }
+    Radio.Send( Buffer, RX_SENSI_PER_PAYLOAD_SIZE );
+}
+
+/*!
+ * \brief Starts the current step announce
+ */
+static void StartStep( void )
+{
+    const RxSensiPerSetting_t *setting = &Settings[Step / RX_SENSI_PER_POWERS_NB];
+
+    printf( "Step %u: SF%lu bw %lu cr %u power %d dBm\r\n", Step, setting->SpreadingFactor,
+            setting->Bandwidth, setting->CodingRate, Powers[Step % RX_SENSI_PER_POWERS_NB] );
+
+    Phase = PHASE_ANNOUNCE;
+    Announces = 1;
+    ApplySetting( &Settings[0], RX_SENSI_PER_CONTROL_POWER );
+    SendAnnounce( );
+}
+
+void RxSensiPerInit( uint32_t frequency )
+{
+    // Radio initialization
+    RadioEvents.TxDone = OnPerTxDone;
+    RadioEvents.TxTimeout = OnPerTxTimeout;
+
+    Radio.Init( &RadioEvents );
+
+    Radio.SetChannel( frequency );
+
+    printf( "\r\n###### ===== Packet error rate sweep transmitter ==== ######\r\n" );
+    Step = 0;
+    StartStep( );
+}
+
+void RxSensiPerProcess( void )
+{
+    if( TxDone == false )
+    {
+        return;
+    }
+    TxDone = false;
+
+    if( Phase == PHASE_ANNOUNCE )
+    {
+        if( Announces < RX_SENSI_PER_ANNOUNCES )
+        {
+            Announces++;
+            DelayMs( RX_SENSI_PER_TX_INTERVAL );
+            SendAnnounce( );
+        }
+        else
+        {
+            Phase = PHASE_FRAMES;
+            Seq = 0;
+            ApplyStepSetting( );
+            DelayMs( RX_SENSI_PER_SWITCH_DELAY );
+            SendFrame( );
+        }
+    }
+    else
+    {
+        Seq++;
+        if( Seq < RX_SENSI_PER_PACKETS )
+        {
+            DelayMs( RX_SENSI_PER_TX_INTERVAL );
+            SendFrame( );
+        }
+        else
+        {
+            // Let the receiver end the step when it missed the last frames
+            DelayMs( ( StepDuration / 8 ) + ( 2 * RX_SENSI_PER_RX_MARGIN ) );
+            Step = ( Step + 1 ) % RX_SENSI_PER_STEPS_NB;
+            StartStep( );
+        }
+    }
+}
+
+#else
+
+/*!
+ * \brief Function to be executed on Radio Rx Done event
+ */
+static void OnPerRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    if( size < RX_SENSI_PER_HEADER_SIZE )
+    {
+        return;
+    }
+
+    if( Phase == PHASE_STEP )
+    {
+        if( ( strncmp( ( const char* )payload, ( const char* )PerMsg, 3 ) == 0 ) && ( payload[3] == Step ) )
+        {
+            int32_t seq = ( int32_t )payload[4] | ( ( int32_t )payload[5] << 8 );
+
+            // Duplicated and out of sequence frames are ignored
+            if( ( seq > LastSeq ) && ( seq < RX_SENSI_PER_PACKETS ) )
+            {
+                LastSeq = seq;
+                Received++;
+                RssiSum += rssi;
+                SnrSum += snr;
+                if( seq == ( RX_SENSI_PER_PACKETS - 1 ) )
+                {
+                    StepDone = true;
+                }
+            }
+        }
+    }
+    else
+    {
+        if( ( strncmp( ( const char* )payload, ( const char* )AnnounceMsg, 3 ) == 0 ) &&
+            ( payload[3] < RX_SENSI_PER_STEPS_NB ) )
+        {
+            AnnouncedStep = payload[3];
+            StepStart = true;
+        }
+    }
+}
+
+/*!
+ * \brief Function executed on Radio Rx Error event
+ */
+static void OnPerRxError( void )
+{
+    if( Phase == PHASE_STEP )
+    {
+        CrcErrors++;
+    }
+}
+
+/*!
+ * \brief Function executed on step timer event
+ */
+static void OnStepTimerEvent( void* context )
+{
+    StepDone = true;
+}
+
+/*!
+ * \brief Goes back to the control setting and waits for the next step
+ *        announce
+ */
+static void WaitStep( void )
+{
+    Phase = PHASE_WAIT_STEP;
+    ApplySetting( &Settings[0], RX_SENSI_PER_CONTROL_POWER );
+    Radio.Rx( 0 ); // Continuous Rx
+}
+
+/*!
+ * \brief Prints the setting sensitivity, if any step of the setting has been
+ *        measured
+ */
+static void PrintSensitivity( void )
+{
+    const RxSensiPerSetting_t *setting;
+
+    if( SensitivitySetting < 0 )
+    {
+        return;
+    }
+    setting = &Settings[SensitivitySetting];
+    if( SensitivityPowerIndex < 0 )
+    {
+        printf( "sensitivity,%lu,%lu,%u,-,-\r\n", setting->SpreadingFactor, setting->Bandwidth, setting->CodingRate );
+    }
+    else
+    {
+        printf( "sensitivity,%lu,%lu,%u,%d,%d\r\n", setting->SpreadingFactor, setting->Bandwidth, setting->CodingRate,
+                Powers[SensitivityPowerIndex], SensitivityRssi );
+    }
+    SensitivitySetting = -1;
+}
+
+/*!
+ * \brief Prints the current step results and updates the setting sensitivity
+ */
+static void PrintStepResults( void )
+{
+    const RxSensiPerSetting_t *setting = &Settings[Step / RX_SENSI_PER_POWERS_NB];
+    uint8_t powerIndex = Step % RX_SENSI_PER_POWERS_NB;
+    uint16_t received = Received;
+    uint16_t missed = RX_SENSI_PER_PACKETS - received;
+    uint32_t per = ( ( uint32_t )missed * 1000 ) / RX_SENSI_PER_PACKETS;
+
+    printf( "%lu,%lu,%u,%d,%u,%u,%u,%u,%lu,", setting->SpreadingFactor, setting->Bandwidth, setting->CodingRate,
+            Powers[powerIndex], RX_SENSI_PER_PACKETS, received, CrcErrors, missed, per );
+    if( received > 0 )
+    {
+        printf( "%ld,%ld\r\n", RssiSum / received, SnrSum / received );
+    }
+    else
+    {
+        printf( "-,-\r\n" );
+    }
+
+    if( SensitivitySetting != ( Step / RX_SENSI_PER_POWERS_NB ) )
+    {
+        PrintSensitivity( );
+        SensitivitySetting = Step / RX_SENSI_PER_POWERS_NB;
+        SensitivityPowerIndex = -1;
+    }
+    if( ( received > 0 ) && ( per < RX_SENSI_PER_THRESHOLD ) )
+    {
+        // Output powers are swept from the highest to the lowest
+        SensitivityPowerIndex = powerIndex;
+        SensitivityRssi = RssiSum / received;
+    }
+    if( powerIndex == ( RX_SENSI_PER_POWERS_NB - 1 ) )
+    {
+        PrintSensitivity( );
+    }
+}
+
+void RxSensiPerInit( uint32_t frequency )
+{
+    // Radio initialization
+    RadioEvents.RxDone = OnPerRxDone;
+    RadioEvents.RxError = OnPerRxError;
+
+    Radio.Init( &RadioEvents );
+
+    Radio.SetChannel( frequency );
+
+    TimerInit( &StepTimer, OnStepTimerEvent );
+
+    printf( "\r\n###### ===== Packet error rate sweep receiver ===== ######\r\n" );
+    printf( "sf,bw,cr,power,sent,received,crc_errors,missed,per,rssi,snr\r\n" );
+    WaitStep( );
+    AnnounceDuration = ( Radio.TimeOnAir( MODEM_LORA, RX_SENSI_PER_HEADER_SIZE ) + RX_SENSI_PER_TX_INTERVAL ) *
+                       RX_SENSI_PER_ANNOUNCES;
+}
+
+void RxSensiPerProcess( void )
+{
+    if( StepStart == true )
+    {
+        StepStart = false;
+
+        Step = AnnouncedStep;
+        Received = 0;
+        CrcErrors = 0;
+        LastSeq = -1;
+        RssiSum = 0;
+        SnrSum = 0;
+        StepDone = false;
+
+        ApplyStepSetting( );
+        // The step starts with the remaining announce frames
+        TimerSetValue( &StepTimer, AnnounceDuration + RX_SENSI_PER_SWITCH_DELAY + StepDuration +
+                                   ( StepDuration / 10 ) + RX_SENSI_PER_RX_MARGIN );
+        TimerStart( &StepTimer );
+        Phase = PHASE_STEP;
+        Radio.Rx( 0 ); // Continuous Rx
+    }
+    if( StepDone == true )
+    {
+        StepDone = false;
+
+        TimerStop( &StepTimer );
+        PrintStepResults( );
+        WaitStep( );
+    }
+}
+
+#endif
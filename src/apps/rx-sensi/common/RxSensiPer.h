@@ -0,0 +1,84 @@
+/*!
+ * \file      RxSensiPer.h
+ *
+ * \brief     Packet error rate and sensitivity sweep
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  RXSENSIPER Packet error rate sweep
+ *            Steps through the LoRa spreading factor, bandwidth, coding rate
+ *            and transmitter output power settings and measures the packet
+ *            error rate of each step.
+ *
+ *            The transmitter (RX_SENSI_PER_TRANSMITTER defined) announces each
+ *            step on the control setting (LoRa SF7 125 kHz, maximum output
+ *            power) and then sends RX_SENSI_PER_PACKETS frames holding the
+ *            step index and a sequence number.
+ *            The receiver counts the received, CRC error and missed frames
+ *            and prints on the board UART a CSV line per step:
+ *            "sf,bw,cr,power,sent,received,crc_errors,missed,per,rssi,snr"
+ *            - bw       [0: 125 kHz, 1: 250 kHz, 2: 500 kHz]
+ *            - cr       [1: 4/5, 2: 4/6, 3: 4/7, 4: 4/8]
+ *            - power    Transmitter output power [dBm]
+ *            - per      Packet error rate [0.1 %]
+ *            - rssi     Average RSSI of the received frames [dBm]
+ *            - snr      Average SNR of the received frames [dB]
+ *
+ *            Once all the output powers of a setting have been measured the
+ *            receiver prints the sensitivity line:
+ *            "sensitivity,sf,bw,cr,power,rssi"
+ *            giving the lowest output power, and its average RSSI, for which
+ *            the packet error rate is below RX_SENSI_PER_THRESHOLD.
+ * \{
+ */
+#ifndef __RX_SENSI_PER_H__
+#define __RX_SENSI_PER_H__
+
+#include <stdint.h>
+
+/*!
+ * Number of frames sent at each step
+ */
+#ifndef RX_SENSI_PER_PACKETS
+#define RX_SENSI_PER_PACKETS                        50
+#endif
+
+/*!
+ * Packet error rate under which a step is considered successful [0.1 %]
+ */
+#ifndef RX_SENSI_PER_THRESHOLD
+#define RX_SENSI_PER_THRESHOLD                      100
+#endif
+
+/*!
+ * \brief Initializes the radio and starts the sweep
+ *
+ * \remark Replaces the rx-sensi radio initialization
+ *
+ * \param [IN] frequency RF frequency [Hz]
+ */
+void RxSensiPerInit( uint32_t frequency );
+
+/*!
+ * \brief Processes the sweep events
+ *
+ * \remark Must be called from the application main loop
+ */
+void RxSensiPerProcess( void );
+
+/*! \} defgroup RXSENSIPER */
+
+#endif // __RX_SENSI_PER_H__
@@ -132,6 +132,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackWatermarkInit( );
+
         HAL_Init( );
 
         // LEDs
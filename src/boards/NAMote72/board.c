@@ -183,6 +183,8 @@ void BoardInitMcu( void )
 
     if( McuInitialized == false )
     {
+        StackWatermarkInit( );
+
         HAL_Init( );
 
         SystemClockConfig( );
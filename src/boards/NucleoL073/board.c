@@ -137,6 +137,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackWatermarkInit( );
+
         HAL_Init( );
 
         // LEDs
@@ -410,6 +412,9 @@ void LpmExitStopMode( void )
     // Initilizes the peripherals
     BoardInitMcu( );
 
+    // Refines the wake up time estimate, the RTC interrupt is still pending
+    RtcSetMcuWakeUpTime( );
+
     CRITICAL_SECTION_END( );
 }
 
@@ -23,13 +23,68 @@
  * \author    MCD Application Team (C)( STMicroelectronics International )
  */
 #include <stdint.h>
+#include <stdbool.h>
 #include "stm32l0xx.h"
 #include "utilities.h"
+#include "rtc-board.h"
 #include "lpm-board.h"
+#include "lpm-governor-board.h"
+
+/*!
+ * Wake up time estimate averaging weight, 1 / 2^LPM_WAKE_UP_TIME_AVG_SHIFT
+ */
+#define LPM_WAKE_UP_TIME_AVG_SHIFT                  2
 
 static uint32_t StopModeDisable = 0;
 static uint32_t OffModeDisable = 0;
 
+/*!
+ * Deepest mode allowed until the programmed wake up
+ */
+static LpmGetMode_t AlarmMode = LPM_OFF_MODE;
+
+/*!
+ * Set once the wake up time of the mode has been measured
+ */
+static bool WakeUpTimeMeasured[LPM_OFF_MODE + 1] = { false };
+
+/*!
+ * Average of the measured wake up times [1/16 RTC ticks]
+ */
+static int32_t WakeUpTimeAvg[LPM_OFF_MODE + 1] = { 0 };
+
+/*!
+ * STM32L073 default costs at 32 MHz, LSE running
+ * - Sleep:   no transition
+ * - Stop:    clock tree and peripherals re-initialization on wake up,
+ *            wake up time measured at run time
+ * - Off:     standby, RAM is lost and the MCU reboots on wake up
+ */
+static LpmModeCost_t ModeCosts[LPM_OFF_MODE + 1] =
+{
+    { .Current = 1500, .WakeUpTime = 0,  .TransitionCharge = 0     }, // LPM_SLEEP_MODE
+    { .Current = 1,    .WakeUpTime = 0,  .TransitionCharge = 1000  }, // LPM_STOP_MODE
+    { .Current = 1,    .WakeUpTime = 11, .TransitionCharge = 50000 }, // LPM_OFF_MODE
+};
+
+/*!
+ * \brief Gets the deepest mode allowed by the users
+ *
+ * \retval mode Deepest allowed mode
+ */
+static LpmGetMode_t LpmGetAllowedMode( void )
+{
+    if( StopModeDisable != 0 )
+    {
+        return LPM_SLEEP_MODE;
+    }
+    if( OffModeDisable != 0 )
+    {
+        return LPM_STOP_MODE;
+    }
+    return LPM_OFF_MODE;
+}
+
 void LpmSetOffMode( LpmId_t id, LpmSetMode_t mode )
 {
     CRITICAL_SECTION_BEGIN( );
@@ -84,31 +139,34 @@ void LpmSetStopMode( LpmId_t id, LpmSetMode_t mode )
 
 void LpmEnterLowPower( void )
 {
-    if( StopModeDisable != 0 )
+    switch( LpmGetMode( ) )
     {
-        /*!
-        * SLEEP mode is required
-        */
-        LpmEnterSleepMode( );
-        LpmExitSleepMode( );
-    }
-    else
-    { 
-        if( OffModeDisable != 0 )
+        case LPM_SLEEP_MODE:
+        {
+            /*!
+            * SLEEP mode is required
+            */
+            LpmEnterSleepMode( );
+            LpmExitSleepMode( );
+            break;
+        }
+        case LPM_STOP_MODE:
         {
             /*!
             * STOP mode is required
             */
             LpmEnterStopMode( );
             LpmExitStopMode( );
+            break;
         }
-        else
+        default:
         {
             /*!
             * OFF mode is required
             */
             LpmEnterOffMode( );
             LpmExitOffMode( );
+            break;
         }
     }
     return;
@@ -120,19 +178,39 @@ LpmGetMode_t LpmGetMode(void)
 
     CRITICAL_SECTION_BEGIN( );
 
-    if( StopModeDisable != 0 )
-    {
-        mode = LPM_SLEEP_MODE;
-    }
-    else
+    // The alarm has been programmed for a wake up from AlarmMode at most
+    mode = MIN( LpmGetAllowedMode( ), AlarmMode );
+
+    CRITICAL_SECTION_END( );
+    return mode;
+}
+
+LpmGetMode_t LpmSelectMode( uint32_t timeout )
+{
+    LpmGetMode_t allowedMode;
+    LpmGetMode_t mode = LPM_SLEEP_MODE;
+    uint64_t duration = RtcTick2Ms( timeout );
+    uint64_t charge;
+    uint64_t minCharge;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    allowedMode = LpmGetAllowedMode( );
+    minCharge = ( ModeCosts[LPM_SLEEP_MODE].Current * duration ) + ModeCosts[LPM_SLEEP_MODE].TransitionCharge;
+
+    for( uint8_t i = LPM_STOP_MODE; i <= allowedMode; i++ )
     {
-        if( OffModeDisable != 0 )
+        // The MCU must be running again by the end of the idle period
+        if( ( ModeCosts[i].WakeUpTime + RtcGetMinimumTimeout( ) ) >= timeout )
         {
-            mode = LPM_STOP_MODE;
+            break;
         }
-        else
+        // [uA] * [ms] = [nC]
+        charge = ( ModeCosts[i].Current * duration ) + ModeCosts[i].TransitionCharge;
+        if( charge < minCharge )
         {
-            mode = LPM_OFF_MODE;
+            minCharge = charge;
+            mode = ( LpmGetMode_t )i;
         }
     }
 
@@ -140,6 +218,43 @@ LpmGetMode_t LpmGetMode(void)
     return mode;
 }
 
+void LpmSetAlarmMode( LpmGetMode_t mode )
+{
+    AlarmMode = mode;
+}
+
+void LpmSetModeCost( LpmGetMode_t mode, const LpmModeCost_t* cost )
+{
+    CRITICAL_SECTION_BEGIN( );
+    ModeCosts[mode] = *cost;
+    CRITICAL_SECTION_END( );
+}
+
+void LpmUpdateWakeUpTime( LpmGetMode_t mode, uint32_t wakeUpTime )
+{
+    int32_t measure = ( int32_t )MIN( wakeUpTime, UINT16_MAX ) << 4;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( WakeUpTimeMeasured[mode] == false )
+    {
+        WakeUpTimeMeasured[mode] = true;
+        WakeUpTimeAvg[mode] = measure;
+    }
+    else
+    {
+        WakeUpTimeAvg[mode] += ( measure - WakeUpTimeAvg[mode] ) / ( 1 << LPM_WAKE_UP_TIME_AVG_SHIFT );
+    }
+    ModeCosts[mode].WakeUpTime = ( uint32_t )( WakeUpTimeAvg[mode] + 8 ) >> 4;
+
+    CRITICAL_SECTION_END( );
+}
+
+uint32_t LpmGetWakeUpTime( LpmGetMode_t mode )
+{
+    return ModeCosts[mode].WakeUpTime;
+}
+
 __weak void LpmEnterSleepMode( void )
 {
 }
@@ -0,0 +1,108 @@
+/*!
+ * \file      lpm-governor-board.h
+ *
+ * \brief     NucleoL073 low power governor
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech - STMicroelectronics
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \author    Gregory Cristian ( Semtech )
+ *
+ * \author    MCD Application Team (C)( STMicroelectronics International )
+ */
+#ifndef __LPM_GOVERNOR_BOARD_H__
+#define __LPM_GOVERNOR_BOARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "lpm-board.h"
+
+/*!
+ * Low power mode costs used by the low power governor
+ */
+typedef struct sLpmModeCost
+{
+    /*!
+     * Average current drawn while in the mode [uA]
+     */
+    uint32_t Current;
+    /*!
+     * Time from the wake up event to the application code execution [RTC ticks]
+     */
+    uint32_t WakeUpTime;
+    /*!
+     * Charge drawn to enter and exit the mode [nC]
+     */
+    uint32_t TransitionCharge;
+} LpmModeCost_t;
+
+/*!
+ * \brief  Low power governor. Selects the mode drawing the least charge over an idle period, among the modes allowed
+ *         by LpmSetStopMode and LpmSetOffMode, taking into account the current, wake up time and transition charge
+ *         of each mode.
+ *         A mode is only eligible when its wake up time fits in the idle period.
+ *
+ * \param [IN] timeout Idle period duration until the next programmed wake up [RTC ticks]
+ *
+ * \retval mode Mode to be used for the idle period
+ */
+LpmGetMode_t LpmSelectMode( uint32_t timeout );
+
+/*!
+ * \brief  Sets the deepest mode allowed until the next programmed wake up.
+ *         To be called by the RTC driver once the alarm has been programmed early by the wake up time of the mode
+ *         selected by LpmSelectMode, so that the MCU is running when the alarm deadline is reached.
+ *         LPM_OFF_MODE removes the restriction (no wake up programmed)
+ *
+ * \param [IN] mode Deepest allowed mode
+ */
+void LpmSetAlarmMode( LpmGetMode_t mode );
+
+/*!
+ * \brief  Sets the costs of a low power mode.
+ *         The board provides default costs, which may be refined from current measurements
+ *
+ * \param [IN] mode Low power mode
+ * \param [IN] cost Costs of the mode
+ */
+void LpmSetModeCost( LpmGetMode_t mode, const LpmModeCost_t* cost );
+
+/*!
+ * \brief  Updates the wake up time estimate of a low power mode from a measurement.
+ *         The first measurement replaces the default value, the following ones are averaged so that the estimate
+ *         tracks the temperature and supply voltage drifts
+ *
+ * \param [IN] mode       Low power mode
+ * \param [IN] wakeUpTime Measured wake up time [RTC ticks]
+ */
+void LpmUpdateWakeUpTime( LpmGetMode_t mode, uint32_t wakeUpTime );
+
+/*!
+ * \brief  Gets the wake up time estimate of a low power mode
+ *
+ * \param [IN] mode Low power mode
+ *
+ * \retval wakeUpTime Wake up time [RTC ticks]
+ */
+uint32_t LpmGetWakeUpTime( LpmGetMode_t mode );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__LPM_GOVERNOR_BOARD_H__ */
@@ -32,6 +32,7 @@
 #include "systime.h"
 #include "gpio.h"
 #include "lpm-board.h"
+#include "lpm-governor-board.h"
 #include "rtc-board.h"
 
 // MCU Wake Up Time
@@ -80,13 +81,14 @@
 #define DIVC( X, N )                                ( ( ( X ) + ( N ) -1 ) / ( N ) )
 
 /*!
- * RTC timer context 
+ * RTC timer context
  */
 typedef struct
 {
-    uint32_t        Time;         // Reference time
-    RTC_TimeTypeDef CalendarTime; // Reference time in calendar format
-    RTC_DateTypeDef CalendarDate; // Reference date in calendar format
+    uint32_t Time;                // Reference time
+    uint64_t Counter;             // Reference time, not truncated
+    uint32_t Days;                // Number of days elapsed since 01/01/2000 at the reference time
+    uint32_t Date;                // Calendar date register at the reference time
 }RtcTimerContext_t;
 
 /*!
@@ -94,16 +96,6 @@ typedef struct
  */
 static bool RtcInitialized = false;
 
-/*!
- * \brief Indicates if the RTC Wake Up Time is calibrated or not
- */
-static bool McuWakeUpTimeInitialized = false;
-
-/*!
- * \brief Compensates MCU wakeup time
- */
-static int16_t McuWakeUpTimeCal = 0;
-
 /*!
  * Number of days in each month on a normal year
  */
@@ -147,13 +139,38 @@ static RTC_AlarmTypeDef RtcAlarm;
 static RtcTimerContext_t RtcTimerContext;
 
 /*!
- * \brief Get the current time from calendar in ticks
+ * Calendar date register value for which RtcCounterDays has been computed
+ */
+static uint32_t RtcCounterDate = UINT32_MAX;
+
+/*!
+ * Number of days elapsed since 01/01/2000 at RtcCounterDate
+ */
+static uint32_t RtcCounterDays = 0;
+
+/*!
+ * RTC counter value at which the alarm has been set
+ */
+static uint64_t RtcAlarmCounter = 0;
+
+/*!
+ * \brief Gets the RTC free running counter
+ *
+ * \remark The time of day is read from the calendar registers and converted
+ *         from BCD. The date is only converted once a day, when it changes.
  *
- * \param [IN] date           Pointer to RTC_DateStruct
- * \param [IN] time           Pointer to RTC_TimeStruct
- * \retval calendarValue Time in ticks
+ * \param [OUT] date Calendar date register value, may be NULL
+ * \retval counter Number of ticks elapsed since 01/01/2000
  */
-static uint64_t RtcGetCalendarValue( RTC_DateTypeDef* date, RTC_TimeTypeDef* time );
+static uint64_t RtcGetCounter( uint32_t* date );
+
+/*!
+ * \brief Gets the number of days elapsed since 01/01/2000
+ *
+ * \param [IN] date Calendar date register value
+ * \retval days Number of days
+ */
+static uint32_t RtcGetCalendarDays( uint32_t date );
 
 void RtcInit( void )
 {
@@ -211,7 +228,9 @@ void RtcInit( void )
  */
 uint32_t RtcSetTimerContext( void )
 {
-    RtcTimerContext.Time = ( uint32_t )RtcGetCalendarValue( &RtcTimerContext.CalendarDate, &RtcTimerContext.CalendarTime );
+    RtcTimerContext.Counter = RtcGetCounter( &RtcTimerContext.Date );
+    RtcTimerContext.Days = ( uint32_t )( RtcTimerContext.Counter >> N_PREDIV_S ) / SECONDS_IN_1DAY;
+    RtcTimerContext.Time = ( uint32_t )RtcTimerContext.Counter;
     return ( uint32_t )RtcTimerContext.Time;
 }
 
@@ -289,23 +308,18 @@ void RtcDelayMs( uint32_t delay )
  */
 void RtcSetAlarm( uint32_t timeout )
 {
-    // We don't go in Low Power mode for timeout below MIN_ALARM_DELAY
-    if( ( int64_t )( MIN_ALARM_DELAY + McuWakeUpTimeCal ) < ( int64_t )( timeout - RtcGetTimerElapsedTime( ) ) )
-    {
-        LpmSetStopMode( LPM_RTC_ID, LPM_ENABLE );
-    }
-    else
-    {
-        LpmSetStopMode( LPM_RTC_ID, LPM_DISABLE );
-    }
+    uint32_t elapsedTime = RtcGetTimerElapsedTime( );
+    LpmGetMode_t mode;
 
-    // In case stop mode is required
-    if( LpmGetMode( ) == LPM_STOP_MODE )
-    {
-        timeout = timeout - McuWakeUpTimeCal;
-    }
+    // Low power mode drawing the least charge until the alarm. Modes which
+    // can't wake up in time are not selected
+    mode = LpmSelectMode( ( timeout > elapsedTime ) ? ( timeout - elapsedTime ) : 0 );
+
+    // Wake up early so that the MCU is running at the alarm deadline
+    timeout = timeout - LpmGetWakeUpTime( mode );
 
     RtcStartAlarm( timeout );
+    LpmSetAlarmMode( mode );
 }
 
 void RtcStopAlarm( void )
@@ -318,215 +332,154 @@ void RtcStopAlarm( void )
 
     // Clear the EXTI's line Flag for RTC Alarm
     __HAL_RTC_ALARM_EXTI_CLEAR_FLAG( );
+
+    // No wake up programmed
+    LpmSetAlarmMode( LPM_OFF_MODE );
 }
 
 void RtcStartAlarm( uint32_t timeout )
 {
-    uint16_t rtcAlarmSubSeconds = 0;
-    uint16_t rtcAlarmSeconds = 0;
-    uint16_t rtcAlarmMinutes = 0;
-    uint16_t rtcAlarmHours = 0;
-    uint16_t rtcAlarmDays = 0;
-    RTC_TimeTypeDef time = RtcTimerContext.CalendarTime;
-    RTC_DateTypeDef date = RtcTimerContext.CalendarDate;
+    uint64_t alarmCounter = RtcTimerContext.Counter + timeout;
+    uint32_t seconds = ( uint32_t )( alarmCounter >> N_PREDIV_S );
+    uint32_t days = seconds / SECONDS_IN_1DAY;
+    uint32_t timeOfDay = seconds - ( days * SECONDS_IN_1DAY );
+    uint32_t year = RTC_Bcd2ToByte( ( RtcTimerContext.Date & ( RTC_DR_YT | RTC_DR_YU ) ) >> RTC_DR_YU_Pos );
+    uint32_t month = RTC_Bcd2ToByte( ( RtcTimerContext.Date & ( RTC_DR_MT | RTC_DR_MU ) ) >> RTC_DR_MU_Pos );
+    uint32_t daysInMonth = ( ( year % 4 ) == 0 ) ? DaysInMonthLeapYear[month - 1] : DaysInMonth[month - 1];
+    uint32_t rtcAlarmDays = RTC_Bcd2ToByte( ( RtcTimerContext.Date & ( RTC_DR_DT | RTC_DR_DU ) ) >> RTC_DR_DU_Pos );
+    uint32_t rtcAlarmHours;
+    uint32_t rtcAlarmMinutes;
 
     RtcStopAlarm( );
 
-    /*reverse counter */
-    rtcAlarmSubSeconds =  PREDIV_S - time.SubSeconds;
-    rtcAlarmSubSeconds += ( timeout & PREDIV_S );
-    // convert timeout  to seconds
-    timeout >>= N_PREDIV_S;
-
-    // Convert microsecs to RTC format and add to 'Now'
-    rtcAlarmDays =  date.Date;
-    while( timeout >= TM_SECONDS_IN_1DAY )
-    {
-        timeout -= TM_SECONDS_IN_1DAY;
-        rtcAlarmDays++;
-    }
-
-    // Calc hours
-    rtcAlarmHours = time.Hours;
-    while( timeout >= TM_SECONDS_IN_1HOUR )
-    {
-        timeout -= TM_SECONDS_IN_1HOUR;
-        rtcAlarmHours++;
-    }
-
-    // Calc minutes
-    rtcAlarmMinutes = time.Minutes;
-    while( timeout >= TM_SECONDS_IN_1MINUTE )
-    {
-        timeout -= TM_SECONDS_IN_1MINUTE;
-        rtcAlarmMinutes++;
-    }
-
-    // Calc seconds
-    rtcAlarmSeconds =  time.Seconds + timeout;
-
-    //***** Correct for modulo********
-    while( rtcAlarmSubSeconds >= ( PREDIV_S + 1 ) )
-    {
-        rtcAlarmSubSeconds -= ( PREDIV_S + 1 );
-        rtcAlarmSeconds++;
-    }
-
-    while( rtcAlarmSeconds >= TM_SECONDS_IN_1MINUTE )
-    { 
-        rtcAlarmSeconds -= TM_SECONDS_IN_1MINUTE;
-        rtcAlarmMinutes++;
-    }
-
-    while( rtcAlarmMinutes >= TM_MINUTES_IN_1HOUR )
+    // Day of the month of the alarm
+    rtcAlarmDays += days - RtcTimerContext.Days;
+    while( rtcAlarmDays > daysInMonth )
     {
-        rtcAlarmMinutes -= TM_MINUTES_IN_1HOUR;
-        rtcAlarmHours++;
+        rtcAlarmDays -= daysInMonth;
     }
 
-    while( rtcAlarmHours >= TM_HOURS_IN_1DAY )
-    {
-        rtcAlarmHours -= TM_HOURS_IN_1DAY;
-        rtcAlarmDays++;
-    }
-
-    if( date.Year % 4 == 0 ) 
-    {
-        if( rtcAlarmDays > DaysInMonthLeapYear[date.Month - 1] )
-        {
-            rtcAlarmDays = rtcAlarmDays % DaysInMonthLeapYear[date.Month - 1];
-        }
-    }
-    else
-    {
-        if( rtcAlarmDays > DaysInMonth[date.Month - 1] )
-        {   
-            rtcAlarmDays = rtcAlarmDays % DaysInMonth[date.Month - 1];
-        }
-    }
+    rtcAlarmHours = timeOfDay / SECONDS_IN_1HOUR;
+    timeOfDay -= rtcAlarmHours * SECONDS_IN_1HOUR;
+    rtcAlarmMinutes = timeOfDay / SECONDS_IN_1MINUTE;
+    timeOfDay -= rtcAlarmMinutes * SECONDS_IN_1MINUTE;
 
     /* Set RTC_AlarmStructure with calculated values*/
-    RtcAlarm.AlarmTime.SubSeconds     = PREDIV_S - rtcAlarmSubSeconds;
-    RtcAlarm.AlarmSubSecondMask       = ALARM_SUBSECOND_MASK; 
-    RtcAlarm.AlarmTime.Seconds        = rtcAlarmSeconds;
+    RtcAlarm.AlarmTime.SubSeconds     = PREDIV_S - ( ( uint32_t )alarmCounter & PREDIV_S );
+    RtcAlarm.AlarmSubSecondMask       = ALARM_SUBSECOND_MASK;
+    RtcAlarm.AlarmTime.Seconds        = timeOfDay;
     RtcAlarm.AlarmTime.Minutes        = rtcAlarmMinutes;
     RtcAlarm.AlarmTime.Hours          = rtcAlarmHours;
     RtcAlarm.AlarmDateWeekDay         = ( uint8_t )rtcAlarmDays;
-    RtcAlarm.AlarmTime.TimeFormat     = time.TimeFormat;
-    RtcAlarm.AlarmDateWeekDaySel      = RTC_ALARMDATEWEEKDAYSEL_DATE; 
+    RtcAlarm.AlarmTime.TimeFormat     = RTC_HOURFORMAT12_AM;
+    RtcAlarm.AlarmDateWeekDaySel      = RTC_ALARMDATEWEEKDAYSEL_DATE;
     RtcAlarm.AlarmMask                = RTC_ALARMMASK_NONE;
     RtcAlarm.Alarm                    = RTC_ALARM_A;
     RtcAlarm.AlarmTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
     RtcAlarm.AlarmTime.StoreOperation = RTC_STOREOPERATION_RESET;
 
+    RtcAlarmCounter = alarmCounter;
+
     // Set RTC_Alarm
     HAL_RTC_SetAlarm_IT( &RtcHandle, &RtcAlarm, RTC_FORMAT_BIN );
 }
 
 uint32_t RtcGetTimerValue( void )
 {
-    RTC_TimeTypeDef time;
-    RTC_DateTypeDef date;
-
-    uint32_t calendarValue = ( uint32_t )RtcGetCalendarValue( &date, &time );
-
-    return( calendarValue );
+    return ( uint32_t )RtcGetCounter( NULL );
 }
 
 uint32_t RtcGetTimerElapsedTime( void )
 {
-  RTC_TimeTypeDef time;
-  RTC_DateTypeDef date;
-  
-  uint32_t calendarValue = ( uint32_t )RtcGetCalendarValue( &date, &time );
-
-  return( ( uint32_t )( calendarValue - RtcTimerContext.Time ) );
+    return ( uint32_t )( RtcGetCounter( NULL ) - RtcTimerContext.Counter );
 }
 
 void RtcSetMcuWakeUpTime( void )
 {
-    RTC_TimeTypeDef time;
-    RTC_DateTypeDef date;
-
-    uint32_t now, hit;
-    int16_t mcuWakeUpTime;
+    uint64_t now;
 
-    if( ( McuWakeUpTimeInitialized == false ) &&
-       ( HAL_NVIC_GetPendingIRQ( RTC_IRQn ) == 1 ) )
+    // Only a wake up by the alarm gives the wake up time
+    if( HAL_NVIC_GetPendingIRQ( RTC_IRQn ) == 1 )
     {
-        /* WARNING: Works ok if now is below 30 days
-         *          it is ok since it's done once at first alarm wake-up
-         */
-        McuWakeUpTimeInitialized = true;
-        now = ( uint32_t )RtcGetCalendarValue( &date, &time );
-
-        HAL_RTC_GetAlarm( &RtcHandle, &RtcAlarm, RTC_ALARM_A, RTC_FORMAT_BIN );
-        hit = RtcAlarm.AlarmTime.Seconds +
-              60 * ( RtcAlarm.AlarmTime.Minutes +
-              60 * ( RtcAlarm.AlarmTime.Hours +
-              24 * ( RtcAlarm.AlarmDateWeekDay ) ) );
-        hit = ( hit << N_PREDIV_S ) + ( PREDIV_S - RtcAlarm.AlarmTime.SubSeconds );
-
-        mcuWakeUpTime = ( int16_t )( ( now - hit ) );
-        McuWakeUpTimeCal += mcuWakeUpTime;
-        //PRINTF( 3, "Cal=%d, %d\n\r", McuWakeUpTimeCal, mcuWakeUpTime);
+        now = RtcGetCounter( NULL );
+
+        if( now >= RtcAlarmCounter )
+        {
+            LpmUpdateWakeUpTime( LPM_STOP_MODE, ( uint32_t )( now - RtcAlarmCounter ) );
+        }
     }
 }
 
 int16_t RtcGetMcuWakeUpTime( void )
 {
-    return McuWakeUpTimeCal;
+    return ( int16_t )LpmGetWakeUpTime( LPM_STOP_MODE );
 }
 
-static uint64_t RtcGetCalendarValue( RTC_DateTypeDef* date, RTC_TimeTypeDef* time )
+static uint64_t RtcGetCounter( uint32_t* date )
 {
-    uint64_t calendarValue = 0;
     uint32_t firstRead;
-    uint32_t correction;
+    uint32_t timeReg;
+    uint32_t dateReg;
+    uint32_t days;
     uint32_t seconds;
 
     // Make sure it is correct due to asynchronus nature of RTC
     do
     {
         firstRead = RTC->SSR;
-        HAL_RTC_GetDate( &RtcHandle, date, RTC_FORMAT_BIN );
-        HAL_RTC_GetTime( &RtcHandle, time, RTC_FORMAT_BIN );
+        timeReg = RTC->TR;
+        dateReg = RTC->DR;
     }while( firstRead != RTC->SSR );
 
-    // Calculte amount of elapsed days since 01/01/2000
-    seconds = DIVC( ( DAYS_IN_YEAR * 3 + DAYS_IN_LEAP_YEAR ) * date->Year , 4 );
+    CRITICAL_SECTION_BEGIN( );
+    if( dateReg != RtcCounterDate )
+    {
+        RtcCounterDays = RtcGetCalendarDays( dateReg );
+        RtcCounterDate = dateReg;
+    }
+    days = RtcCounterDays;
+    CRITICAL_SECTION_END( );
 
-    correction = ( ( date->Year % 4 ) == 0 ) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM;
+    if( date != NULL )
+    {
+        *date = dateReg;
+    }
+
+    seconds = ( ( ( ( timeReg & RTC_TR_HT ) >> RTC_TR_HT_Pos ) * 10 ) + ( ( timeReg & RTC_TR_HU ) >> RTC_TR_HU_Pos ) ) * SECONDS_IN_1HOUR;
+    seconds += ( ( ( ( timeReg & RTC_TR_MNT ) >> RTC_TR_MNT_Pos ) * 10 ) + ( ( timeReg & RTC_TR_MNU ) >> RTC_TR_MNU_Pos ) ) * SECONDS_IN_1MINUTE;
+    seconds += ( ( ( timeReg & RTC_TR_ST ) >> RTC_TR_ST_Pos ) * 10 ) + ( ( timeReg & RTC_TR_SU ) >> RTC_TR_SU_Pos );
+    seconds += days * SECONDS_IN_1DAY;
 
-    seconds += ( DIVC( ( date->Month-1 ) * ( 30 + 31 ), 2 ) - ( ( ( correction >> ( ( date->Month - 1 ) * 2 ) ) & 0x03 ) ) );
+    return ( ( ( uint64_t )seconds ) << N_PREDIV_S ) + ( PREDIV_S - firstRead );
+}
+
+static uint32_t RtcGetCalendarDays( uint32_t date )
+{
+    uint32_t year = RTC_Bcd2ToByte( ( date & ( RTC_DR_YT | RTC_DR_YU ) ) >> RTC_DR_YU_Pos );
+    uint32_t month = RTC_Bcd2ToByte( ( date & ( RTC_DR_MT | RTC_DR_MU ) ) >> RTC_DR_MU_Pos );
+    uint32_t day = RTC_Bcd2ToByte( ( date & ( RTC_DR_DT | RTC_DR_DU ) ) >> RTC_DR_DU_Pos );
+    uint32_t correction;
+    uint32_t days;
 
-    seconds += ( date->Date -1 );
+    // Calculte amount of elapsed days since 01/01/2000
+    days = DIVC( ( DAYS_IN_YEAR * 3 + DAYS_IN_LEAP_YEAR ) * year, 4 );
 
-    // Convert from days to seconds
-    seconds *= SECONDS_IN_1DAY;
+    correction = ( ( year % 4 ) == 0 ) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM;
 
-    seconds += ( ( uint32_t )time->Seconds + 
-                 ( ( uint32_t )time->Minutes * SECONDS_IN_1MINUTE ) +
-                 ( ( uint32_t )time->Hours * SECONDS_IN_1HOUR ) ) ;
+    days += ( DIVC( ( month - 1 ) * ( 30 + 31 ), 2 ) - ( ( ( correction >> ( ( month - 1 ) * 2 ) ) & 0x03 ) ) );
 
-    calendarValue = ( ( ( uint64_t )seconds ) << N_PREDIV_S ) + ( PREDIV_S - time->SubSeconds );
+    days += ( day - 1 );
 
-    return( calendarValue );
+    return days;
 }
 
 uint32_t RtcGetCalendarTime( uint16_t *milliseconds )
 {
-    RTC_TimeTypeDef time ;
-    RTC_DateTypeDef date;
-    uint32_t ticks;
-
-    uint64_t calendarValue = RtcGetCalendarValue( &date, &time );
-
-    uint32_t seconds = ( uint32_t )( calendarValue >> N_PREDIV_S );
+    uint64_t counter = RtcGetCounter( NULL );
 
-    ticks =  ( uint32_t )calendarValue & PREDIV_S;
+    uint32_t seconds = ( uint32_t )( counter >> N_PREDIV_S );
 
-    *milliseconds = RtcTick2Ms( ticks );
+    *milliseconds = RtcTick2Ms( ( uint32_t )counter & PREDIV_S );
 
     return seconds;
 }
@@ -540,6 +493,7 @@ void RTC_IRQHandler( void )
 
     // Enable low power at irq
     LpmSetStopMode( LPM_RTC_ID, LPM_ENABLE );
+    LpmSetAlarmMode( LPM_OFF_MODE );
 
     // Clear the EXTI's line Flag for RTC Alarm
     __HAL_RTC_ALARM_EXTI_CLEAR_FLAG( );
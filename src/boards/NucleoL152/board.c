@@ -137,6 +137,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackWatermarkInit( );
+
         HAL_Init( );
 
         // LEDs
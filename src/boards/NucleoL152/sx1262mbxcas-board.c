@@ -21,11 +21,14 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdlib.h>
+#include "stm32l1xx.h"
 #include "utilities.h"
 #include "board-config.h"
 #include "board.h"
 #include "delay.h"
 #include "radio.h"
+#include "lpm-board.h"
+#include "rtc-board.h"
 #include "sx126x-board.h"
 
 /*!
@@ -42,6 +45,26 @@ Gpio_t DbgPinTx;
 Gpio_t DbgPinRx;
 #endif
 
+/*!
+ * Time spent waiting on the Busy pin since the last statistics reset [RTC ticks]
+ */
+static uint32_t BusyWaitTicks = 0;
+
+/*!
+ * Number of Busy pin waits since the last statistics reset
+ */
+static uint32_t BusyWaitCount = 0;
+
+/*!
+ * \brief Busy pin falling edge IRQ handler
+ *
+ * \remark The handler is only used to wake up the MCU from sleep mode.
+ *         The Busy pin state is checked by SX126xWaitOnBusy
+ */
+static void SX126xOnBusyIrq( void* context )
+{
+}
+
 void SX126xIoInit( void )
 {
     GpioInit( &SX126x.Spi.Nss, RADIO_NSS, PIN_OUTPUT, PIN_PUSH_PULL, PIN_PULL_UP, 1 );
@@ -53,6 +76,7 @@ void SX126xIoInit( void )
 void SX126xIoIrqInit( DioIrqHandler dioIrq )
 {
     GpioSetInterrupt( &SX126x.DIO1, IRQ_RISING_EDGE, IRQ_HIGH_PRIORITY, dioIrq );
+    GpioSetInterrupt( &SX126x.BUSY, IRQ_FALLING_EDGE, IRQ_HIGH_PRIORITY, SX126xOnBusyIrq );
 }
 
 void SX126xIoDeInit( void )
@@ -91,7 +115,57 @@ void SX126xReset( void )
 
 void SX126xWaitOnBusy( void )
 {
-    while( GpioRead( &SX126x.BUSY ) == 1 );
+    uint32_t startTick;
+
+    if( GpioRead( &SX126x.BUSY ) == 0 )
+    {
+        return;
+    }
+
+    startTick = RtcGetTimerValue( );
+    if( __get_IPSR( ) != 0 )
+    {
+        // Called from an IRQ handler, e.g. the RTC one. The Busy pin IRQ has
+        // the same priority and can't wake up the MCU, poll the pin.
+        while( GpioRead( &SX126x.BUSY ) == 1 );
+    }
+    else
+    {
+        while( 1 )
+        {
+            CRITICAL_SECTION_BEGIN( );
+            if( GpioRead( &SX126x.BUSY ) == 0 )
+            {
+                CRITICAL_SECTION_END( );
+                break;
+            }
+            // The Busy pin falling edge IRQ wakes up the MCU even when interrupts
+            // are masked. Checking the pin with interrupts masked prevents missing
+            // an edge occurring just before entering sleep mode.
+            LpmEnterSleepMode( );
+            CRITICAL_SECTION_END( );
+        }
+    }
+    BusyWaitTicks += RtcGetTimerValue( ) - startTick;
+    BusyWaitCount++;
+}
+
+uint32_t SX126xGetBusyWaitTime( void )
+{
+    return RtcTick2Ms( BusyWaitTicks );
+}
+
+uint32_t SX126xGetBusyWaitCount( void )
+{
+    return BusyWaitCount;
+}
+
+void SX126xResetBusyWaitStats( void )
+{
+    CRITICAL_SECTION_BEGIN( );
+    BusyWaitTicks = 0;
+    BusyWaitCount = 0;
+    CRITICAL_SECTION_END( );
 }
 
 void SX126xWakeup( void )
@@ -126,10 +200,9 @@ void SX126xWriteCommand( RadioCommands_t command, uint8_t *buffer, uint16_t size
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
-    if( command != RADIO_SET_SLEEP )
-    {
-        SX126xWaitOnBusy( );
-    }
+    // The Busy pin is not waited for here. The radio executes the command
+    // while the MCU goes on and the next access waits for the radio to be
+    // ready (SX126xCheckDeviceReady)
 }
 
 uint8_t SX126xReadCommand( RadioCommands_t command, uint8_t *buffer, uint16_t size )
@@ -149,8 +222,6 @@ uint8_t SX126xReadCommand( RadioCommands_t command, uint8_t *buffer, uint16_t si
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
 
-    SX126xWaitOnBusy( );
-
     return status;
 }
 
@@ -170,8 +241,6 @@ void SX126xWriteRegisters( uint16_t address, uint8_t *buffer, uint16_t size )
     }
 
     GpioWrite( &SX126x.Spi.Nss, 1 );
-
-    SX126xWaitOnBusy( );
 }
 
 void SX126xWriteRegister( uint16_t address, uint8_t value )
@@ -194,8 +263,6 @@ void SX126xReadRegisters( uint16_t address, uint8_t *buffer, uint16_t size )
         buffer[i] = SpiInOut( &SX126x.Spi, 0 );
     }
     GpioWrite( &SX126x.Spi.Nss, 1 );
-
-    SX126xWaitOnBusy( );
 }
 
 uint8_t SX126xReadRegister( uint16_t address )
@@ -218,8 +285,6 @@ void SX126xWriteBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
         SpiInOut( &SX126x.Spi, buffer[i] );
     }
     GpioWrite( &SX126x.Spi.Nss, 1 );
-
-    SX126xWaitOnBusy( );
 }
 
 void SX126xReadBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
@@ -236,8 +301,6 @@ void SX126xReadBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
         buffer[i] = SpiInOut( &SX126x.Spi, 0 );
     }
     GpioWrite( &SX126x.Spi.Nss, 1 );
-
-    SX126xWaitOnBusy( );
 }
 
 void SX126xSetRfTxPower( int8_t power )
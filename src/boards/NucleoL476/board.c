@@ -142,6 +142,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackWatermarkInit( );
+
         HAL_Init( );
 
         InitFlashMemoryOperations( );
@@ -27,9 +27,113 @@
 #include "eeprom-board.h"
 #include "utilities.h"
 
+/*!
+ * Number of data bytes stored by each emulated EEPROM variable
+ */
+#define EEPROM_WORD_SIZE                            4
+
+/*!
+ * Emulated EEPROM size in bytes
+ */
+#define EEPROM_SIZE                                 ( NB_OF_VARIABLES * EEPROM_WORD_SIZE )
+
+/*!
+ * Number of 8 bits variables written by previous firmware versions at virtual
+ * addresses 1 to EEPROM_LEGACY_NB_OF_VARIABLES
+ */
+#define EEPROM_LEGACY_NB_OF_VARIABLES               2048
+
+/*!
+ * First virtual address. Keeps the variables apart from the 8 bits variables
+ * written by previous firmware versions.
+ */
+#define EEPROM_VIRTUAL_ADDRESS_BASE                 0x1000
+
 uint16_t EepromVirtualAddress[NB_OF_VARIABLES];
 __IO uint32_t ErasingOnGoing = 0;
 
+/*!
+ * RAM copy of the emulated EEPROM. The reads don't search the flash pages.
+ */
+static uint32_t EepromCache[NB_OF_VARIABLES];
+
+/*!
+ * Bit set for each variable found in flash or written
+ */
+static uint32_t EepromCacheValid[( NB_OF_VARIABLES + 31 ) / 32];
+
+/*!
+ * \brief Loads the RAM copy of the emulated EEPROM
+ */
+static void EepromMcuLoadCache( void )
+{
+    memset1( ( uint8_t* )EepromCacheValid, 0, sizeof( EepromCacheValid ) );
+
+    for( uint16_t i = 0; i < NB_OF_VARIABLES; i++ )
+    {
+        if( EE_ReadVariable32bits( EepromVirtualAddress[i], &EepromCache[i] ) == EE_OK )
+        {
+            EepromCacheValid[i / 32] |= 1UL << ( i % 32 );
+        }
+        else
+        {
+            EepromCache[i] = 0;
+        }
+    }
+}
+
+/*!
+ * \brief Moves the 8 bits variables written by previous firmware versions to
+ *        the words. Done once, when no word has been written yet.
+ *
+ * \remark All the legacy variables are read before any word is written as the
+ *         page transfers only keep the words.
+ */
+static void EepromMcuMigrateLegacyVariables( void )
+{
+    EE_Status eeStatus = EE_OK;
+    uint32_t pending[( NB_OF_VARIABLES + 31 ) / 32];
+    uint8_t data;
+
+    for( uint16_t i = 0; i < ( sizeof( EepromCacheValid ) / sizeof( EepromCacheValid[0] ) ); i++ )
+    {
+        if( EepromCacheValid[i] != 0 )
+        {
+            return;
+        }
+    }
+
+    memset1( ( uint8_t* )pending, 0, sizeof( pending ) );
+    for( uint16_t i = 0; i < EEPROM_LEGACY_NB_OF_VARIABLES; i++ )
+    {
+        if( EE_ReadVariable8bits( i + 1, &data ) == EE_OK )
+        {
+            ( ( uint8_t* )EepromCache )[i] = data;
+            pending[i / EEPROM_WORD_SIZE / 32] |= 1UL << ( ( i / EEPROM_WORD_SIZE ) % 32 );
+        }
+    }
+
+    for( uint16_t i = 0; i < NB_OF_VARIABLES; i++ )
+    {
+        if( ( pending[i / 32] & ( 1UL << ( i % 32 ) ) ) == 0 )
+        {
+            continue;
+        }
+        eeStatus = EE_WriteVariable32bits( EepromVirtualAddress[i], EepromCache[i] );
+        if( ( eeStatus & EE_STATUSMASK_CLEANUP ) == EE_STATUSMASK_CLEANUP )
+        {
+            ErasingOnGoing = 0;
+            eeStatus |= EE_CleanUp( );
+        }
+        if( ( eeStatus & EE_STATUSMASK_ERROR ) == EE_STATUSMASK_ERROR )
+        {
+            assert_param( FAIL );
+            return;
+        }
+        EepromCacheValid[i / 32] |= 1UL << ( i % 32 );
+    }
+}
+
 /*!
  * \brief Initializes the EEPROM emulation module.
  */
@@ -43,7 +147,7 @@ void EepromMcuInit( void )
     // Set user List of Virtual Address variables: 0x0000 and 0xFFFF values are prohibited
     for( uint16_t varValue = 0; varValue < NB_OF_VARIABLES; varValue++ )
     {
-        EepromVirtualAddress[varValue] = varValue + 1;
+        EepromVirtualAddress[varValue] = varValue + EEPROM_VIRTUAL_ADDRESS_BASE;
     }
 
     // Set EEPROM emulation firmware to erase all potentially incompletely erased
@@ -79,6 +183,9 @@ void EepromMcuInit( void )
         }
     }
 
+    EepromMcuLoadCache( );
+    EepromMcuMigrateLegacyVariables( );
+
     // Lock the Flash Program Erase controller
     HAL_FLASH_Lock( );
 }
@@ -97,13 +204,41 @@ uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 {
     uint8_t status = SUCCESS;
     EE_Status eeStatus = EE_OK;
-    
+    uint32_t word;
+    uint16_t offset;
+    uint16_t len;
+
+    if( ( ( uint32_t )addr + size ) > EEPROM_SIZE )
+    {
+        return FAIL;
+    }
+
     // Unlock the Flash Program Erase controller
     HAL_FLASH_Unlock( );
 
-    for( uint32_t i = 0; i < size; i++ )
+    // One flash record per 4 bytes word. The unchanged words are not written.
+    for( uint16_t i = addr / EEPROM_WORD_SIZE; size > 0; i++ )
     {
-        eeStatus |= EE_WriteVariable8bits( EepromVirtualAddress[addr + i], buffer[i] );
+        offset = addr % EEPROM_WORD_SIZE;
+        len = MIN( size, EEPROM_WORD_SIZE - offset );
+
+        word = EepromCache[i];
+        memcpy1( ( uint8_t* )&word + offset, buffer, len );
+
+        if( ( word != EepromCache[i] ) || ( ( EepromCacheValid[i / 32] & ( 1UL << ( i % 32 ) ) ) == 0 ) )
+        {
+            eeStatus |= EE_WriteVariable32bits( EepromVirtualAddress[i], word );
+            if( ( eeStatus & EE_STATUSMASK_ERROR ) != EE_OK )
+            {
+                break;
+            }
+            EepromCache[i] = word;
+            EepromCacheValid[i / 32] |= 1UL << ( i % 32 );
+        }
+
+        addr += len;
+        buffer += len;
+        size -= len;
     }
 
     if( eeStatus != EE_OK )
@@ -128,23 +263,20 @@ uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 
 uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 {
-    uint8_t status = SUCCESS;
-
-    // Unlock the Flash Program Erase controller
-    HAL_FLASH_Unlock( );
+    if( ( ( uint32_t )addr + size ) > EEPROM_SIZE )
+    {
+        return FAIL;
+    }
 
-    for( uint32_t i = 0; i < size; i++ )
+    for( uint16_t i = addr / EEPROM_WORD_SIZE; i < ( addr + size + EEPROM_WORD_SIZE - 1 ) / EEPROM_WORD_SIZE; i++ )
     {
-        if( EE_ReadVariable8bits( EepromVirtualAddress[addr + i], buffer + i ) != EE_OK )
+        if( ( EepromCacheValid[i / 32] & ( 1UL << ( i % 32 ) ) ) == 0 )
         {
-            status = FAIL;
-            break;
+            return FAIL;
         }
     }
-
-    // Lock the Flash Program Erase controller
-    HAL_FLASH_Lock( );
-    return status;
+    memcpy1( buffer, ( uint8_t* )EepromCache + addr, size );
+    return SUCCESS;
 }
 
 void EepromMcuSetDeviceAddr( uint8_t addr )
@@ -68,9 +68,10 @@
 
 /* Configuration of eeprom emulation in flash, can be custom */
 #define START_PAGE_ADDRESS      0x08080000U /*!< Start address of the 1st page in flash, for EEPROM emulation */
-#define CYCLES_NUMBER           1U   /*!< Number of 10Kcycles requested, minimum 1 for 10Kcycles (default),
+#define CYCLES_NUMBER           3U   /*!< Number of 10Kcycles requested, minimum 1 for 10Kcycles (default),
                                         for instance 10 to reach 100Kcycles. This factor will increase
-                                        pages number */
+                                        pages number. 3 keeps the 20 pages used with the previous 2048
+                                        8 bits variables, so their records can be migrated */
 #define GUARD_PAGES_NUMBER      2U   /*!< Number of guard pages avoiding frequent transfers (must be multiple of 2): 0,2,4.. */
 
 /* Configuration of crc calculation for eeprom emulation in flash */
@@ -94,7 +95,7 @@
 /** @defgroup Exported_Configuration_Constants Exported Configuration Constants
   * @{
   */
-#define NB_OF_VARIABLES         2048U  /*!< Number of variables to handle in eeprom */
+#define NB_OF_VARIABLES         512U   /*!< Number of variables to handle in eeprom, 32bits each */
 
 /**
   * @}
@@ -72,6 +72,8 @@ void BoardInitPeriph( void )
 
 void BoardInitMcu( void )
 {
+    StackWatermarkInit( );
+
     init_mcu( );
     delay_init( SysTick );
 
@@ -133,6 +133,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackWatermarkInit( );
+
         HAL_Init( );
 
         // LEDs
@@ -75,6 +75,53 @@ void memset1( uint8_t *dst, uint8_t value, uint16_t size )
     }
 }
 
+/*!
+ * Pattern used to fill the unused stack area
+ */
+#define STACK_WATERMARK_PATTERN                     0xA5A5A5A5
+
+/*!
+ * Area kept untouched below the current stack pointer when filling the
+ * unused stack area
+ */
+#define STACK_WATERMARK_MARGIN                      64
+
+/*!
+ * Linker script defined symbols.
+ * _ebss  - End of the statically allocated RAM
+ * _estack - Initial stack pointer value (Stack top)
+ */
+extern uint32_t _ebss;
+extern uint32_t _estack;
+
+void StackWatermarkInit( void )
+{
+    volatile uint32_t stackMarker = 0;
+    uint32_t *ptr = &_ebss;
+    uint32_t *end = ( uint32_t* )( ( uintptr_t )&stackMarker - STACK_WATERMARK_MARGIN );
+
+    while( ptr < end )
+    {
+        *ptr++ = STACK_WATERMARK_PATTERN;
+    }
+}
+
+uint32_t StackWatermarkGetMaxUsage( void )
+{
+    return ( uint32_t )( ( uintptr_t )&_estack - ( uintptr_t )&_ebss ) - StackWatermarkGetFree( );
+}
+
+uint32_t StackWatermarkGetFree( void )
+{
+    uint32_t *ptr = &_ebss;
+
+    while( ( ptr < &_estack ) && ( *ptr == STACK_WATERMARK_PATTERN ) )
+    {
+        ptr++;
+    }
+    return ( uint32_t )( ( uintptr_t )ptr - ( uintptr_t )&_ebss );
+}
+
 int8_t Nibble2HexChar( uint8_t a )
 {
     if( a < 10 )
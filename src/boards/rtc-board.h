@@ -88,6 +88,9 @@ void RtcDelayMs( TimerTime_t milliseconds );
  * \brief Calculates the wake up time between wake up and MCU start
  *
  * \note Resolution in RTC_ALARM_TIME_BASE
+ *
+ * \remark Boards featuring the low power governor refine the estimate on
+ *         each wake up from stop mode by the RTC alarm
  */
 void RtcSetMcuWakeUpTime( void );
 
@@ -146,6 +149,10 @@ uint32_t RtcGetCalendarTime( uint16_t *milliseconds );
 /*!
  * \brief Get the RTC timer value
  *
+ * \remark The RTC timer is a free running tick counter. It is read on every
+ *         TimerGetCurrentTime and TimerStart call and should be read in
+ *         constant time, without calendar conversions.
+ *
  * \retval RTC Timer value
  */
 uint32_t RtcGetTimerValue( void );
@@ -153,6 +160,8 @@ uint32_t RtcGetTimerValue( void );
 /*!
  * \brief Get the RTC timer elapsed time since the last Alarm was set
  *
+ * \remark Same execution time constraints as \ref RtcGetTimerValue
+ *
  * \retval RTC Elapsed time since the last alarm in ticks.
  */
 uint32_t RtcGetTimerElapsedTime( void );
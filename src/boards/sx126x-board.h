@@ -62,10 +62,37 @@ void SX126xIoDbgInit( void );
 void SX126xReset( void );
 
 /*!
- * \brief Blocking loop to wait while the Busy pin in high
+ * \brief Waits while the Busy pin is high
+ *
+ * \remark The MCU is put in sleep mode until the Busy pin falling edge
+ *         interrupt occurs
  */
 void SX126xWaitOnBusy( void );
 
+/*!
+ * \brief Gets the time spent waiting on the Busy pin since the last
+ *        statistics reset
+ *
+ * \remark Calling SX126xResetBusyWaitStats before each uplink gives the
+ *         radio interface overhead per uplink
+ *
+ * \retval time Busy wait time [ms]
+ */
+uint32_t SX126xGetBusyWaitTime( void );
+
+/*!
+ * \brief Gets the number of times the MCU had to wait on the Busy pin since
+ *        the last statistics reset
+ *
+ * \retval count Number of Busy pin waits
+ */
+uint32_t SX126xGetBusyWaitCount( void );
+
+/*!
+ * \brief Resets the Busy pin wait statistics
+ */
+void SX126xResetBusyWaitStats( void );
+
 /*!
  * \brief Wakes up the radio
  */
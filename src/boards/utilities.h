@@ -132,6 +132,33 @@ void memset1( uint8_t *dst, uint8_t value, uint16_t size );
  */
 int8_t Nibble2HexChar( uint8_t a );
 
+/*!
+ * \brief Fills the unused stack area with a known pattern in order to be able
+ *        to compute the stack watermark.
+ *
+ * \remark Must be called once, as early as possible. (Called by BoardInitMcu)
+ *         The unused area is located between the end of the statically
+ *         allocated RAM (_ebss) and the current stack pointer.
+ */
+void StackWatermarkInit( void );
+
+/*!
+ * \brief Computes the maximum stack usage since StackWatermarkInit call
+ *
+ * \remark The returned value also accounts the heap usage when the heap is
+ *         used.
+ *
+ * \retval usage Maximum stack usage in bytes
+ */
+uint32_t StackWatermarkGetMaxUsage( void );
+
+/*!
+ * \brief Computes the stack area never used since StackWatermarkInit call
+ *
+ * \retval free Remaining stack margin in bytes
+ */
+uint32_t StackWatermarkGetFree( void );
+
 /*!
  * Begins critical section
  */
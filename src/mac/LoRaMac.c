@@ -30,8 +30,10 @@
  *
  * \author    Johannes Bruder ( STACKFORCE )
  */
+#include <stddef.h>
 #include "utilities.h"
 #include "region/Region.h"
+#include "region/RegionCommon.h"
 #include "LoRaMacClassB.h"
 #include "LoRaMacCrypto.h"
 #include "secure-element.h"
@@ -43,6 +45,10 @@
 #include "LoRaMacParser.h"
 #include "LoRaMacCommands.h"
 #include "LoRaMacAdr.h"
+#include "LoRaMacTrace.h"
+#include "LoRaMacRxTiming.h"
+#include "LoRaMacJoinScheduler.h"
+#include "LoRaMacRejoinScheduler.h"
 
 #include "LoRaMac.h"
 
@@ -185,6 +191,14 @@ typedef struct sLoRaMacNvmCtx
     * \remark Used for the BACKOFF_DC computation.
     */
     SysTime_t InitializationTime;
+    /*
+     * Join requests scheduling, kept across power cycles
+     */
+    JoinSchedulerNvmCtx_t JoinScheduler;
+    /*
+     * Rejoin requests scheduling
+     */
+    RejoinSchedulerNvmCtx_t RejoinScheduler;
     /*
      * Current LoRaWAN Version
      */
@@ -213,10 +227,6 @@ typedef struct sLoRaMacCtx
     * Current processed transmit message
     */
     LoRaMacMessage_t TxMsg;
-    /*!
-    * Buffer containing the data received by the application.
-    */
-    uint8_t AppData[LORAMAC_PHY_MAXPAYLOAD];
     /*
     * Size of buffer containing the application data.
     */
@@ -338,6 +348,19 @@ typedef struct sLoRaMacCtx
     * Non-volatile module context structure
     */
     LoRaMacNvmCtx_t* NvmCtx;
+    /*
+     * MAC performance counters
+     */
+    LoRaMacPerfCounters_t PerfCounters;
+    /*
+     * RX1 and RX2 windows timing error context
+     */
+    RxTimingCtx_t RxTiming;
+    /*
+     * Set to put the radio to sleep from the RX1 and RX2 radio interrupts
+     * and to cancel RX2 as soon as RX1 received a frame for the device
+     */
+    bool RxEarlyExit;
 }LoRaMacCtx_t;
 
 /*
@@ -345,6 +368,11 @@ typedef struct sLoRaMacCtx
  */
 static LoRaMacCtx_t MacCtx;
 
+/*
+ * Records the MAC state and flags in the trace
+ */
+#define LORAMAC_TRACE_MAC_STATE( )                  LORAMAC_TRACE( LORAMAC_TRACE_EVENT_MAC_STATE, MacCtx.MacFlags.Value, MacCtx.MacState )
+
 /*
  * Non-volatile module context.
  */
@@ -389,6 +417,17 @@ static void OnRadioTxDone( void );
  */
 static void PrepareRxDoneAbort( void );
 
+/*!
+ * \brief Accounts a valid downlink in the performance counters of the
+ *        current receive window
+ */
+static void PerfCountersRxHit( void );
+
+/*!
+ * \brief Measures the timing error of a downlink received in RX1 or RX2
+ */
+static void UpdateRxTiming( void );
+
 /*!
  * \brief Function to be executed on Radio Rx Done event
  */
@@ -409,6 +448,16 @@ static void OnRadioRxError( void );
  */
 static void OnRadioRxTimeout( void );
 
+/*!
+ * \brief Ends a RX1 or RX2 reception without waiting for the MAC processing
+ *
+ * \remark Called from the radio interrupts
+ *
+ * \param [IN] payload Received frame, NULL if none
+ * \param [IN] size    Received frame size
+ */
+static void RxEarlyExit( uint8_t* payload, uint16_t size );
+
 /*!
  * \brief Function executed on duty cycle delayed Tx  timer event
  */
@@ -516,6 +565,22 @@ LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uin
  */
 LoRaMacStatus_t SendReJoinReq( JoinReqIdentifier_t joinReqType );
 
+/*!
+ * \brief Gets the join-request or rejoin type of the last frame sent
+ *
+ * \retval joinReqType Rejoin type, JOIN_REQ if the frame isn't a rejoin
+ */
+static JoinReqIdentifier_t GetTxJoinReqType( void );
+
+/*!
+ * \brief Gets the MLME primitive of a join-request or rejoin
+ *
+ * \param [IN] joinReqType Type of join-request or rejoin
+ *
+ * \retval mlme MLME primitive
+ */
+static Mlme_t GetJoinMlme( JoinReqIdentifier_t joinReqType );
+
 /*!
  * \brief LoRaMAC layer frame buffer initialization
  *
@@ -600,6 +665,11 @@ LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint
  */
 static void ResetMacParameters( void );
 
+/*!
+ * \brief Loads the default MAC parameters of the active region
+ */
+static void LoadRegionDefaults( void );
+
 /*!
  * \brief Initializes and opens the reception window
  *
@@ -770,6 +840,21 @@ static void LoRaMacHandleRequestEvents( void );
  */
 static void LoRaMacHandleIndicationEvents( void );
 
+/*!
+ * \brief Sends the due rejoin request at the end of a transaction
+ */
+static void LoRaMacHandleRejoinEvent( void );
+
+/*!
+ * \brief Gets the datarate of a periodic rejoin request. It is the highest
+ *        datarate, thus the shortest time on air, allowed by the region and
+ *        supported by an enabled channel. The current datarate is the lower
+ *        bound.
+ *
+ * \retval Datarate of the rejoin request
+ */
+static int8_t GetRejoinDatarate( void );
+
 /*!
  * Structure used to store the radio Tx event data
  */
@@ -793,6 +878,7 @@ struct
 static void OnRadioTxDone( void )
 {
     TxDoneParams.CurTime = TimerGetCurrentTime( );
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_TX_DONE, 0, 0 );
     MacCtx.LastTxSysTime = SysTimeGet( );
 
     LoRaMacRadioEvents.Events.TxDone = 1;
@@ -810,6 +896,8 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
     RxDoneParams.Size = size;
     RxDoneParams.Rssi = rssi;
     RxDoneParams.Snr = snr;
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_RX_DONE, size, rssi );
+    RxEarlyExit( payload, size );
 
     LoRaMacRadioEvents.Events.RxDone = 1;
 
@@ -821,6 +909,7 @@ static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t
 
 static void OnRadioTxTimeout( void )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_TX_TIMEOUT, 0, 0 );
     LoRaMacRadioEvents.Events.TxTimeout = 1;
 
     if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
@@ -831,6 +920,8 @@ static void OnRadioTxTimeout( void )
 
 static void OnRadioRxError( void )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_RX_ERROR, 0, 0 );
+    RxEarlyExit( NULL, 0 );
     LoRaMacRadioEvents.Events.RxError = 1;
 
     if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
@@ -841,6 +932,8 @@ static void OnRadioRxError( void )
 
 static void OnRadioRxTimeout( void )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_RX_TIMEOUT, 0, 0 );
+    RxEarlyExit( NULL, 0 );
     LoRaMacRadioEvents.Events.RxTimeout = 1;
 
     if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
@@ -849,6 +942,54 @@ static void OnRadioRxTimeout( void )
     }
 }
 
+static void RxEarlyExit( uint8_t* payload, uint16_t size )
+{
+    LoRaMacHeader_t macHdr;
+    uint32_t address;
+
+    if( ( MacCtx.RxEarlyExit == false ) || ( MacCtx.NvmCtx->DeviceClass == CLASS_C ) ||
+        ( ( MacCtx.RxSlot != RX_SLOT_WIN_1 ) && ( MacCtx.RxSlot != RX_SLOT_WIN_2 ) ) )
+    {
+        return;
+    }
+    // The single reception is over, the radio would idle in standby until
+    // the MAC processing
+    Radio.Sleep( );
+
+    if( ( MacCtx.RxSlot != RX_SLOT_WIN_1 ) || ( payload == NULL ) ||
+        ( size < ( LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE ) ) )
+    {
+        return;
+    }
+    // Cancel RX2 once the header shows a frame for the device, the frame is
+    // authenticated later by the MAC processing
+    macHdr.Value = payload[0];
+    switch( macHdr.Bits.MType )
+    {
+        case FRAME_TYPE_JOIN_ACCEPT:
+            if( ( MacCtx.NvmCtx->NetworkActivation != ACTIVATION_TYPE_NONE ) && ( GetTxJoinReqType( ) == JOIN_REQ ) )
+            {
+                return;
+            }
+            break;
+        case FRAME_TYPE_DATA_CONFIRMED_DOWN:
+        case FRAME_TYPE_DATA_UNCONFIRMED_DOWN:
+            address = ( uint32_t )payload[1];
+            address |= ( uint32_t )payload[2] << 8;
+            address |= ( uint32_t )payload[3] << 16;
+            address |= ( uint32_t )payload[4] << 24;
+            if( address != MacCtx.NvmCtx->DevAddr )
+            {
+                return;
+            }
+            break;
+        default:
+            return;
+    }
+    TimerStop( &MacCtx.RxWindowTimer2 );
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_STOP, LORAMAC_TRACE_TIMER_RX_WINDOW_2, 0 );
+}
+
 static void UpdateRxSlotIdleState( void )
 {
     if( MacCtx.NvmCtx->DeviceClass != CLASS_C )
@@ -874,8 +1015,10 @@ static void ProcessRadioTxDone( void )
     // Setup timers
     TimerSetValue( &MacCtx.RxWindowTimer1, MacCtx.RxWindow1Delay );
     TimerStart( &MacCtx.RxWindowTimer1 );
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_START, LORAMAC_TRACE_TIMER_RX_WINDOW_1, MacCtx.RxWindow1Delay );
     TimerSetValue( &MacCtx.RxWindowTimer2, MacCtx.RxWindow2Delay );
     TimerStart( &MacCtx.RxWindowTimer2 );
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_START, LORAMAC_TRACE_TIMER_RX_WINDOW_2, MacCtx.RxWindow2Delay );
 
     if( ( MacCtx.NvmCtx->DeviceClass == CLASS_C ) || ( MacCtx.NodeAckRequested == true ) )
     {
@@ -883,6 +1026,7 @@ static void ProcessRadioTxDone( void )
         phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
         TimerSetValue( &MacCtx.AckTimeoutTimer, MacCtx.RxWindow2Delay + phyParam.Value );
         TimerStart( &MacCtx.AckTimeoutTimer );
+        LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_START, LORAMAC_TRACE_TIMER_ACK_TIMEOUT, MIN( MacCtx.RxWindow2Delay + phyParam.Value, UINT16_MAX ) );
     }
 
     // Store last Tx channel
@@ -902,15 +1046,67 @@ static void ProcessRadioTxDone( void )
     // Update Aggregated last tx done time
     MacCtx.NvmCtx->LastTxDoneTime = TxDoneParams.CurTime;
 
+    if( MacCtx.TxMsg.Type == LORAMAC_MSG_TYPE_JOIN_REQUEST )
+    {
+        // Schedule the next join request
+        LoRaMacJoinSchedulerOnJoinRequest( &MacCtx.NvmCtx->JoinScheduler, SysTimeGetMcuTime( ).Seconds, SecureElementGetDevEui( ), MacCtx.TxTimeOnAir );
+        EventMacNvmCtxChanged( );
+    }
+    else if( GetTxJoinReqType( ) != JOIN_REQ )
+    {
+        // Schedule the next rejoin request
+        LoRaMacRejoinSchedulerOnRejoin( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds, GetTxJoinReqType( ) );
+        EventMacNvmCtxChanged( );
+    }
+
     if( MacCtx.NodeAckRequested == false )
     {
         MacCtx.McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
     }
 }
 
+static void PerfCountersRxHit( void )
+{
+    if( MacCtx.RxSlot == RX_SLOT_WIN_1 )
+    {
+        MacCtx.PerfCounters.Rx1Hits++;
+    }
+    else if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+    {
+        MacCtx.PerfCounters.Rx2Hits++;
+    }
+}
+
+static void UpdateRxTiming( void )
+{
+    uint32_t receiveDelay;
+    int32_t error;
+
+    if( MacCtx.RxSlot == RX_SLOT_WIN_1 )
+    {
+        receiveDelay = MacCtx.RxWindow1Delay - MacCtx.RxWindow1Config.WindowOffset;
+    }
+    else if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+    {
+        receiveDelay = MacCtx.RxWindow2Delay - MacCtx.RxWindow2Config.WindowOffset;
+    }
+    else
+    {
+        return;
+    }
+
+    // The radio still holds the reception settings. FSK receptions give a wrong
+    // LoRa time on air and are rejected as outliers.
+    error = ( int32_t )( RxDoneParams.LastRxDone - TxDoneParams.CurTime - receiveDelay ) -
+            ( int32_t )Radio.TimeOnAir( MODEM_LORA, RxDoneParams.Size );
+
+    LoRaMacRxTimingOnRxDone( &MacCtx.RxTiming, error, MacCtx.NvmCtx->MacParams.SystemMaxRxError );
+}
+
 static void PrepareRxDoneAbort( void )
 {
     MacCtx.MacState |= LORAMAC_RX_ABORT;
+    LORAMAC_TRACE_MAC_STATE( );
 
     if( MacCtx.NodeAckRequested == true )
     {
@@ -933,6 +1129,8 @@ static void ProcessRadioRxDone( void )
 
     LoRaMacMessageData_t macMsgData;
     LoRaMacMessageJoinAccept_t macMsgJoinAccept;
+    JoinReqIdentifier_t joinReqType;
+    Mlme_t joinMlme;
     uint8_t *payload = RxDoneParams.Payload;
     uint16_t size = RxDoneParams.Size;
     int16_t rssi = RxDoneParams.Rssi;
@@ -964,6 +1162,7 @@ static void ProcessRadioRxDone( void )
 
     Radio.Sleep( );
     TimerStop( &MacCtx.RxWindowTimer2 );
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_STOP, LORAMAC_TRACE_TIMER_RX_WINDOW_2, 0 );
 
     // This function must be called even if we are not in class b mode yet.
     if( LoRaMacClassBRxBeacon( payload, size ) == true )
@@ -996,18 +1195,23 @@ static void ProcessRadioRxDone( void )
         case FRAME_TYPE_JOIN_ACCEPT:
             macMsgJoinAccept.Buffer = payload;
             macMsgJoinAccept.BufSize = size;
+            joinReqType = GetTxJoinReqType( );
+            joinMlme = GetJoinMlme( joinReqType );
 
-            // Abort in case if the device isn't joined yet and no rejoin request is ongoing.
-            if( MacCtx.NvmCtx->NetworkActivation != ACTIVATION_TYPE_NONE )
+            // Abort in case if the device is already joined and no rejoin request is ongoing.
+            if( ( MacCtx.NvmCtx->NetworkActivation != ACTIVATION_TYPE_NONE ) && ( joinReqType == JOIN_REQ ) )
             {
                 MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
                 PrepareRxDoneAbort( );
                 return;
             }
-            macCryptoStatus = LoRaMacCryptoHandleJoinAccept( JOIN_REQ, SecureElementGetJoinEui( ), &macMsgJoinAccept );
+            macCryptoStatus = LoRaMacCryptoHandleJoinAccept( joinReqType, SecureElementGetJoinEui( ), &macMsgJoinAccept );
 
             if( LORAMAC_CRYPTO_SUCCESS == macCryptoStatus )
             {
+                PerfCountersRxHit( );
+                UpdateRxTiming( );
+
                 // Network ID
                 MacCtx.NvmCtx->NetID = ( uint32_t ) macMsgJoinAccept.NetID[0];
                 MacCtx.NvmCtx->NetID |= ( ( uint32_t ) macMsgJoinAccept.NetID[1] << 8 );
@@ -1030,7 +1234,10 @@ static void ProcessRadioRxDone( void )
                 MacCtx.NvmCtx->MacParams.ReceiveDelay1 *= 1000;
                 MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay1 + 1000;
 
-                MacCtx.NvmCtx->Version.Fields.Minor = 0;
+                if( joinReqType == JOIN_REQ )
+                {
+                    MacCtx.NvmCtx->Version.Fields.Minor = 0;
+                }
 
                 // Apply CF list
                 applyCFList.Payload = macMsgJoinAccept.CFList;
@@ -1041,18 +1248,25 @@ static void ProcessRadioRxDone( void )
 
                 MacCtx.NvmCtx->NetworkActivation = ACTIVATION_TYPE_OTAA;
 
+                LoRaMacJoinSchedulerOnJoinAccept( &MacCtx.NvmCtx->JoinScheduler );
+                LoRaMacRejoinSchedulerOnSessionStart( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds );
+
                 // MLME handling
-                if( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true )
+                if( LoRaMacConfirmQueueIsCmdActive( joinMlme ) == true )
                 {
-                    LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_JOIN );
+                    LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, joinMlme );
                 }
             }
             else
             {
+                if( macCryptoStatus == LORAMAC_CRYPTO_FAIL_MIC )
+                {
+                    MacCtx.PerfCounters.MicFailures++;
+                }
                 // MLME handling
-                if( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true )
+                if( LoRaMacConfirmQueueIsCmdActive( joinMlme ) == true )
                 {
-                    LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_JOIN_FAIL, MLME_JOIN );
+                    LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_JOIN_FAIL, joinMlme );
                 }
             }
             break;
@@ -1128,6 +1342,7 @@ static void ProcessRadioRxDone( void )
             macCryptoStatus = GetFCntDown( addrID, fType, &macMsgData, MacCtx.NvmCtx->Version, phyParam.Value, &fCntID, &downLinkCounter );
             if( macCryptoStatus != LORAMAC_CRYPTO_SUCCESS )
             {
+                MacCtx.PerfCounters.FCntDrops++;
                 if( macCryptoStatus == LORAMAC_CRYPTO_FAIL_FCNT_DUPLICATED )
                 {
                     // Catch the case of repeated downlink frame counter
@@ -1164,12 +1379,15 @@ static void ProcessRadioRxDone( void )
                 {
                     // MIC calculation fail
                     MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_MIC_FAIL;
+                    MacCtx.PerfCounters.MicFailures++;
                 }
                 PrepareRxDoneAbort( );
                 return;
             }
 
             // Frame is valid
+            PerfCountersRxHit( );
+            UpdateRxTiming( );
             MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
             MacCtx.McpsIndication.Multicast = multicast;
             MacCtx.McpsIndication.FramePending = macMsgData.FHDR.FCtrl.Bits.FPending;
@@ -1402,6 +1620,19 @@ static void ProcessRadioRxError( void )
 
 static void ProcessRadioRxTimeout( void )
 {
+    if( MacCtx.RxSlot == RX_SLOT_WIN_1 )
+    {
+        MacCtx.PerfCounters.Rx1Timeouts++;
+    }
+    else if( MacCtx.RxSlot == RX_SLOT_WIN_2 )
+    {
+        MacCtx.PerfCounters.Rx2Timeouts++;
+
+        if( ( MacCtx.NodeAckRequested == true ) || ( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true ) )
+        {// The expected downlink has been missed in both windows
+            LoRaMacRxTimingOnRxMiss( &MacCtx.RxTiming );
+        }
+    }
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT, LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT );
 }
 
@@ -1479,11 +1710,13 @@ static void LoRaMacHandleRequestEvents( void )
         // Handle callbacks
         if( reqEvents.Bits.McpsReq == 1 )
         {
+            LORAMAC_TRACE( LORAMAC_TRACE_EVENT_MCPS_CONFIRM, MacCtx.McpsConfirm.McpsRequest, MacCtx.McpsConfirm.Status );
             MacCtx.MacPrimitives->MacMcpsConfirm( &MacCtx.McpsConfirm );
         }
 
         if( reqEvents.Bits.MlmeReq == 1 )
         {
+            LORAMAC_TRACE( LORAMAC_TRACE_EVENT_MLME_CONFIRM, MacCtx.MlmeConfirm.MlmeRequest, MacCtx.MlmeConfirm.Status );
             LoRaMacConfirmQueueHandleCb( &MacCtx.MlmeConfirm );
             if( LoRaMacConfirmQueueGetCnt( ) > 0 )
             {
@@ -1504,10 +1737,12 @@ static void LoRaMacHandleScheduleUplinkEvent( void )
     // Handle events
     if( MacCtx.MacState == LORAMAC_IDLE )
     {
-        // Verify if sticky MAC commands are pending or not
+        // Verify if sticky or left over MAC commands are pending or not
         bool isStickyMacCommandPending = false;
+        bool isClippedMacCommandPending = false;
         LoRaMacCommandsStickyCmdsPending( &isStickyMacCommandPending );
-        if( isStickyMacCommandPending == true )
+        LoRaMacCommandsClippedCmdsPending( &isClippedMacCommandPending );
+        if( ( isStickyMacCommandPending == true ) || ( isClippedMacCommandPending == true ) )
         {// Setup MLME indication
             SetMlmeScheduleUplinkIndication( );
         }
@@ -1537,6 +1772,7 @@ static void LoRaMacHandleIndicationEvents( void )
     if( MacCtx.MacFlags.Bits.McpsInd == 1 )
     {
         MacCtx.MacFlags.Bits.McpsInd = 0;
+        LORAMAC_TRACE( LORAMAC_TRACE_EVENT_MCPS_INDICATION, MacCtx.McpsIndication.Port, MacCtx.McpsIndication.Status );
         MacCtx.MacPrimitives->MacMcpsIndication( &MacCtx.McpsIndication );
     }
 }
@@ -1581,7 +1817,9 @@ static void LoRaMacHandleMcpsRequest( void )
         if( stopRetransmission == true )
         {// Stop retransmission
             TimerStop( &MacCtx.TxDelayedTimer );
+            LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_STOP, LORAMAC_TRACE_TIMER_TX_DELAYED, 0 );
             MacCtx.MacState &= ~LORAMAC_TX_DELAYED;
+            LORAMAC_TRACE_MAC_STATE( );
             StopRetransmission( );
         }
         else if( waitForRetransmission == false )
@@ -1595,23 +1833,97 @@ static void LoRaMacHandleMcpsRequest( void )
     }
 }
 
+static int8_t GetRejoinDatarate( void )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    VerifyParams_t verify;
+    ChannelParams_t* channels;
+    uint16_t* channelsMask;
+    uint8_t nbChannels;
+    int8_t datarate = DR_15;
+
+    getPhy.Attribute = PHY_CHANNELS;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    channels = phyParam.Channels;
+
+    getPhy.Attribute = PHY_CHANNELS_MASK;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    channelsMask = phyParam.ChannelsMask;
+
+    getPhy.Attribute = PHY_MAX_NB_CHANNELS;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    nbChannels = phyParam.Value;
+
+    verify.DatarateParams.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+    for( ; datarate > MacCtx.NvmCtx->MacParams.ChannelsDatarate; datarate-- )
+    {
+        verify.DatarateParams.Datarate = datarate;
+        if( ( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_DR ) == true ) &&
+            ( RegionCommonChanVerifyDr( nbChannels, channelsMask, datarate, datarate, datarate, channels ) == true ) )
+        {
+            break;
+        }
+    }
+    return datarate;
+}
+
+static void LoRaMacHandleRejoinEvent( void )
+{
+    MlmeReq_t mlmeReq;
+    JoinReqIdentifier_t rejoinType;
+    // Out of range unless a ForceRejoinReq sets it
+    int8_t datarate = DR_15 + 1;
+
+    // Rejoin requests are LoRaWAN 1.1 only, and wait for the end of the
+    // transaction and of the requests issued by the confirm callbacks
+    if( ( LoRaMacIsBusy( ) == true ) || ( MacCtx.MacFlags.Bits.MlmeReq == 1 ) ||
+        ( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE ) ||
+        ( MacCtx.NvmCtx->Version.Fields.Minor == 0 ) )
+    {
+        return;
+    }
+    if( LoRaMacRejoinSchedulerGetPending( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds, &rejoinType, &datarate ) == false )
+    {
+        return;
+    }
+
+    // The rejoin request is sent now or not at all, in which case it is due
+    // again at the end of the next transaction. The current datarate is
+    // restored right away. The datarate is the one of the ForceRejoinReq, if
+    // any, otherwise the cheapest one of the enabled channels.
+    if( datarate > DR_15 )
+    {
+        datarate = GetRejoinDatarate( );
+    }
+    int8_t currentDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
+    mlmeReq.Type = GetJoinMlme( rejoinType );
+    MacCtx.NvmCtx->MacParams.ChannelsDatarate = datarate;
+    LoRaMacMlmeRequest( &mlmeReq );
+    MacCtx.NvmCtx->MacParams.ChannelsDatarate = currentDatarate;
+}
+
 static void LoRaMacHandleMlmeRequest( void )
 {
-    // Handle join request
+    // Handle join and rejoin requests
     if( MacCtx.MacFlags.Bits.MlmeReq == 1 )
     {
-        if( ( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true ) )
+        Mlme_t joinMlme = GetJoinMlme( GetTxJoinReqType( ) );
+
+        if( ( LoRaMacConfirmQueueIsCmdActive( joinMlme ) == true ) )
         {
-            if( LoRaMacConfirmQueueGetStatus( MLME_JOIN ) == LORAMAC_EVENT_INFO_STATUS_OK )
+            if( LoRaMacConfirmQueueGetStatus( joinMlme ) == LORAMAC_EVENT_INFO_STATUS_OK )
             {// Node joined successfully
                 MacCtx.ChannelsNbTransCounter = 0;
             }
             MacCtx.MacState &= ~LORAMAC_TX_RUNNING;
+            LORAMAC_TRACE_MAC_STATE( );
         }
         else if( ( LoRaMacConfirmQueueIsCmdActive( MLME_TXCW ) == true ) ||
                  ( LoRaMacConfirmQueueIsCmdActive( MLME_TXCW_1 ) == true ) )
         {
             MacCtx.MacState &= ~LORAMAC_TX_RUNNING;
+            LORAMAC_TRACE_MAC_STATE( );
         }
     }
 }
@@ -1624,6 +1936,7 @@ static uint8_t LoRaMacCheckForBeaconAcquisition( void )
         if( MacCtx.MacFlags.Bits.MlmeReq == 1 )
         {
             MacCtx.MacState &= ~LORAMAC_TX_RUNNING;
+            LORAMAC_TRACE_MAC_STATE( );
             return 0x01;
         }
     }
@@ -1637,6 +1950,7 @@ static void LoRaMacCheckForRxAbort( void )
     {
         MacCtx.MacState &= ~LORAMAC_RX_ABORT;
         MacCtx.MacState &= ~LORAMAC_TX_RUNNING;
+        LORAMAC_TRACE_MAC_STATE( );
     }
 }
 
@@ -1644,6 +1958,8 @@ static void LoRaMacCheckForRxAbort( void )
 void LoRaMacProcess( void )
 {
     uint8_t noTx = false;
+    TimerTime_t startTime = TimerGetCurrentTime( );
+    TimerTime_t processTime;
 
     LoRaMacHandleIrqEvents( );
     LoRaMacClassBProcess( );
@@ -1668,18 +1984,27 @@ void LoRaMacProcess( void )
         LoRaMacHandleRequestEvents( );
         LoRaMacHandleScheduleUplinkEvent( );
         LoRaMacEnableRequests( LORAMAC_REQUEST_HANDLING_ON );
+        LoRaMacHandleRejoinEvent( );
     }
     LoRaMacHandleIndicationEvents( );
     if( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C )
     {
         OpenContinuousRxCWindow( );
     }
+
+    processTime = TimerGetElapsedTime( startTime );
+    if( processTime > MacCtx.PerfCounters.ProcessTimeMax )
+    {
+        MacCtx.PerfCounters.ProcessTimeMax = processTime;
+    }
 }
 
 static void OnTxDelayedTimerEvent( void* context )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_EXPIRED, LORAMAC_TRACE_TIMER_TX_DELAYED, 0 );
     TimerStop( &MacCtx.TxDelayedTimer );
     MacCtx.MacState &= ~LORAMAC_TX_DELAYED;
+    LORAMAC_TRACE_MAC_STATE( );
 
     // Schedule frame, allow delayed frame transmissions
     switch( ScheduleTx( true ) )
@@ -1704,6 +2029,7 @@ static void OnTxDelayedTimerEvent( void* context )
 
 static void OnRxWindow1TimerEvent( void* context )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_EXPIRED, LORAMAC_TRACE_TIMER_RX_WINDOW_1, 0 );
     MacCtx.RxWindow1Config.Channel = MacCtx.Channel;
     MacCtx.RxWindow1Config.DrOffset = MacCtx.NvmCtx->MacParams.Rx1DrOffset;
     MacCtx.RxWindow1Config.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
@@ -1716,6 +2042,7 @@ static void OnRxWindow1TimerEvent( void* context )
 
 static void OnRxWindow2TimerEvent( void* context )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_EXPIRED, LORAMAC_TRACE_TIMER_RX_WINDOW_2, 0 );
     // Check if we are processing Rx1 window.
     // If yes, we don't setup the Rx2 window.
     if( MacCtx.RxSlot == RX_SLOT_WIN_1 )
@@ -1734,6 +2061,7 @@ static void OnRxWindow2TimerEvent( void* context )
 
 static void OnAckTimeoutTimerEvent( void* context )
 {
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_EXPIRED, LORAMAC_TRACE_TIMER_ACK_TIMEOUT, 0 );
     TimerStop( &MacCtx.AckTimeoutTimer );
 
     if( MacCtx.NodeAckRequested == true )
@@ -2169,6 +2497,54 @@ static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t comm
                 MacCtx.McpsIndication.DeviceTimeAnsReceived = true;
                 break;
             }
+            case SRV_MAC_FORCE_REJOIN_REQ:
+            {
+                if( MacCtx.NvmCtx->Version.Fields.Minor == 0 )
+                {
+                    // LoRaWAN 1.1 command. ABORT MAC commands processing
+                    return;
+                }
+                VerifyParams_t verify;
+                uint16_t forceRejoinReq = ( uint16_t )payload[macIndex++];
+                forceRejoinReq |= ( uint16_t )payload[macIndex++] << 8;
+                uint8_t rejoinType = ( forceRejoinReq >> 4 ) & 0x07;
+
+                verify.DatarateParams.Datarate = forceRejoinReq & 0x0F;
+                verify.DatarateParams.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+                if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_DR ) == false )
+                {
+                    verify.DatarateParams.Datarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
+                }
+
+                // RejoinType 0 and 1 request a rejoin type 0, the others are RFU
+                if( rejoinType <= REJOIN_REQ_2 )
+                {
+                    LoRaMacRejoinSchedulerForce( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds,
+                                                 ( rejoinType == REJOIN_REQ_2 ) ? REJOIN_REQ_2 : REJOIN_REQ_0,
+                                                 ( forceRejoinReq >> 11 ) & 0x07, ( forceRejoinReq >> 8 ) & 0x07,
+                                                 verify.DatarateParams.Datarate );
+                }
+                break;
+            }
+            case SRV_MAC_REJOIN_PARAM_REQ:
+            {
+                if( MacCtx.NvmCtx->Version.Fields.Minor == 0 )
+                {
+                    // LoRaWAN 1.1 command. ABORT MAC commands processing
+                    return;
+                }
+                uint8_t rejoinParam = payload[macIndex++];
+
+                macCmdPayload[0] = 0;
+                if( LoRaMacRejoinSchedulerSetup( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds,
+                                                 ( rejoinParam >> 4 ) & 0x0F, rejoinParam & 0x0F ) == true )
+                {
+                    // TimeOK
+                    macCmdPayload[0] = 0x01;
+                }
+                LoRaMacCommandsAddCmd( MOTE_MAC_REJOIN_PARAM_ANS, macCmdPayload, 1 );
+                break;
+            }
             case SRV_MAC_PING_SLOT_INFO_ANS:
             {
                 // According to the specification, it is not allowed to process this answer in
@@ -2293,7 +2669,7 @@ LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uin
     status = PrepareFrame( macHdr, &fCtrl, fPort, fBuffer, fBufferSize );
 
     // Validate status
-    if( ( status == LORAMAC_STATUS_OK ) || ( status == LORAMAC_STATUS_SKIPPED_APP_DATA ) )
+    if( status == LORAMAC_STATUS_OK )
     {
         // Schedule frame, do not allow delayed transmissions
         status = ScheduleTx( false );
@@ -2327,6 +2703,7 @@ LoRaMacStatus_t SendReJoinReq( JoinReqIdentifier_t joinReqType )
     LoRaMacHeader_t macHdr;
     macHdr.Value = 0;
     bool allowDelayedTx = true;
+    uint32_t joinDelay = 0;
 
     // Setup join/rejoin message
     switch( joinReqType )
@@ -2347,6 +2724,43 @@ LoRaMacStatus_t SendReJoinReq( JoinReqIdentifier_t joinReqType )
 
             allowDelayedTx = false;
 
+            joinDelay = LoRaMacJoinSchedulerGetDelay( &MacCtx.NvmCtx->JoinScheduler, SysTimeGetMcuTime( ).Seconds, SecureElementGetDevEui( ) );
+            EventMacNvmCtxChanged( );
+            break;
+        }
+        case REJOIN_REQ_0:
+        case REJOIN_REQ_2:
+        {
+            MacCtx.TxMsg.Type = LORAMAC_MSG_TYPE_RE_JOIN_0_2;
+            MacCtx.TxMsg.Message.ReJoin0or2.Buffer = MacCtx.PktBuffer;
+            MacCtx.TxMsg.Message.ReJoin0or2.BufSize = LORAMAC_PHY_MAXPAYLOAD;
+
+            macHdr.Bits.MType = FRAME_TYPE_REJOIN;
+            MacCtx.TxMsg.Message.ReJoin0or2.MHDR.Value = macHdr.Value;
+            MacCtx.TxMsg.Message.ReJoin0or2.ReJoinType = joinReqType;
+
+            MacCtx.TxMsg.Message.ReJoin0or2.NetID[0] = MacCtx.NvmCtx->NetID & 0xFF;
+            MacCtx.TxMsg.Message.ReJoin0or2.NetID[1] = ( MacCtx.NvmCtx->NetID >> 8 ) & 0xFF;
+            MacCtx.TxMsg.Message.ReJoin0or2.NetID[2] = ( MacCtx.NvmCtx->NetID >> 16 ) & 0xFF;
+            memcpy1( MacCtx.TxMsg.Message.ReJoin0or2.DevEUI, SecureElementGetDevEui( ), LORAMAC_DEV_EUI_FIELD_SIZE );
+
+            allowDelayedTx = false;
+            break;
+        }
+        case REJOIN_REQ_1:
+        {
+            MacCtx.TxMsg.Type = LORAMAC_MSG_TYPE_RE_JOIN_1;
+            MacCtx.TxMsg.Message.ReJoin1.Buffer = MacCtx.PktBuffer;
+            MacCtx.TxMsg.Message.ReJoin1.BufSize = LORAMAC_PHY_MAXPAYLOAD;
+
+            macHdr.Bits.MType = FRAME_TYPE_REJOIN;
+            MacCtx.TxMsg.Message.ReJoin1.MHDR.Value = macHdr.Value;
+            MacCtx.TxMsg.Message.ReJoin1.ReJoinType = joinReqType;
+
+            memcpy1( MacCtx.TxMsg.Message.ReJoin1.JoinEUI, SecureElementGetJoinEui( ), LORAMAC_JOIN_EUI_FIELD_SIZE );
+            memcpy1( MacCtx.TxMsg.Message.ReJoin1.DevEUI, SecureElementGetDevEui( ), LORAMAC_DEV_EUI_FIELD_SIZE );
+
+            allowDelayedTx = false;
             break;
         }
         default:
@@ -2354,17 +2768,56 @@ LoRaMacStatus_t SendReJoinReq( JoinReqIdentifier_t joinReqType )
             break;
     }
 
+    if( joinDelay != 0 )
+    {
+        // Send later, the join request is prepared when the timer expires
+        MacCtx.MacState |= LORAMAC_TX_DELAYED;
+        LORAMAC_TRACE_MAC_STATE( );
+        TimerSetValue( &MacCtx.TxDelayedTimer, joinDelay );
+        TimerStart( &MacCtx.TxDelayedTimer );
+        LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_START, LORAMAC_TRACE_TIMER_TX_DELAYED, MIN( joinDelay, UINT16_MAX ) );
+        return LORAMAC_STATUS_OK;
+    }
+
     // Schedule frame
     status = ScheduleTx( allowDelayedTx );
     return status;
 }
 
+static JoinReqIdentifier_t GetTxJoinReqType( void )
+{
+    if( MacCtx.TxMsg.Type == LORAMAC_MSG_TYPE_RE_JOIN_1 )
+    {
+        return REJOIN_REQ_1;
+    }
+    if( MacCtx.TxMsg.Type == LORAMAC_MSG_TYPE_RE_JOIN_0_2 )
+    {
+        return ( JoinReqIdentifier_t )MacCtx.TxMsg.Message.ReJoin0or2.ReJoinType;
+    }
+    return JOIN_REQ;
+}
+
+static Mlme_t GetJoinMlme( JoinReqIdentifier_t joinReqType )
+{
+    switch( joinReqType )
+    {
+        case REJOIN_REQ_0:
+            return MLME_REJOIN_0;
+        case REJOIN_REQ_1:
+            return MLME_REJOIN_1;
+        case REJOIN_REQ_2:
+            return MLME_REJOIN_2;
+        default:
+            return MLME_JOIN;
+    }
+}
+
 static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_PARAMETER_INVALID;
     TimerTime_t dutyCycleTimeOff = 0;
+    uint32_t rxError;
     NextChanParams_t nextChan;
-    size_t macCmdsSize = 0;
 
     // Update back-off
     CalculateBackOff( MacCtx.NvmCtx->LastTxChannel );
@@ -2395,8 +2848,14 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
             if( dutyCycleTimeOff != 0 )
             {// Send later - prepare timer
                 MacCtx.MacState |= LORAMAC_TX_DELAYED;
+                LORAMAC_TRACE_MAC_STATE( );
                 TimerSetValue( &MacCtx.TxDelayedTimer, dutyCycleTimeOff );
                 TimerStart( &MacCtx.TxDelayedTimer );
+                LORAMAC_TRACE( LORAMAC_TRACE_EVENT_TIMER_START, LORAMAC_TRACE_TIMER_TX_DELAYED, MIN( dutyCycleTimeOff, UINT16_MAX ) );
+
+                MacCtx.PerfCounters.DutyCycleDelays++;
+                MacCtx.PerfCounters.DutyCycleDelayTotal += dutyCycleTimeOff;
+                MacCtx.PerfCounters.DutyCycleDelayMax = MAX( MacCtx.PerfCounters.DutyCycleDelayMax, dutyCycleTimeOff );
             }
             return LORAMAC_STATUS_OK;
         }
@@ -2406,32 +2865,35 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
         }
     }
 
+    // Get the timing error measured on the previous downlinks
+    rxError = LoRaMacRxTimingGetRxError( &MacCtx.RxTiming, MacCtx.NvmCtx->MacParams.SystemMaxRxError );
+
     // Compute Rx1 windows parameters
     RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
                                      RegionApplyDrOffset( MacCtx.NvmCtx->Region, MacCtx.NvmCtx->MacParams.DownlinkDwellTime, MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.NvmCtx->MacParams.Rx1DrOffset ),
                                      MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                     rxError,
                                      &MacCtx.RxWindow1Config );
     // Compute Rx2 windows parameters
     RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
                                      MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate,
                                      MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                     rxError,
                                      &MacCtx.RxWindow2Config );
 
-    if( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE )
+    if( ( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE ) || ( GetTxJoinReqType( ) != JOIN_REQ ) )
     {
+        // A rejoin request is answered with the join accept timing
         MacCtx.RxWindow1Delay = MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 + MacCtx.RxWindow1Config.WindowOffset;
         MacCtx.RxWindow2Delay = MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 + MacCtx.RxWindow2Config.WindowOffset;
     }
     else
     {
-        if( LoRaMacCommandsGetSizeSerializedCmds( &macCmdsSize ) != LORAMAC_COMMANDS_SUCCESS )
-        {
-            return LORAMAC_STATUS_MAC_COMMAD_ERROR;
-        }
-
-        if( ValidatePayloadLength( MacCtx.AppDataSize, MacCtx.NvmCtx->MacParams.ChannelsDatarate, macCmdsSize ) == false )
+        // The frame layout has been computed once by PrepareFrame. Only verify
+        // that it fits into the current datarate.
+        if( ( MacCtx.TxMsg.Type == LORAMAC_MSG_TYPE_DATA ) &&
+            ( ValidatePayloadLength( MacCtx.TxMsg.Message.Data.FRMPayloadSize, MacCtx.NvmCtx->MacParams.ChannelsDatarate,
+                                     MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Bits.FOptsLen ) == false ) )
         {
             return LORAMAC_STATUS_LENGTH_ERROR;
         }
@@ -2465,6 +2927,22 @@ static LoRaMacStatus_t SecureFrame( uint8_t txDr, uint8_t txCh )
             }
             MacCtx.PktBufferLen = MacCtx.TxMsg.Message.JoinReq.BufSize;
             break;
+        case LORAMAC_MSG_TYPE_RE_JOIN_1:
+            macCryptoStatus = LoRaMacCryptoPrepareReJoinType1( &MacCtx.TxMsg.Message.ReJoin1 );
+            if( LORAMAC_CRYPTO_SUCCESS != macCryptoStatus )
+            {
+                return LORAMAC_STATUS_CRYPTO_ERROR;
+            }
+            MacCtx.PktBufferLen = MacCtx.TxMsg.Message.ReJoin1.BufSize;
+            break;
+        case LORAMAC_MSG_TYPE_RE_JOIN_0_2:
+            macCryptoStatus = LoRaMacCryptoPrepareReJoinType0or2( &MacCtx.TxMsg.Message.ReJoin0or2 );
+            if( LORAMAC_CRYPTO_SUCCESS != macCryptoStatus )
+            {
+                return LORAMAC_STATUS_CRYPTO_ERROR;
+            }
+            MacCtx.PktBufferLen = MacCtx.TxMsg.Message.ReJoin0or2.BufSize;
+            break;
         case LORAMAC_MSG_TYPE_DATA:
 
             if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoGetFCntUp( &fCntUp ) )
@@ -2507,6 +2985,12 @@ static void CalculateBackOff( uint8_t channel )
     calcBackOff.DutyCycleEnabled = MacCtx.NvmCtx->DutyCycleOn;
     calcBackOff.Channel = channel;
     calcBackOff.ElapsedTime = SysTimeSub( SysTimeGetMcuTime( ), MacCtx.NvmCtx->InitializationTime );
+    if( calcBackOff.Joined == false )
+    {
+        // The join procedure may have started before the last power cycle
+        calcBackOff.ElapsedTime.Seconds = MAX( calcBackOff.ElapsedTime.Seconds,
+                                               LoRaMacJoinSchedulerGetElapsedTime( &MacCtx.NvmCtx->JoinScheduler, SysTimeGetMcuTime( ).Seconds ) );
+    }
     calcBackOff.TxTimeOnAir = MacCtx.TxTimeOnAir;
     calcBackOff.LastTxIsJoinRequest = false;
     if( ( MacCtx.MacFlags.Bits.MlmeReq == 1 ) && ( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true ) )
@@ -2590,36 +3074,114 @@ static void ResetMacParameters( void )
     MacCtx.RxWindow2Config.RxSlot = RX_SLOT_WIN_2;
 }
 
-/*!
- * \brief Initializes and opens the reception window
- *
- * \param [IN] rxTimer  Window timer to be topped.
- * \param [IN] rxConfig Window parameters to be setup
- */
-static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
+static void LoadRegionDefaults( void )
 {
-    TimerStop( rxTimer );
-
-    // Ensure the radio is Idle
-    Radio.Standby( );
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
 
-    if( RegionRxConfig( MacCtx.NvmCtx->Region, rxConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
-    {
-        Radio.Rx( MacCtx.NvmCtx->MacParams.MaxRxWindow );
-        MacCtx.RxSlot = rxConfig->RxSlot;
-    }
-}
+    getPhy.Attribute = PHY_DUTY_CYCLE;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->DutyCycleOn = ( bool ) phyParam.Value;
 
-static void OpenContinuousRxCWindow( void )
-{
-    MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
-    // Setup continuous listening
-    MacCtx.RxWindowCConfig.RxContinuous = true;
+    getPhy.Attribute = PHY_DEF_TX_POWER;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower = phyParam.Value;
 
-    // At this point the Radio should be idle.
+    getPhy.Attribute = PHY_DEF_TX_DR;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate = phyParam.Value;
+
+    getPhy.Attribute = PHY_MAX_RX_WINDOW;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow = phyParam.Value;
+
+    getPhy.Attribute = PHY_RECEIVE_DELAY1;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1 = phyParam.Value;
+
+    getPhy.Attribute = PHY_RECEIVE_DELAY2;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2 = phyParam.Value;
+
+    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY1;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1 = phyParam.Value;
+
+    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY2;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2 = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_DR1_OFFSET;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.Rx1DrOffset = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_RX2_FREQUENCY;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Frequency = phyParam.Value;
+    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Frequency = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_RX2_DR;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Datarate = phyParam.Value;
+    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Datarate = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_UPLINK_DWELL_TIME;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.UplinkDwellTime = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_DOWNLINK_DWELL_TIME;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.DownlinkDwellTime = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_MAX_EIRP;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.MaxEirp = phyParam.fValue;
+
+    getPhy.Attribute = PHY_DEF_ANTENNA_GAIN;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.AntennaGain = phyParam.fValue;
+
+    getPhy.Attribute = PHY_DEF_ADR_ACK_LIMIT;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.AdrAckLimit = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_ADR_ACK_DELAY;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.AdrAckDelay = phyParam.Value;
+}
+
+/*!
+ * \brief Initializes and opens the reception window
+ *
+ * \param [IN] rxTimer  Window timer to be topped.
+ * \param [IN] rxConfig Window parameters to be setup
+ */
+static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
+{
+    TimerStop( rxTimer );
+
+    // Ensure the radio is Idle
+    Radio.Standby( );
+
+    if( RegionRxConfig( MacCtx.NvmCtx->Region, rxConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
+    {
+        LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_RX, rxConfig->RxSlot, MacCtx.NvmCtx->MacParams.MaxRxWindow );
+        Radio.Rx( MacCtx.NvmCtx->MacParams.MaxRxWindow );
+        MacCtx.RxSlot = rxConfig->RxSlot;
+    }
+}
+
+static void OpenContinuousRxCWindow( void )
+{
+    MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
+    // Setup continuous listening
+    MacCtx.RxWindowCConfig.RxContinuous = true;
+
+    // At this point the Radio should be idle.
     // Thus, there is no need to set the radio in standby mode.
     if( RegionRxConfig( MacCtx.NvmCtx->Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
     {
+        LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_RX, MacCtx.RxWindowCConfig.RxSlot, 0 );
         Radio.Rx( 0 ); // Continuous mode
         MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
     }
@@ -2632,13 +3194,17 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
     uint32_t fCntUp = 0;
     size_t macCmdsSize = 0;
     uint8_t availableSize = 0;
+    uint8_t payloadOffset = 0;
 
     if( fBuffer == NULL )
     {
         fBufferSize = 0;
     }
+    if( fBufferSize > ( LORAMAC_PHY_MAXPAYLOAD - LORAMAC_MHDR_FIELD_SIZE ) )
+    {
+        return LORAMAC_STATUS_LENGTH_ERROR;
+    }
 
-    memcpy1( MacCtx.AppData, ( uint8_t* ) fBuffer, fBufferSize );
     MacCtx.AppDataSize = fBufferSize;
     MacCtx.PktBuffer[0] = macHdr->Value;
 
@@ -2656,7 +3222,8 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
             MacCtx.TxMsg.Message.Data.FHDR.DevAddr = MacCtx.NvmCtx->DevAddr;
             MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Value = fCtrl->Value;
             MacCtx.TxMsg.Message.Data.FRMPayloadSize = MacCtx.AppDataSize;
-            MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.AppData;
+            // Application payload position when there is no FOpts
+            MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.PktBuffer + LORA_MAC_FRMPAYLOAD_OVERHEAD - LORAMAC_MIC_FIELD_SIZE;
 
             if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoGetFCntUp( &fCntUp ) )
             {
@@ -2679,10 +3246,20 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
             {
                 availableSize = GetMaxAppPayloadWithoutFOptsLength( MacCtx.NvmCtx->MacParams.ChannelsDatarate );
 
-                // There is application payload available and the MAC commands fit into FOpts field.
-                if( ( MacCtx.AppDataSize > 0 ) && ( macCmdsSize <= LORA_MAC_COMMAND_MAX_FOPTS_LENGTH ) )
+                // There is application payload available. The MAC commands
+                // use the room left in the FOpts field by priority, the others
+                // are kept for a dedicated uplink.
+                if( MacCtx.AppDataSize > 0 )
                 {
-                    if( LoRaMacCommandsSerializeCmds( LORA_MAC_COMMAND_MAX_FOPTS_LENGTH, &macCmdsSize, MacCtx.TxMsg.Message.Data.FHDR.FOpts ) != LORAMAC_COMMANDS_SUCCESS )
+                    if( availableSize > MacCtx.AppDataSize )
+                    {
+                        availableSize = MIN( availableSize - MacCtx.AppDataSize, LORA_MAC_COMMAND_MAX_FOPTS_LENGTH );
+                    }
+                    else
+                    {
+                        availableSize = 0;
+                    }
+                    if( LoRaMacCommandsSerializeCmds( availableSize, &macCmdsSize, MacCtx.TxMsg.Message.Data.FHDR.FOpts ) != LORAMAC_COMMANDS_SUCCESS )
                     {
                         return LORAMAC_STATUS_MAC_COMMAD_ERROR;
                     }
@@ -2690,16 +3267,6 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
                     // Update FCtrl field with new value of FOptionsLength
                     MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Value = fCtrl->Value;
                 }
-                // There is application payload available but the MAC commands does NOT fit into FOpts field.
-                else if( ( MacCtx.AppDataSize > 0 ) && ( macCmdsSize > LORA_MAC_COMMAND_MAX_FOPTS_LENGTH ) )
-                {
-
-                    if( LoRaMacCommandsSerializeCmds( availableSize, &macCmdsSize, MacCtx.NvmCtx->MacCommandsBuffer ) != LORAMAC_COMMANDS_SUCCESS )
-                    {
-                        return LORAMAC_STATUS_MAC_COMMAD_ERROR;
-                    }
-                    return LORAMAC_STATUS_SKIPPED_APP_DATA;
-                }
                 // No application payload available therefore add all mac commands to the FRMPayload.
                 else
                 {
@@ -2715,6 +3282,18 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
                 }
             }
 
+            // The frame layout is now known. Write the application payload at
+            // its final position, it is encrypted in place when securing the frame.
+            if( MacCtx.AppDataSize > 0 )
+            {
+                payloadOffset = LORA_MAC_FRMPAYLOAD_OVERHEAD - LORAMAC_MIC_FIELD_SIZE + fCtrl->Bits.FOptsLen;
+                if( ( payloadOffset + MacCtx.AppDataSize + LORAMAC_MIC_FIELD_SIZE ) > LORAMAC_PHY_MAXPAYLOAD )
+                {
+                    return LORAMAC_STATUS_LENGTH_ERROR;
+                }
+                MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.PktBuffer + payloadOffset;
+                memcpy1( MacCtx.TxMsg.Message.Data.FRMPayload, ( uint8_t* ) fBuffer, MacCtx.AppDataSize );
+            }
             break;
         case FRAME_TYPE_PROPRIETARY:
             if( ( fBuffer != NULL ) && ( MacCtx.AppDataSize > 0 ) )
@@ -2789,12 +3368,22 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
     LoRaMacClassBHaltBeaconing( );
 
     MacCtx.MacState |= LORAMAC_TX_RUNNING;
+    LORAMAC_TRACE_MAC_STATE( );
+
+    MacCtx.PerfCounters.Uplinks++;
+    if( ( MacCtx.TxMsg.Type == LORAMAC_MSG_TYPE_DATA ) &&
+        ( ( MacCtx.ChannelsNbTransCounter >= 1 ) || ( MacCtx.AckTimeoutRetriesCounter > 1 ) ) )
+    {
+        MacCtx.PerfCounters.Retransmissions++;
+    }
+
     if( MacCtx.NodeAckRequested == false )
     {
         MacCtx.ChannelsNbTransCounter++;
     }
 
     // Send now
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_RADIO_TX, MacCtx.Channel, MacCtx.PktBufferLen );
     Radio.Send( MacCtx.PktBuffer, MacCtx.PktBufferLen );
 
     return LORAMAC_STATUS_OK;
@@ -2814,6 +3403,7 @@ LoRaMacStatus_t SetTxContinuousWave( uint16_t timeout )
     RegionSetContinuousWave( MacCtx.NvmCtx->Region, &continuousWave );
 
     MacCtx.MacState |= LORAMAC_TX_RUNNING;
+    LORAMAC_TRACE_MAC_STATE( );
 
     return LORAMAC_STATUS_OK;
 }
@@ -2823,6 +3413,7 @@ LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint
     Radio.SetTxContinuousWave( frequency, power, timeout );
 
     MacCtx.MacState |= LORAMAC_TX_RUNNING;
+    LORAMAC_TRACE_MAC_STATE( );
 
     return LORAMAC_STATUS_OK;
 }
@@ -2856,6 +3447,8 @@ LoRaMacStatus_t RestoreCtxs( LoRaMacCtxs_t* contexts )
     if( contexts->MacNvmCtx != NULL )
     {
         memcpy1( ( uint8_t* ) &NvmMacCtx, ( uint8_t* ) contexts->MacNvmCtx, contexts->MacNvmCtxSize );
+        LoRaMacJoinSchedulerRestore( &MacCtx.NvmCtx->JoinScheduler, SysTimeGetMcuTime( ).Seconds );
+        LoRaMacRejoinSchedulerRestore( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds );
     }
 
     InitDefaultsParams_t params;
@@ -3004,6 +3597,7 @@ static bool StopRetransmission( void )
     MacCtx.NodeAckRequested = false;
     MacCtx.AckTimeoutRetry = false;
     MacCtx.MacState &= ~LORAMAC_TX_RUNNING;
+    LORAMAC_TRACE_MAC_STATE( );
 
     return true;
 }
@@ -3098,8 +3692,6 @@ static uint8_t IsRequestPending( void )
 
 LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacCallback_t* callbacks, LoRaMacRegion_t region )
 {
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
     LoRaMacClassBCallback_t classBCallbacks;
     LoRaMacClassBParams_t classBParams;
 
@@ -3145,75 +3737,7 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.NvmCtx->Version = lrWanVersion;
 
     // Reset to defaults
-    getPhy.Attribute = PHY_DUTY_CYCLE;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->DutyCycleOn = ( bool ) phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_TX_POWER;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_TX_DR;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate = phyParam.Value;
-
-    getPhy.Attribute = PHY_MAX_RX_WINDOW;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow = phyParam.Value;
-
-    getPhy.Attribute = PHY_RECEIVE_DELAY1;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1 = phyParam.Value;
-
-    getPhy.Attribute = PHY_RECEIVE_DELAY2;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2 = phyParam.Value;
-
-    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY1;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1 = phyParam.Value;
-
-    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY2;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2 = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_DR1_OFFSET;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.Rx1DrOffset = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_RX2_FREQUENCY;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Frequency = phyParam.Value;
-    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Frequency = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_RX2_DR;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Datarate = phyParam.Value;
-    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Datarate = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_UPLINK_DWELL_TIME;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.UplinkDwellTime = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_DOWNLINK_DWELL_TIME;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.DownlinkDwellTime = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_MAX_EIRP;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.MaxEirp = phyParam.fValue;
-
-    getPhy.Attribute = PHY_DEF_ANTENNA_GAIN;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.AntennaGain = phyParam.fValue;
-
-    getPhy.Attribute = PHY_DEF_ADR_ACK_LIMIT;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.AdrAckLimit = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_ADR_ACK_DELAY;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.AdrAckDelay = phyParam.Value;
+    LoadRegionDefaults( );
 
     // Init parameters which are not set in function ResetMacParameters
     MacCtx.NvmCtx->MacParamsDefaults.ChannelsNbTrans = 1;
@@ -3237,6 +3761,12 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.MacCallbacks = callbacks;
     MacCtx.MacFlags.Value = 0;
     MacCtx.MacState = LORAMAC_STOPPED;
+    LORAMAC_TRACE_MAC_STATE( );
+    memset1( ( uint8_t* )&MacCtx.PerfCounters, 0, sizeof( LoRaMacPerfCounters_t ) );
+    LoRaMacRxTimingInit( &MacCtx.RxTiming, true );
+    MacCtx.RxEarlyExit = false;
+    LoRaMacJoinSchedulerInit( &MacCtx.NvmCtx->JoinScheduler, false );
+    LoRaMacRejoinSchedulerInit( &MacCtx.NvmCtx->RejoinScheduler, SysTimeGetMcuTime( ).Seconds );
 
     // Reset duty cycle times
     MacCtx.NvmCtx->LastTxDoneTime = 0;
@@ -3324,6 +3854,7 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
 LoRaMacStatus_t LoRaMacStart( void )
 {
     MacCtx.MacState = LORAMAC_IDLE;
+    LORAMAC_TRACE_MAC_STATE( );
     return LORAMAC_STATUS_OK;
 }
 
@@ -3332,6 +3863,7 @@ LoRaMacStatus_t LoRaMacStop( void )
     if( LoRaMacIsBusy( ) == false )
     {
         MacCtx.MacState = LORAMAC_STOPPED;
+        LORAMAC_TRACE_MAC_STATE( );
         return LORAMAC_STATUS_OK;
     }
     else if(  MacCtx.MacState == LORAMAC_STOPPED )
@@ -3341,6 +3873,92 @@ LoRaMacStatus_t LoRaMacStop( void )
     return LORAMAC_STATUS_BUSY;
 }
 
+LoRaMacStatus_t LoRaMacSwitchRegion( LoRaMacRegion_t region, void* regionNvmCtx, LoRaMacParams_t* macParams )
+{
+    InitDefaultsParams_t params;
+    LoRaMacParams_t leftMacParams = MacCtx.NvmCtx->MacParams;
+
+    if( LoRaMacIsBusy( ) == true )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+    if( MacCtx.NvmCtx->DeviceClass != CLASS_A )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    // Verify if the region is supported
+    if( RegionIsActive( region ) == false )
+    {
+        return LORAMAC_STATUS_REGION_NOT_SUPPORTED;
+    }
+
+    MacCtx.NvmCtx->Region = region;
+    LoadRegionDefaults( );
+
+    // Load the channels and bands of the region. The region contexts may
+    // share their storage, the context of the previous region is lost.
+    if( regionNvmCtx != NULL )
+    {
+        params.Type = INIT_TYPE_RESTORE_CTX;
+        params.NvmCtx = regionNvmCtx;
+    }
+    else
+    {
+        params.Type = INIT_TYPE_INIT;
+        params.NvmCtx = NULL;
+    }
+    RegionInitDefaults( MacCtx.NvmCtx->Region, &params );
+
+    // The session, the keys and the frame counters are kept.
+    if( ( regionNvmCtx != NULL ) && ( macParams != NULL ) )
+    {
+        // Resume the parameters the network set through the JoinAccept and
+        // the MAC commands while the region was active.
+        MacCtx.NvmCtx->MacParams = *macParams;
+    }
+    else
+    {
+        // The parameters set by the network of the previous region don't apply.
+        MacCtx.NvmCtx->MacParams.MaxRxWindow = MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow;
+        MacCtx.NvmCtx->MacParams.ReceiveDelay1 = MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1;
+        MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2;
+        MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 = MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1;
+        MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 = MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2;
+        MacCtx.NvmCtx->MacParams.ChannelsTxPower = MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower;
+        MacCtx.NvmCtx->MacParams.ChannelsDatarate = MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate;
+        MacCtx.NvmCtx->MacParams.Rx1DrOffset = MacCtx.NvmCtx->MacParamsDefaults.Rx1DrOffset;
+        MacCtx.NvmCtx->MacParams.Rx2Channel = MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel;
+        MacCtx.NvmCtx->MacParams.RxCChannel = MacCtx.NvmCtx->MacParamsDefaults.RxCChannel;
+        MacCtx.NvmCtx->MacParams.UplinkDwellTime = MacCtx.NvmCtx->MacParamsDefaults.UplinkDwellTime;
+        MacCtx.NvmCtx->MacParams.DownlinkDwellTime = MacCtx.NvmCtx->MacParamsDefaults.DownlinkDwellTime;
+        MacCtx.NvmCtx->MacParams.MaxEirp = MacCtx.NvmCtx->MacParamsDefaults.MaxEirp;
+        MacCtx.NvmCtx->MacParams.AntennaGain = MacCtx.NvmCtx->MacParamsDefaults.AntennaGain;
+    }
+    if( macParams != NULL )
+    {
+        // To be stored with the context of the region left
+        *macParams = leftMacParams;
+    }
+
+    MacCtx.NvmCtx->AdrAckCounter = 0;
+    MacCtx.NvmCtx->MaxDCycle = 0;
+    MacCtx.NvmCtx->AggregatedDCycle = 1;
+
+    MacCtx.Channel = 0;
+    MacCtx.NvmCtx->LastTxChannel = MacCtx.Channel;
+
+    MacCtx.RxWindow2Config.Channel = MacCtx.Channel;
+    MacCtx.RxWindow2Config.Frequency = MacCtx.NvmCtx->MacParams.Rx2Channel.Frequency;
+    MacCtx.RxWindow2Config.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
+
+    // The answers acknowledge settings of the previous region
+    LoRaMacCommandsRemoveAnsCmds( );
+
+    EventMacNvmCtxChanged( );
+    EventRegionNvmCtxChanged( );
+    return LORAMAC_STATUS_OK;
+}
+
 LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
 {
     CalcNextAdrParams_t adrNext;
@@ -3399,29 +4017,211 @@ LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
     }
 }
 
+/*!
+ * MIB attribute access flags
+ */
+#define MIB_ATTRIBUTE_GET                           0x01
+#define MIB_ATTRIBUTE_SET                           0x02
+
+/*!
+ * Declares a MIB attribute stored in the MAC NVM context
+ */
+#define MIB_ATTRIBUTE( nvmField, paramField, access, verify )                           \
+    {                                                                                   \
+        .Offset = offsetof( LoRaMacNvmCtx_t, nvmField ),                                \
+        .Size = sizeof( ( ( MibParam_t* )0 )->paramField ),                             \
+        .Access = ( access ),                                                           \
+        .NvmModule = LORAMAC_NVMCTXMODULE_MAC,                                          \
+        .Verify = ( verify ),                                                           \
+    }
+
+/*!
+ * MIB attribute descriptor
+ */
+typedef struct sMibAttribute
+{
+    /*!
+     * Offset of the attribute in the MAC NVM context
+     */
+    uint16_t Offset;
+    /*!
+     * Attribute size
+     */
+    uint8_t Size;
+    /*!
+     * Allowed accesses [MIB_ATTRIBUTE_GET, MIB_ATTRIBUTE_SET]
+     */
+    uint8_t Access;
+    /*!
+     * NVM context changed by a set
+     */
+    LoRaMacNvmCtxModule_t NvmModule;
+    /*!
+     * Verifies the value to be set, NULL when any value is accepted
+     */
+    bool ( *Verify )( MibParam_t* param );
+}MibAttribute_t;
+
+static bool VerifyMibNetworkActivation( MibParam_t* param )
+{
+    // Do not allow to set ACTIVATION_TYPE_OTAA since the MAC will set it automatically after a successful join process.
+    return param->NetworkActivation != ACTIVATION_TYPE_OTAA;
+}
+
+static bool VerifyMibRxDatarate( int8_t datarate )
+{
+    VerifyParams_t verify;
+
+    verify.DatarateParams.Datarate = datarate;
+    verify.DatarateParams.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
+
+    return RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_RX_DR );
+}
+
+static bool VerifyMibRx2Channel( MibParam_t* param )
+{
+    return VerifyMibRxDatarate( param->Rx2Channel.Datarate );
+}
+
+static bool VerifyMibRxCChannel( MibParam_t* param )
+{
+    return VerifyMibRxDatarate( param->RxCChannel.Datarate );
+}
+
+static bool VerifyMibChannelsNbTrans( MibParam_t* param )
+{
+    return ( param->ChannelsNbTrans >= 1 ) && ( param->ChannelsNbTrans <= 15 );
+}
+
+static bool VerifyMibChannelsDefaultDatarate( MibParam_t* param )
+{
+    VerifyParams_t verify;
+
+    verify.DatarateParams.Datarate = param->ChannelsDefaultDatarate;
+
+    return RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_DEF_TX_DR );
+}
+
+static bool VerifyMibChannelsDatarate( MibParam_t* param )
+{
+    VerifyParams_t verify;
+
+    verify.DatarateParams.Datarate = param->ChannelsDatarate;
+    verify.DatarateParams.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+
+    return RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_DR );
+}
+
+static bool VerifyMibChannelsDefaultTxPower( MibParam_t* param )
+{
+    VerifyParams_t verify;
+
+    verify.TxPower = param->ChannelsDefaultTxPower;
+
+    return RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_DEF_TX_POWER );
+}
+
+static bool VerifyMibChannelsTxPower( MibParam_t* param )
+{
+    VerifyParams_t verify;
+
+    verify.TxPower = param->ChannelsTxPower;
+
+    return RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_POWER );
+}
+
+/*!
+ * MIB attributes which are plain copies of a MAC NVM context field, indexed
+ * by Mib_t. The attributes having side effects are handled by the MIB-Get and
+ * MIB-Set switches.
+ */
+static const MibAttribute_t MibAttributes[] =
+{
+    [MIB_DEVICE_CLASS]              = MIB_ATTRIBUTE( DeviceClass, Class, MIB_ATTRIBUTE_GET, NULL ),
+    [MIB_NETWORK_ACTIVATION]        = MIB_ATTRIBUTE( NetworkActivation, NetworkActivation, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibNetworkActivation ),
+    [MIB_ADR]                       = MIB_ATTRIBUTE( AdrCtrlOn, AdrEnable, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_NET_ID]                    = MIB_ATTRIBUTE( NetID, NetID, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_DEV_ADDR]                  = MIB_ATTRIBUTE( DevAddr, DevAddr, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_PUBLIC_NETWORK]            = MIB_ATTRIBUTE( PublicNetwork, EnablePublicNetwork, MIB_ATTRIBUTE_GET, NULL ),
+    [MIB_REPEATER_SUPPORT]          = MIB_ATTRIBUTE( RepeaterSupport, EnableRepeaterSupport, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_RX2_CHANNEL]               = MIB_ATTRIBUTE( MacParams.Rx2Channel, Rx2Channel, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibRx2Channel ),
+    [MIB_RX2_DEFAULT_CHANNEL]       = MIB_ATTRIBUTE( MacParamsDefaults.Rx2Channel, Rx2DefaultChannel, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibRx2Channel ),
+    [MIB_RXC_CHANNEL]               = MIB_ATTRIBUTE( MacParams.RxCChannel, RxCChannel, MIB_ATTRIBUTE_GET, NULL ),
+    [MIB_RXC_DEFAULT_CHANNEL]       = MIB_ATTRIBUTE( MacParamsDefaults.RxCChannel, RxCDefaultChannel, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibRxCChannel ),
+    [MIB_CHANNELS_NB_TRANS]         = MIB_ATTRIBUTE( MacParams.ChannelsNbTrans, ChannelsNbTrans, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibChannelsNbTrans ),
+    [MIB_MAX_RX_WINDOW_DURATION]    = MIB_ATTRIBUTE( MacParams.MaxRxWindow, MaxRxWindow, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_RECEIVE_DELAY_1]           = MIB_ATTRIBUTE( MacParams.ReceiveDelay1, ReceiveDelay1, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_RECEIVE_DELAY_2]           = MIB_ATTRIBUTE( MacParams.ReceiveDelay2, ReceiveDelay2, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_JOIN_ACCEPT_DELAY_1]       = MIB_ATTRIBUTE( MacParams.JoinAcceptDelay1, JoinAcceptDelay1, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_JOIN_ACCEPT_DELAY_2]       = MIB_ATTRIBUTE( MacParams.JoinAcceptDelay2, JoinAcceptDelay2, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_CHANNELS_DEFAULT_DATARATE] = MIB_ATTRIBUTE( MacParamsDefaults.ChannelsDatarate, ChannelsDefaultDatarate, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibChannelsDefaultDatarate ),
+    [MIB_CHANNELS_DATARATE]         = MIB_ATTRIBUTE( MacParams.ChannelsDatarate, ChannelsDatarate, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibChannelsDatarate ),
+    [MIB_CHANNELS_DEFAULT_TX_POWER] = MIB_ATTRIBUTE( MacParamsDefaults.ChannelsTxPower, ChannelsDefaultTxPower, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibChannelsDefaultTxPower ),
+    [MIB_CHANNELS_TX_POWER]         = MIB_ATTRIBUTE( MacParams.ChannelsTxPower, ChannelsTxPower, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, VerifyMibChannelsTxPower ),
+    [MIB_SYSTEM_MAX_RX_ERROR]       = MIB_ATTRIBUTE( MacParams.SystemMaxRxError, SystemMaxRxError, MIB_ATTRIBUTE_GET, NULL ),
+    [MIB_MIN_RX_SYMBOLS]            = MIB_ATTRIBUTE( MacParams.MinRxSymbols, MinRxSymbols, MIB_ATTRIBUTE_GET, NULL ),
+    [MIB_ANTENNA_GAIN]              = MIB_ATTRIBUTE( MacParams.AntennaGain, AntennaGain, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_DEFAULT_ANTENNA_GAIN]      = MIB_ATTRIBUTE( MacParamsDefaults.AntennaGain, DefaultAntennaGain, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_JOIN_SCHEDULER]            = MIB_ATTRIBUTE( JoinScheduler.Enabled, JoinScheduler, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+    [MIB_REJOIN_1_CYCLE]            = MIB_ATTRIBUTE( RejoinScheduler.Rejoin1Cycle, Rejoin1Cycle, MIB_ATTRIBUTE_GET | MIB_ATTRIBUTE_SET, NULL ),
+};
+
+/*!
+ * \brief Gets the descriptor of a table driven MIB attribute
+ *
+ * \param [IN] type   MIB attribute
+ * \param [IN] access Requested accesses [MIB_ATTRIBUTE_GET, MIB_ATTRIBUTE_SET]
+ *
+ * \retval attribute Attribute descriptor, NULL if the attribute is not table
+ *                   driven for the requested accesses
+ */
+static const MibAttribute_t* GetMibAttribute( Mib_t type, uint8_t access )
+{
+    if( ( ( uint32_t )type < ( sizeof( MibAttributes ) / sizeof( MibAttribute_t ) ) ) &&
+        ( ( MibAttributes[type].Access & access ) == access ) )
+    {
+        return &MibAttributes[type];
+    }
+    return NULL;
+}
+
+/*!
+ * \brief Calls the callback once for each changed NVM context
+ *
+ * \param [IN] nvmCtxChanged Bit mask of the changed LoRaMacNvmCtxModule_t
+ */
+static void EventNvmCtxsChanged( uint8_t nvmCtxChanged )
+{
+    for( uint8_t module = LORAMAC_NVMCTXMODULE_MAC; module <= LORAMAC_NVMCTXMODULE_CONFIRM_QUEUE; module++ )
+    {
+        if( ( nvmCtxChanged & ( 1 << module ) ) != 0 )
+        {
+            CallNvmCtxCallback( ( LoRaMacNvmCtxModule_t )module );
+        }
+    }
+}
+
 LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_OK;
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
+    const MibAttribute_t* attribute;
 
     if( mibGet == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
 
+    attribute = GetMibAttribute( mibGet->Type, MIB_ATTRIBUTE_GET );
+    if( attribute != NULL )
+    {
+        memcpy1( ( uint8_t* )&mibGet->Param, ( uint8_t* )MacCtx.NvmCtx + attribute->Offset, attribute->Size );
+        return LORAMAC_STATUS_OK;
+    }
+
     switch( mibGet->Type )
     {
-        case MIB_DEVICE_CLASS:
-        {
-            mibGet->Param.Class = MacCtx.NvmCtx->DeviceClass;
-            break;
-        }
-        case MIB_NETWORK_ACTIVATION:
-        {
-            mibGet->Param.NetworkActivation = MacCtx.NvmCtx->NetworkActivation;
-            break;
-        }
         case MIB_DEV_EUI:
         {
             mibGet->Param.DevEui = SecureElementGetDevEui( );
@@ -3432,31 +4232,6 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.JoinEui = SecureElementGetJoinEui( );
             break;
         }
-        case MIB_ADR:
-        {
-            mibGet->Param.AdrEnable = MacCtx.NvmCtx->AdrCtrlOn;
-            break;
-        }
-        case MIB_NET_ID:
-        {
-            mibGet->Param.NetID = MacCtx.NvmCtx->NetID;
-            break;
-        }
-        case MIB_DEV_ADDR:
-        {
-            mibGet->Param.DevAddr = MacCtx.NvmCtx->DevAddr;
-            break;
-        }
-        case MIB_PUBLIC_NETWORK:
-        {
-            mibGet->Param.EnablePublicNetwork = MacCtx.NvmCtx->PublicNetwork;
-            break;
-        }
-        case MIB_REPEATER_SUPPORT:
-        {
-            mibGet->Param.EnableRepeaterSupport = MacCtx.NvmCtx->RepeaterSupport;
-            break;
-        }
         case MIB_CHANNELS:
         {
             getPhy.Attribute = PHY_CHANNELS;
@@ -3465,26 +4240,6 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.ChannelList = phyParam.Channels;
             break;
         }
-        case MIB_RX2_CHANNEL:
-        {
-            mibGet->Param.Rx2Channel = MacCtx.NvmCtx->MacParams.Rx2Channel;
-            break;
-        }
-        case MIB_RX2_DEFAULT_CHANNEL:
-        {
-            mibGet->Param.Rx2Channel = MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel;
-            break;
-        }
-        case MIB_RXC_CHANNEL:
-        {
-            mibGet->Param.RxCChannel = MacCtx.NvmCtx->MacParams.RxCChannel;
-            break;
-        }
-        case MIB_RXC_DEFAULT_CHANNEL:
-        {
-            mibGet->Param.RxCChannel = MacCtx.NvmCtx->MacParamsDefaults.RxCChannel;
-            break;
-        }
         case MIB_CHANNELS_DEFAULT_MASK:
         {
             getPhy.Attribute = PHY_CHANNELS_DEFAULT_MASK;
@@ -3501,79 +4256,29 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.ChannelsMask = phyParam.ChannelsMask;
             break;
         }
-        case MIB_CHANNELS_NB_TRANS:
-        {
-            mibGet->Param.ChannelsNbTrans = MacCtx.NvmCtx->MacParams.ChannelsNbTrans;
-            break;
-        }
-        case MIB_MAX_RX_WINDOW_DURATION:
-        {
-            mibGet->Param.MaxRxWindow = MacCtx.NvmCtx->MacParams.MaxRxWindow;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_1:
-        {
-            mibGet->Param.ReceiveDelay1 = MacCtx.NvmCtx->MacParams.ReceiveDelay1;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_2:
-        {
-            mibGet->Param.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay2;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_1:
-        {
-            mibGet->Param.JoinAcceptDelay1 = MacCtx.NvmCtx->MacParams.JoinAcceptDelay1;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_2:
-        {
-            mibGet->Param.JoinAcceptDelay2 = MacCtx.NvmCtx->MacParams.JoinAcceptDelay2;
-            break;
-        }
-        case MIB_CHANNELS_DEFAULT_DATARATE:
-        {
-            mibGet->Param.ChannelsDefaultDatarate = MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate;
-            break;
-        }
-        case MIB_CHANNELS_DATARATE:
-        {
-            mibGet->Param.ChannelsDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
-            break;
-        }
-        case MIB_CHANNELS_DEFAULT_TX_POWER:
-        {
-            mibGet->Param.ChannelsDefaultTxPower = MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower;
-            break;
-        }
-        case MIB_CHANNELS_TX_POWER:
-        {
-            mibGet->Param.ChannelsTxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
-            break;
-        }
-        case MIB_SYSTEM_MAX_RX_ERROR:
+        case MIB_NVM_CTXS:
         {
-            mibGet->Param.SystemMaxRxError = MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+            mibGet->Param.Contexts = GetCtxs( );
             break;
         }
-        case MIB_MIN_RX_SYMBOLS:
+        case MIB_PERF_COUNTERS:
         {
-            mibGet->Param.MinRxSymbols = MacCtx.NvmCtx->MacParams.MinRxSymbols;
+            mibGet->Param.PerfCounters = &MacCtx.PerfCounters;
             break;
         }
-        case MIB_ANTENNA_GAIN:
+        case MIB_RX_ERROR_ADAPTATION:
         {
-            mibGet->Param.AntennaGain = MacCtx.NvmCtx->MacParams.AntennaGain;
+            mibGet->Param.RxErrorAdaptation = MacCtx.RxTiming.Enabled;
             break;
         }
-        case MIB_NVM_CTXS:
+        case MIB_RX_EARLY_EXIT:
         {
-            mibGet->Param.Contexts = GetCtxs( );
+            mibGet->Param.RxEarlyExit = MacCtx.RxEarlyExit;
             break;
         }
-        case MIB_DEFAULT_ANTENNA_GAIN:
+        case MIB_MC_FCNT_DOWN_WINDOW:
         {
-            mibGet->Param.DefaultAntennaGain = MacCtx.NvmCtx->MacParamsDefaults.AntennaGain;
+            LoRaMacCryptoGetMcFCntDownWindow( &mibGet->Param.McFCntDownWindow );
             break;
         }
         default:
@@ -3585,19 +4290,23 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
     return status;
 }
 
-LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
+static LoRaMacStatus_t MibSetRequest( MibRequestConfirm_t* mibSet, uint8_t* nvmCtxChanged )
 {
     LoRaMacStatus_t status = LORAMAC_STATUS_OK;
     ChanMaskSetParams_t chanMaskSet;
     VerifyParams_t verify;
+    const MibAttribute_t* attribute;
 
-    if( mibSet == NULL )
-    {
-        return LORAMAC_STATUS_PARAMETER_INVALID;
-    }
-    if( ( MacCtx.MacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    attribute = GetMibAttribute( mibSet->Type, MIB_ATTRIBUTE_SET );
+    if( attribute != NULL )
     {
-        return LORAMAC_STATUS_BUSY;
+        if( ( attribute->Verify != NULL ) && ( attribute->Verify( &mibSet->Param ) == false ) )
+        {
+            return LORAMAC_STATUS_PARAMETER_INVALID;
+        }
+        memcpy1( ( uint8_t* )MacCtx.NvmCtx + attribute->Offset, ( uint8_t* )&mibSet->Param, attribute->Size );
+        *nvmCtxChanged |= 1 << attribute->NvmModule;
+        return LORAMAC_STATUS_OK;
     }
 
     switch( mibSet->Type )
@@ -3607,18 +4316,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             status = SwitchClass( mibSet->Param.Class );
             break;
         }
-        case MIB_NETWORK_ACTIVATION:
-        {
-            if( mibSet->Param.NetworkActivation != ACTIVATION_TYPE_OTAA  )
-            {
-                MacCtx.NvmCtx->NetworkActivation = mibSet->Param.NetworkActivation;
-            }
-            else
-            {   // Do not allow to set ACTIVATION_TYPE_OTAA since the MAC will set it automatically after a successful join process.
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
         case MIB_DEV_EUI:
         {
             if( SecureElementSetDevEui( mibSet->Param.DevEui ) != SECURE_ELEMENT_SUCCESS )
@@ -3635,21 +4332,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
-        case MIB_ADR:
-        {
-            MacCtx.NvmCtx->AdrCtrlOn = mibSet->Param.AdrEnable;
-            break;
-        }
-        case MIB_NET_ID:
-        {
-            MacCtx.NvmCtx->NetID = mibSet->Param.NetID;
-            break;
-        }
-        case MIB_DEV_ADDR:
-        {
-            MacCtx.NvmCtx->DevAddr = mibSet->Param.DevAddr;
-            break;
-        }
         case MIB_GEN_APP_KEY:
         {
             if( mibSet->Param.GenAppKey != NULL )
@@ -3986,41 +4668,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             Radio.SetPublicNetwork( MacCtx.NvmCtx->PublicNetwork );
             break;
         }
-        case MIB_REPEATER_SUPPORT:
-        {
-            MacCtx.NvmCtx->RepeaterSupport = mibSet->Param.EnableRepeaterSupport;
-            break;
-        }
-        case MIB_RX2_CHANNEL:
-        {
-            verify.DatarateParams.Datarate = mibSet->Param.Rx2Channel.Datarate;
-            verify.DatarateParams.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
-
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_RX_DR ) == true )
-            {
-                MacCtx.NvmCtx->MacParams.Rx2Channel = mibSet->Param.Rx2Channel;
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_RX2_DEFAULT_CHANNEL:
-        {
-            verify.DatarateParams.Datarate = mibSet->Param.Rx2Channel.Datarate;
-            verify.DatarateParams.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
-
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_RX_DR ) == true )
-            {
-                MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel = mibSet->Param.Rx2DefaultChannel;
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
         case MIB_RXC_CHANNEL:
         {
             verify.DatarateParams.Datarate = mibSet->Param.RxCChannel.Datarate;
@@ -4052,21 +4699,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
-        case MIB_RXC_DEFAULT_CHANNEL:
-        {
-            verify.DatarateParams.Datarate = mibSet->Param.RxCChannel.Datarate;
-            verify.DatarateParams.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
-
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_RX_DR ) == true )
-            {
-                MacCtx.NvmCtx->MacParamsDefaults.RxCChannel = mibSet->Param.RxCDefaultChannel;
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
         case MIB_CHANNELS_DEFAULT_MASK:
         {
             chanMaskSet.ChannelsMaskIn = mibSet->Param.ChannelsMask;
@@ -4089,51 +4721,21 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
-        case MIB_CHANNELS_NB_TRANS:
-        {
-            if( ( mibSet->Param.ChannelsNbTrans >= 1 ) &&
-                ( mibSet->Param.ChannelsNbTrans <= 15 ) )
-            {
-                MacCtx.NvmCtx->MacParams.ChannelsNbTrans = mibSet->Param.ChannelsNbTrans;
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MAX_RX_WINDOW_DURATION:
-        {
-            MacCtx.NvmCtx->MacParams.MaxRxWindow = mibSet->Param.MaxRxWindow;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_1:
-        {
-            MacCtx.NvmCtx->MacParams.ReceiveDelay1 = mibSet->Param.ReceiveDelay1;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_2:
-        {
-            MacCtx.NvmCtx->MacParams.ReceiveDelay2 = mibSet->Param.ReceiveDelay2;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_1:
+        case MIB_SYSTEM_MAX_RX_ERROR:
         {
-            MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 = mibSet->Param.JoinAcceptDelay1;
+            MacCtx.NvmCtx->MacParams.SystemMaxRxError = MacCtx.NvmCtx->MacParamsDefaults.SystemMaxRxError = mibSet->Param.SystemMaxRxError;
             break;
         }
-        case MIB_JOIN_ACCEPT_DELAY_2:
+        case MIB_MIN_RX_SYMBOLS:
         {
-            MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 = mibSet->Param.JoinAcceptDelay2;
+            MacCtx.NvmCtx->MacParams.MinRxSymbols = MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols = mibSet->Param.MinRxSymbols;
             break;
         }
-        case MIB_CHANNELS_DEFAULT_DATARATE:
+        case MIB_NVM_CTXS:
         {
-            verify.DatarateParams.Datarate = mibSet->Param.ChannelsDefaultDatarate;
-
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_DEF_TX_DR ) == true )
+            if( mibSet->Param.Contexts != 0 )
             {
-                MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate = verify.DatarateParams.Datarate;
+                status = RestoreCtxs( mibSet->Param.Contexts );
             }
             else
             {
@@ -4141,28 +4743,16 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
-        case MIB_CHANNELS_DATARATE:
+        case MIB_ABP_LORAWAN_VERSION:
         {
-            verify.DatarateParams.Datarate = mibSet->Param.ChannelsDatarate;
-            verify.DatarateParams.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_DR ) == true )
-            {
-                MacCtx.NvmCtx->MacParams.ChannelsDatarate = verify.DatarateParams.Datarate;
-            }
-            else
+            if( mibSet->Param.AbpLrWanVersion.Fields.Minor <= 1 )
             {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_CHANNELS_DEFAULT_TX_POWER:
-        {
-            verify.TxPower = mibSet->Param.ChannelsDefaultTxPower;
+                MacCtx.NvmCtx->Version = mibSet->Param.AbpLrWanVersion;
 
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_DEF_TX_POWER ) == true )
-            {
-                MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower = verify.TxPower;
+                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetLrWanVersion( mibSet->Param.AbpLrWanVersion ) )
+                {
+                    return LORAMAC_STATUS_CRYPTO_ERROR;
+                }
             }
             else
             {
@@ -4170,77 +4760,97 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
-        case MIB_CHANNELS_TX_POWER:
+        case MIB_PERF_COUNTERS:
         {
-            verify.TxPower = mibSet->Param.ChannelsTxPower;
-
-            if( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_POWER ) == true )
+            if( mibSet->Param.PerfCounters != NULL )
             {
-                MacCtx.NvmCtx->MacParams.ChannelsTxPower = verify.TxPower;
+                MacCtx.PerfCounters = *mibSet->Param.PerfCounters;
             }
             else
             {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
+                memset1( ( uint8_t* )&MacCtx.PerfCounters, 0, sizeof( LoRaMacPerfCounters_t ) );
             }
             break;
         }
-        case MIB_SYSTEM_MAX_RX_ERROR:
+        case MIB_RX_ERROR_ADAPTATION:
         {
-            MacCtx.NvmCtx->MacParams.SystemMaxRxError = MacCtx.NvmCtx->MacParamsDefaults.SystemMaxRxError = mibSet->Param.SystemMaxRxError;
+            LoRaMacRxTimingInit( &MacCtx.RxTiming, mibSet->Param.RxErrorAdaptation );
             break;
         }
-        case MIB_MIN_RX_SYMBOLS:
+        case MIB_RX_EARLY_EXIT:
         {
-            MacCtx.NvmCtx->MacParams.MinRxSymbols = MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols = mibSet->Param.MinRxSymbols;
+            MacCtx.RxEarlyExit = mibSet->Param.RxEarlyExit;
             break;
         }
-        case MIB_ANTENNA_GAIN:
+        case MIB_MC_FCNT_DOWN_WINDOW:
         {
-            MacCtx.NvmCtx->MacParams.AntennaGain = mibSet->Param.AntennaGain;
+            LoRaMacCryptoSetMcFCntDownWindow( mibSet->Param.McFCntDownWindow );
             break;
         }
-        case MIB_DEFAULT_ANTENNA_GAIN:
+        default:
         {
-            MacCtx.NvmCtx->MacParamsDefaults.AntennaGain = mibSet->Param.DefaultAntennaGain;
+            status = LoRaMacMibClassBSetRequestConfirm( mibSet );
             break;
         }
-        case MIB_NVM_CTXS:
+    }
+    *nvmCtxChanged |= ( 1 << LORAMAC_NVMCTXMODULE_REGION ) | ( 1 << LORAMAC_NVMCTXMODULE_MAC );
+    return status;
+}
+
+LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
+{
+    LoRaMacStatus_t status;
+    uint8_t nvmCtxChanged = 0;
+
+    if( mibSet == NULL )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    if( ( MacCtx.MacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+
+    status = MibSetRequest( mibSet, &nvmCtxChanged );
+    EventNvmCtxsChanged( nvmCtxChanged );
+    return status;
+}
+
+LoRaMacStatus_t LoRaMacMibSetMany( MibRequestConfirm_t* mibSet, uint8_t nbMib )
+{
+    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
+    const MibAttribute_t* attribute;
+    uint8_t nvmCtxChanged = 0;
+
+    if( ( mibSet == NULL ) || ( nbMib == 0 ) )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    if( ( MacCtx.MacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+
+    // Verify the table driven attributes first, so that an invalid value
+    // leaves the whole set unapplied.
+    for( uint8_t i = 0; i < nbMib; i++ )
+    {
+        attribute = GetMibAttribute( mibSet[i].Type, MIB_ATTRIBUTE_SET );
+        if( ( attribute != NULL ) && ( attribute->Verify != NULL ) && ( attribute->Verify( &mibSet[i].Param ) == false ) )
         {
-            if( mibSet->Param.Contexts != 0 )
-            {
-                status = RestoreCtxs( mibSet->Param.Contexts );
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
+            return LORAMAC_STATUS_PARAMETER_INVALID;
         }
-        case MIB_ABP_LORAWAN_VERSION:
-        {
-            if( mibSet->Param.AbpLrWanVersion.Fields.Minor <= 1 )
-            {
-                MacCtx.NvmCtx->Version = mibSet->Param.AbpLrWanVersion;
+    }
 
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetLrWanVersion( mibSet->Param.AbpLrWanVersion ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        default:
+    for( uint8_t i = 0; i < nbMib; i++ )
+    {
+        status = MibSetRequest( &mibSet[i], &nvmCtxChanged );
+        if( status != LORAMAC_STATUS_OK )
         {
-            status = LoRaMacMibClassBSetRequestConfirm( mibSet );
             break;
         }
     }
-    EventRegionNvmCtxChanged( );
-    EventMacNvmCtxChanged( );
+    EventNvmCtxsChanged( nvmCtxChanged );
     return status;
 }
 
@@ -4429,6 +5039,9 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
     LoRaMacStatus_t status = LORAMAC_STATUS_SERVICE_UNKNOWN;
     MlmeConfirmQueue_t queueElement;
     uint8_t macCmdPayload[2] = { 0x00, 0x00 };
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+    int8_t joinDatarate;
 
     if( mlmeRequest == NULL )
     {
@@ -4465,7 +5078,14 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
 
             ResetMacParameters( );
 
-            MacCtx.NvmCtx->MacParams.ChannelsDatarate = RegionAlternateDr( MacCtx.NvmCtx->Region, mlmeRequest->Req.Join.Datarate, ALTERNATE_DR );
+            // Spread the attempts over the datarates
+            getPhy.Attribute = PHY_MIN_TX_DR;
+            getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+            phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+            joinDatarate = LoRaMacJoinSchedulerGetDatarate( &MacCtx.NvmCtx->JoinScheduler, SecureElementGetDevEui( ),
+                                                            mlmeRequest->Req.Join.Datarate, phyParam.Value );
+
+            MacCtx.NvmCtx->MacParams.ChannelsDatarate = RegionAlternateDr( MacCtx.NvmCtx->Region, joinDatarate, ALTERNATE_DR );
 
             queueElement.Status = LORAMAC_EVENT_INFO_STATUS_JOIN_FAIL;
 
@@ -4474,7 +5094,35 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
             if( status != LORAMAC_STATUS_OK )
             {
                 // Revert back the previous datarate ( mainly used for US915 like regions )
-                MacCtx.NvmCtx->MacParams.ChannelsDatarate = RegionAlternateDr( MacCtx.NvmCtx->Region, mlmeRequest->Req.Join.Datarate, ALTERNATE_DR_RESTORE );
+                MacCtx.NvmCtx->MacParams.ChannelsDatarate = RegionAlternateDr( MacCtx.NvmCtx->Region, joinDatarate, ALTERNATE_DR_RESTORE );
+            }
+            break;
+        }
+        case MLME_REJOIN_0:
+        case MLME_REJOIN_1:
+        case MLME_REJOIN_2:
+        {
+            if( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE )
+            {
+                status = LORAMAC_STATUS_NO_NETWORK_JOINED;
+                break;
+            }
+            if( MacCtx.NvmCtx->Version.Fields.Minor == 0 )
+            {
+                // LoRaWAN 1.1 service
+                break;
+            }
+            if( mlmeRequest->Type == MLME_REJOIN_0 )
+            {
+                status = SendReJoinReq( REJOIN_REQ_0 );
+            }
+            else if( mlmeRequest->Type == MLME_REJOIN_1 )
+            {
+                status = SendReJoinReq( REJOIN_REQ_1 );
+            }
+            else
+            {
+                status = SendReJoinReq( REJOIN_REQ_2 );
             }
             break;
         }
@@ -4572,6 +5220,7 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
         LoRaMacConfirmQueueAdd( &queueElement );
         EventMacNvmCtxChanged( );
     }
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_MLME_REQUEST, mlmeRequest->Type, status );
     return status;
 }
 
@@ -4587,6 +5236,7 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
     uint16_t fBufferSize;
     int8_t datarate = DR_0;
     bool readyToSend = false;
+    TimerTime_t startTime = TimerGetCurrentTime( );
 
     if( mcpsRequest == NULL )
     {
@@ -4673,8 +5323,11 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
         status = Send( &macHdr, fPort, fBuffer, fBufferSize );
         if( status == LORAMAC_STATUS_OK )
         {
+            // Send does not allow delayed transmissions, the radio is transmitting
+            MacCtx.McpsConfirm.TxPreparationTime = TimerGetElapsedTime( startTime );
             MacCtx.McpsConfirm.McpsRequest = mcpsRequest->Type;
             MacCtx.MacFlags.Bits.McpsReq = 1;
+            LoRaMacRejoinSchedulerOnUplink( &MacCtx.NvmCtx->RejoinScheduler );
         }
         else
         {
@@ -4682,6 +5335,7 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
         }
     }
 
+    LORAMAC_TRACE( LORAMAC_TRACE_EVENT_MCPS_REQUEST, mcpsRequest->Type, status );
     EventMacNvmCtxChanged( );
     return status;
 }
@@ -310,6 +310,65 @@ typedef struct sLoRaMacCtxs
     size_t ConfirmQueueNvmCtxSize;
 }LoRaMacCtxs_t;
 
+/*!
+ * LoRaMAC performance counters
+ *
+ * The counters are reset by \ref LoRaMacInitialization
+ */
+typedef struct sLoRaMacPerfCounters
+{
+    /*!
+     * Number of transmitted uplink frames, including the retransmissions
+     */
+    uint32_t Uplinks;
+    /*!
+     * Number of retransmitted data frames (NbTrans repetitions and
+     * confirmed frames retries)
+     */
+    uint32_t Retransmissions;
+    /*!
+     * Number of valid downlinks received in RX1
+     */
+    uint32_t Rx1Hits;
+    /*!
+     * Number of valid downlinks received in RX2
+     */
+    uint32_t Rx2Hits;
+    /*!
+     * Number of RX1 windows closed without reception
+     */
+    uint32_t Rx1Timeouts;
+    /*!
+     * Number of RX2 windows closed without reception
+     */
+    uint32_t Rx2Timeouts;
+    /*!
+     * Number of downlinks dropped due to a MIC check failure
+     */
+    uint32_t MicFailures;
+    /*!
+     * Number of downlinks dropped due to a duplicated, old or out of range
+     * frame counter
+     */
+    uint32_t FCntDrops;
+    /*!
+     * Number of uplinks delayed by the duty cycle restrictions
+     */
+    uint32_t DutyCycleDelays;
+    /*!
+     * Sum of the duty cycle delays [ms]
+     */
+    uint32_t DutyCycleDelayTotal;
+    /*!
+     * Longest duty cycle delay [ms]
+     */
+    uint32_t DutyCycleDelayMax;
+    /*!
+     * Longest \ref LoRaMacProcess execution time [ms]
+     */
+    uint32_t ProcessTimeMax;
+}LoRaMacPerfCounters_t;
+
 /*!
  * Global MAC layer parameters
  */
@@ -790,6 +849,10 @@ typedef struct sMcpsConfirm
      * The uplink channel related to the frame
      */
     uint32_t Channel;
+    /*!
+     * Time spent from the MCPS-Request to the radio transmission start [ms]
+     */
+    TimerTime_t TxPreparationTime;
 }McpsConfirm_t;
 
 /*!
@@ -872,6 +935,9 @@ typedef struct sMcpsIndication
  * Name                         | Request | Indication | Response | Confirm
  * ---------------------------- | :-----: | :--------: | :------: | :-----:
  * \ref MLME_JOIN               | YES     | NO         | NO       | YES
+ * \ref MLME_REJOIN_0           | YES     | NO         | NO       | YES
+ * \ref MLME_REJOIN_1           | YES     | NO         | NO       | YES
+ * \ref MLME_REJOIN_2           | YES     | NO         | NO       | YES
  * \ref MLME_LINK_CHECK         | YES     | NO         | NO       | YES
  * \ref MLME_TXCW               | YES     | NO         | NO       | YES
  * \ref MLME_SCHEDULE_UPLINK    | NO      | YES        | NO       | NO
@@ -978,6 +1044,12 @@ typedef enum eMlme
      * LoRaWAN end-device certification
      */
     MLME_BEACON_LOST,
+    /*!
+     * Initiates sending a ReJoin-request type 2
+     *
+     * LoRaWAN Specification V1.1.0, chapter 6.2.4.1
+     */
+    MLME_REJOIN_2,
 }Mlme_t;
 
 /*!
@@ -1204,6 +1276,11 @@ typedef struct sMlmeIndication
  * \ref MIB_CHANNELS_DEFAULT_TX_POWER            | YES | YES
  * \ref MIB_SYSTEM_MAX_RX_ERROR                  | YES | YES
  * \ref MIB_MIN_RX_SYMBOLS                       | YES | YES
+ * \ref MIB_RX_ERROR_ADAPTATION                  | YES | YES
+ * \ref MIB_JOIN_SCHEDULER                       | YES | YES
+ * \ref MIB_REJOIN_1_CYCLE                       | YES | YES
+ * \ref MIB_RX_EARLY_EXIT                        | YES | YES
+ * \ref MIB_MC_FCNT_DOWN_WINDOW                  | YES | YES
  * \ref MIB_BEACON_INTERVAL                      | YES | YES
  * \ref MIB_BEACON_RESERVED                      | YES | YES
  * \ref MIB_BEACON_GUARD                         | YES | YES
@@ -1220,6 +1297,7 @@ typedef struct sMlmeIndication
  * \ref MIB_DEFAULT_ANTENNA_GAIN                 | YES | YES
  * \ref MIB_NVM_CTXS                             | YES | YES
  * \ref MIB_ABP_LORAWAN_VERSION                  | YES | YES
+ * \ref MIB_PERF_COUNTERS                        | YES | YES
  *
  * The following table provides links to the function implementations of the
  * related MIB primitives:
@@ -1227,6 +1305,7 @@ typedef struct sMlmeIndication
  * Primitive        | Function
  * ---------------- | :---------------------:
  * MIB-Set          | \ref LoRaMacMibSetRequestConfirm
+ * MIB-Set          | \ref LoRaMacMibSetMany
  * MIB-Get          | \ref LoRaMacMibGetRequestConfirm
  */
 typedef enum eMib
@@ -1634,6 +1713,59 @@ typedef enum eMib
      * The allowed ranges are region specific. Please refer to \ref DR_0 to \ref DR_15 for details.
      */
      MIB_PING_SLOT_DATARATE,
+    /*!
+     * MAC performance counters
+     *
+     * MIB-Get returns a pointer to the MAC counters. MIB-Set restores the
+     * counters from the given structure, or resets them when NULL.
+     */
+    MIB_PERF_COUNTERS,
+    /*!
+     * Adaptation of the RX1 and RX2 windows timing error to the error
+     * measured on the received downlinks. The timing error never exceeds
+     * \ref MIB_SYSTEM_MAX_RX_ERROR.
+     * Default: enabled
+     *
+     * [true: adaptation enabled, false: \ref MIB_SYSTEM_MAX_RX_ERROR is used]
+     */
+    MIB_RX_ERROR_ADAPTATION,
+    /*!
+     * Join requests scheduling. The join requests are delayed by a per device
+     * jitter and by the join duty cycle of the previous request, including
+     * across power cycles when the NVM context is kept. The retries also
+     * spread their datarate below the requested one.
+     * Default: disabled
+     *
+     * [true: join requests scheduled, false: join requests sent on request]
+     */
+    MIB_JOIN_SCHEDULER,
+    /*!
+     * Period of the ReJoin-request type 1 [s]. The rejoin requests are sent
+     * at the end of a transaction once due, LoRaWAN 1.1 only.
+     * Default: 0
+     *
+     * [0: no type 1 rejoin request]
+     */
+    MIB_REJOIN_1_CYCLE,
+    /*!
+     * Early exit of the class A reception windows. The radio is put to sleep
+     * from the RX1 and RX2 radio interrupts instead of idling until the MAC
+     * processing, and RX2 is cancelled as soon as the header of a frame
+     * received in RX1 addresses the device.
+     * Default: disabled
+     *
+     * [true: early exit enabled, false: windows ended by the MAC processing]
+     */
+    MIB_RX_EARLY_EXIT,
+    /*!
+     * Out of order multicast downlink frames. A multicast frame up to 31
+     * counter values below the last received one is accepted once, instead
+     * of only frames with increasing counters.
+     * Default: disabled
+     *
+     * [true: out of order frames accepted, false: increasing counters only]
+     */
+    MIB_MC_FCNT_DOWN_WINDOW,
 }Mib_t;
 
 /*!
@@ -2051,6 +2183,42 @@ typedef union uMibParam
      * Related MIB type: \ref MIB_PING_SLOT_DATARATE
      */
     int8_t PingSlotDatarate;
+    /*!
+     * MAC performance counters
+     *
+     * Related MIB type: \ref MIB_PERF_COUNTERS
+     */
+    LoRaMacPerfCounters_t* PerfCounters;
+    /*!
+     * RX windows timing error adaptation
+     *
+     * Related MIB type: \ref MIB_RX_ERROR_ADAPTATION
+     */
+    bool RxErrorAdaptation;
+    /*!
+     * Join requests scheduling
+     *
+     * Related MIB type: \ref MIB_JOIN_SCHEDULER
+     */
+    bool JoinScheduler;
+    /*!
+     * ReJoin-request type 1 period [s]
+     *
+     * Related MIB type: \ref MIB_REJOIN_1_CYCLE
+     */
+    uint32_t Rejoin1Cycle;
+    /*!
+     * Class A reception windows early exit
+     *
+     * Related MIB type: \ref MIB_RX_EARLY_EXIT
+     */
+    bool RxEarlyExit;
+    /*!
+     * Out of order multicast downlink frames
+     *
+     * Related MIB type: \ref MIB_MC_FCNT_DOWN_WINDOW
+     */
+    bool McFCntDownWindow;
 }MibParam_t;
 
 /*!
@@ -2388,6 +2556,44 @@ LoRaMacStatus_t LoRaMacStart( void );
  */
 LoRaMacStatus_t LoRaMacStop( void );
 
+/*!
+ * \brief   Switches the active region without re-initializing the MAC layer
+ *
+ * \details The session, the keys and the frame counters are kept. The MAC
+ *          parameters are reset to the defaults of the new region, unless
+ *          the region is resumed, and all pending MAC command answers are
+ *          dropped, sticky or not. The pending requests of the end-device
+ *          are kept.
+ *
+ *          The region contexts may share their storage. To resume a region
+ *          later on, the application stores the region context of
+ *          \ref MIB_NVM_CTXS ( RegionNvmCtx, RegionNvmCtxSize ) before the
+ *          switch, and the MAC parameters returned by the switch. It
+ *          provides both when switching back, so the receive windows keep
+ *          the settings the network set in that region.
+ *
+ * \remark  The device must operate in class A.
+ *
+ * \param   [IN] region       - The region to switch to.
+ *
+ * \param   [IN] regionNvmCtx - Stored context of the region to resume. NULL
+ *                              to start from the region defaults.
+ *
+ * \param   [IN/OUT] macParams - In: stored MAC parameters of the region to
+ *                              resume, ignored when regionNvmCtx is NULL.
+ *                              Out: MAC parameters of the region left. May
+ *                              be NULL, the defaults of the new region then
+ *                              apply.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID,
+ *          \ref LORAMAC_STATUS_REGION_NOT_SUPPORTED.
+ */
+LoRaMacStatus_t LoRaMacSwitchRegion( LoRaMacRegion_t region, void* regionNvmCtx, LoRaMacParams_t* macParams );
+
 /*!
  * \brief Returns a value indicating if the MAC layer is busy or not.
  * 
@@ -2420,10 +2626,11 @@ void LoRaMacProcess( void );
  *          In case of a length error caused by the application data payload in combination
  *          with the MAC commands, the function returns \ref LORAMAC_STATUS_LENGTH_ERROR.
  *          In this case its recommended to send a frame without application data to flush
- *          the MAC commands. Otherwise the LoRaMAC will prioritize the MAC commands and
- *          if needed it will skip the application data. Please note that if MAC commands do
- *          not fit at all into the payload size on the related datarate, the LoRaMAC will
- *          automatically clip the MAC commands.
+ *          the MAC commands. Otherwise the LoRaMAC will send the MAC commands which fit
+ *          into the FOpts field by priority and request a further uplink with a
+ *          \ref MLME_SCHEDULE_UPLINK indication for the others. Please note that if MAC
+ *          commands do not fit at all into the payload size on the related datarate, the
+ *          LoRaMAC will send the remaining ones with the next frames.
  *          In case the query is valid, and the LoRaMAC is able to send the frame,
  *          the function returns \ref LORAMAC_STATUS_OK.
  */
@@ -2576,6 +2783,44 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet );
  */
 LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet );
 
+/*!
+ * \brief   LoRaMAC MIB-Set of several attributes
+ *
+ * \details Sets the attributes in order and notifies each changed NVM context
+ *          once, instead of once per attribute. The attributes are all
+ *          verified before the first one is applied: when one of them holds
+ *          an invalid value none of them is set.
+ *
+ * \code
+ * MibRequestConfirm_t mibReq[2];
+ * mibReq[0].Type = MIB_ADR;
+ * mibReq[0].Param.AdrEnable = true;
+ * mibReq[1].Type = MIB_CHANNELS_DATARATE;
+ * mibReq[1].Param.ChannelsDatarate = DR_0;
+ *
+ * if( LoRaMacMibSetMany( mibReq, 2 ) == LORAMAC_STATUS_OK )
+ * {
+ *   // LoRaMAC updated the parameters
+ * }
+ * \endcode
+ *
+ * \remark  The verification ahead of the first set only covers the plain
+ *          MAC context attributes. The keys, the channel masks, the device
+ *          class and the NVM contexts are verified when applied, and the
+ *          attributes before a failing one remain set.
+ *
+ * \param   [IN] mibSet - Array of MIB-SET-Requests to perform. Refer to \ref MibRequestConfirm_t.
+ *
+ * \param   [IN] nbMib - Number of requests.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY,
+ *          \ref LORAMAC_STATUS_SERVICE_UNKNOWN,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID.
+ */
+LoRaMacStatus_t LoRaMacMibSetMany( MibRequestConfirm_t* mibSet, uint8_t nbMib );
+
 /*!
  * \brief   LoRaMAC MLME-Request
  *
@@ -32,6 +32,11 @@ Maintainer: Miguel Luis ( Semtech ), Daniel Jaeckle ( STACKFORCE ), Johannes Bru
  */
 #define CID_FIELD_SIZE 1
 
+/*!
+ * Number of MAC command priority levels
+ */
+#define NUM_OF_PRIORITIES 4
+
 /*!
  *  Mac Commands list structure
  */
@@ -64,6 +69,10 @@ typedef struct sLoRaMacCommandsCtx
      * Size of all MAC commands serialized as buffer
      */
     size_t SerializedCmdsSize;
+    /*
+     * Set when MAC commands didn't fit into the last serialization
+     */
+    bool CmdsClipped;
 } LoRaMacCommandsCtx_t;
 
 /*!
@@ -286,6 +295,89 @@ static bool IsSticky( uint8_t cid )
     }
 }
 
+/*
+ * \brief Determines if a MAC command is sent only once per frame. A new
+ *        instance replaces the pending one.
+ *
+ * \param[IN]   cid                - MAC command identifier
+ *
+ * \retval                     - Status of the operation
+ */
+static bool IsSingleInstance( uint8_t cid )
+{
+    switch( cid )
+    {
+        case MOTE_MAC_LINK_ADR_ANS:
+        case MOTE_MAC_NEW_CHANNEL_ANS:
+        case MOTE_MAC_DL_CHANNEL_ANS:
+            // One answer per request
+            return false;
+        default:
+            return true;
+    }
+}
+
+/*
+ * \brief Returns the serialization priority of a MAC command, 0 is the
+ *        highest priority
+ *
+ * \param[IN]   cid                - MAC command identifier
+ *
+ * \retval                     - Priority
+ */
+static uint8_t GetPriority( uint8_t cid )
+{
+    switch( cid )
+    {
+        case MOTE_MAC_LINK_ADR_ANS:
+        case MOTE_MAC_RX_PARAM_SETUP_ANS:
+        case MOTE_MAC_RX_TIMING_SETUP_ANS:
+        case MOTE_MAC_DL_CHANNEL_ANS:
+            // The network repeats the requests until it gets the answers
+            return 0;
+        case MOTE_MAC_DUTY_CYCLE_ANS:
+        case MOTE_MAC_NEW_CHANNEL_ANS:
+        case MOTE_MAC_TX_PARAM_SETUP_ANS:
+        case MOTE_MAC_REJOIN_PARAM_ANS:
+        case MOTE_MAC_PING_SLOT_FREQ_ANS:
+        case MOTE_MAC_BEACON_FREQ_ANS:
+            return 1;
+        case MOTE_MAC_DEV_STATUS_ANS:
+            return 2;
+        default:
+            // Requests of the end-device
+            return 3;
+    }
+}
+
+/*
+ * \brief Determines if a MAC command is an answer to a network request.
+ *
+ * \param[IN]   cid                - MAC command identifier
+ *
+ * \retval                     - Status of the operation
+ */
+static bool IsAnswer( uint8_t cid )
+{
+    switch( cid )
+    {
+        case MOTE_MAC_LINK_ADR_ANS:
+        case MOTE_MAC_DUTY_CYCLE_ANS:
+        case MOTE_MAC_RX_PARAM_SETUP_ANS:
+        case MOTE_MAC_DEV_STATUS_ANS:
+        case MOTE_MAC_NEW_CHANNEL_ANS:
+        case MOTE_MAC_RX_TIMING_SETUP_ANS:
+        case MOTE_MAC_TX_PARAM_SETUP_ANS:
+        case MOTE_MAC_DL_CHANNEL_ANS:
+        case MOTE_MAC_REJOIN_PARAM_ANS:
+        case MOTE_MAC_PING_SLOT_FREQ_ANS:
+        case MOTE_MAC_BEACON_FREQ_ANS:
+            return true;
+        default:
+            return false;
+    }
+}
+
 /*
  * \brief Wrapper function for the NvmCtx
  */
@@ -338,6 +430,16 @@ LoRaMacCommandStatus_t LoRaMacCommandsAddCmd( uint8_t cid, uint8_t* payload, siz
     }
     MacCommand_t* newCmd;
 
+    // Replace the pending instance
+    if( ( IsSingleInstance( cid ) == true ) &&
+        ( LoRaMacCommandsGetCmd( cid, &newCmd ) == LORAMAC_COMMANDS_SUCCESS ) &&
+        ( newCmd->PayloadSize == payloadSize ) )
+    {
+        memcpy1( ( uint8_t* )newCmd->Payload, payload, payloadSize );
+        NvmCtxCallback( );
+        return LORAMAC_COMMANDS_SUCCESS;
+    }
+
     // Allocate a memory slot
     newCmd = MallocNewMacCommandSlot( );
 
@@ -426,7 +528,7 @@ LoRaMacCommandStatus_t LoRaMacCommandsRemoveNoneStickyCmds( void )
     // Loop through all elements
     while( curElement != NULL )
     {
-        if( curElement->IsSticky == false )
+        if( ( curElement->IsSticky == false ) && ( curElement->IsSerialized == true ) )
         {
             nexElement = curElement->Next;
             LoRaMacCommandsRemoveCmd( curElement );
@@ -455,7 +557,32 @@ LoRaMacCommandStatus_t LoRaMacCommandsRemoveStickyAnsCmds( void )
     while( curElement != NULL )
     {
         nexElement = curElement->Next;
-        if( IsSticky( curElement->CID ) == true )
+        // Answers clipped from the last frame were never sent, keep them
+        if( ( IsSticky( curElement->CID ) == true ) && ( curElement->IsSerialized == true ) )
+        {
+            LoRaMacCommandsRemoveCmd( curElement );
+        }
+        curElement = nexElement;
+    }
+
+    NvmCtxCallback( );
+
+    return LORAMAC_COMMANDS_SUCCESS;
+}
+
+LoRaMacCommandStatus_t LoRaMacCommandsRemoveAnsCmds( void )
+{
+    MacCommand_t* curElement;
+    MacCommand_t* nexElement;
+
+    // Start at the head of the list
+    curElement = NvmCtx.MacCommandList.First;
+
+    // Loop through all elements
+    while( curElement != NULL )
+    {
+        nexElement = curElement->Next;
+        if( IsAnswer( curElement->CID ) == true )
         {
             LoRaMacCommandsRemoveCmd( curElement );
         }
@@ -484,22 +611,64 @@ LoRaMacCommandStatus_t LoRaMacCommandsSerializeCmds( size_t availableSize, size_
         return LORAMAC_COMMANDS_ERROR_NPE;
     }
     MacCommand_t* curElement;
+    size_t itr = 0;
+
+    NvmCtx.CmdsClipped = false;
+    for( curElement = NvmCtx.MacCommandList.First; curElement != NULL; curElement = curElement->Next )
+    {
+        curElement->IsSerialized = false;
+    }
+
+    // Loop through all elements, once per priority level
+    for( uint8_t priority = 0; priority < NUM_OF_PRIORITIES; priority++ )
+    {
+        for( curElement = NvmCtx.MacCommandList.First; curElement != NULL; curElement = curElement->Next )
+        {
+            if( GetPriority( curElement->CID ) != priority )
+            {
+                continue;
+            }
+            // If the MAC command still fits into the buffer, add it. Otherwise
+            // keep it for a later frame, a smaller one may still fit.
+            if( ( availableSize - itr ) >= ( CID_FIELD_SIZE + curElement->PayloadSize ) )
+            {
+                buffer[itr++] = curElement->CID;
+                memcpy1( &buffer[itr], curElement->Payload, curElement->PayloadSize );
+                itr = itr + curElement->PayloadSize;
+                curElement->IsSerialized = true;
+            }
+            else
+            {
+                NvmCtx.CmdsClipped = true;
+            }
+        }
+    }
+    *effectiveSize = itr;
+
+    NvmCtxCallback( );
+
+    return LORAMAC_COMMANDS_SUCCESS;
+}
+
+LoRaMacCommandStatus_t LoRaMacCommandsStickyCmdsPending( bool* cmdsPending )
+{
+    if( cmdsPending == NULL )
+    {
+        return LORAMAC_COMMANDS_ERROR_NPE;
+    }
+    MacCommand_t* curElement;
     curElement = NvmCtx.MacCommandList.First;
-    uint8_t itr = 0;
+
+    *cmdsPending = false;
 
     // Loop through all elements
     while( curElement != NULL )
     {
-        // If the next MAC command still fits into the buffer, add it.
-        if( ( availableSize - itr ) >= ( CID_FIELD_SIZE + curElement->PayloadSize ) )
-        {
-            buffer[itr++] = curElement->CID;
-            memcpy1( &buffer[itr], curElement->Payload, curElement->PayloadSize );
-            itr = itr + curElement->PayloadSize;
-        }
-        else
+        if( curElement->IsSticky == true )
         {
-            break;
+            // Found one sticky MAC command
+            *cmdsPending = true;
+            return LORAMAC_COMMANDS_SUCCESS;
         }
         curElement = curElement->Next;
     }
@@ -507,7 +676,7 @@ LoRaMacCommandStatus_t LoRaMacCommandsSerializeCmds( size_t availableSize, size_
     return LORAMAC_COMMANDS_SUCCESS;
 }
 
-LoRaMacCommandStatus_t LoRaMacCommandsStickyCmdsPending( bool* cmdsPending )
+LoRaMacCommandStatus_t LoRaMacCommandsClippedCmdsPending( bool* cmdsPending )
 {
     if( cmdsPending == NULL )
     {
@@ -518,12 +687,17 @@ LoRaMacCommandStatus_t LoRaMacCommandsStickyCmdsPending( bool* cmdsPending )
 
     *cmdsPending = false;
 
+    if( NvmCtx.CmdsClipped == false )
+    {
+        return LORAMAC_COMMANDS_SUCCESS;
+    }
+
     // Loop through all elements
     while( curElement != NULL )
     {
-        if( curElement->IsSticky == true )
+        if( curElement->IsSerialized == false )
         {
-            // Found one sticky MAC command
+            // Found one MAC command left over
             *cmdsPending = true;
             return LORAMAC_COMMANDS_SUCCESS;
         }
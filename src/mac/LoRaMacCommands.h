@@ -72,6 +72,10 @@ struct sMacCommand
      * Indicates if it's a sticky MAC command
      */
     bool IsSticky;
+    /*!
+     * Indicates if the MAC command has been serialized for the last frame
+     */
+    bool IsSerialized;
 };
 
 /*!
@@ -142,6 +146,9 @@ void* LoRaMacCommandsGetNvmCtx( size_t* commandsNvmCtxSize );
 /*!
  * \brief Adds a new MAC command to be sent.
  *
+ * \remark A MAC command which is only answered once replaces the pending one
+ *         with the same CID.
+ *
  * \param[IN]   cid                - MAC command identifier
  * \param[IN]   payload            - MAC command payload containing parameters
  * \param[IN]   payloadSize        - Size of MAC command payload
@@ -170,19 +177,27 @@ LoRaMacCommandStatus_t LoRaMacCommandsRemoveCmd( MacCommand_t* macCmd );
 LoRaMacCommandStatus_t LoRaMacCommandsGetCmd( uint8_t cid, MacCommand_t** macCmd );
 
 /*!
- * \brief Remove all none sticky MAC commands.
+ * \brief Remove all none sticky MAC commands serialized for the last frame.
  *
  * \retval                     - Status of the operation
  */
 LoRaMacCommandStatus_t LoRaMacCommandsRemoveNoneStickyCmds( void );
 
 /*!
- * \brief Remove all sticky answer MAC commands.
+ * \brief Remove all sticky answer MAC commands serialized for the last frame.
  *
  * \retval                     - Status of the operation
  */
 LoRaMacCommandStatus_t LoRaMacCommandsRemoveStickyAnsCmds( void );
 
+/*!
+ * \brief Remove all answer MAC commands, sent or not. The requests of the
+ *        end-device are kept.
+ *
+ * \retval                     - Status of the operation
+ */
+LoRaMacCommandStatus_t LoRaMacCommandsRemoveAnsCmds( void );
+
 /*!
  * \brief Get size of all MAC commands serialized as buffer
  *
@@ -195,6 +210,9 @@ LoRaMacCommandStatus_t LoRaMacCommandsGetSizeSerializedCmds( size_t* size );
 /*!
  * \brief Get as many as possible MAC commands serialized
  *
+ * \details The MAC commands are serialized by decreasing priority. The ones
+ *          which don't fit are kept for a later frame.
+ *
  * \param[IN]   availableSize      - Available size of memory for MAC commands
  * \param[out]  effectiveSize      - Size of memory which was effectively used for serializing.
  * \param[out]  buffer             - Destination data buffer
@@ -212,6 +230,15 @@ LoRaMacCommandStatus_t LoRaMacCommandsSerializeCmds( size_t availableSize, size_
  */
 LoRaMacCommandStatus_t LoRaMacCommandsStickyCmdsPending( bool* cmdsPending );
 
+/*!
+ * \brief Determines if MAC commands didn't fit into the last serialization.
+ *
+ * \param[IN]   cmdsPending        - Indicates if there are MAC commands left over.
+ *
+ * \retval                     - Status of the operation
+ */
+LoRaMacCommandStatus_t LoRaMacCommandsClippedCmdsPending( bool* cmdsPending );
+
 /*! \} addtogroup LORAMAC */
 
 #endif // __LORAMAC_COMMANDS_H__
@@ -56,6 +56,11 @@
  */
 #define FCNT_DOWN_INITAL_VALUE          0xFFFFFFFF
 
+/*
+ * Number of multicast downlink frames tracked below the last received counter
+ */
+#define MC_FCNT_DOWN_WINDOW_SIZE        32
+
 /*
  * Frame direction definition for uplink communications
  */
@@ -181,6 +186,15 @@ typedef struct sLoRaMacCryptoNvmCtx
      * RJcount1 is a counter incremented with every Rejoin request Type 1 frame transmitted.
      */
     uint16_t RJcount1;
+    /*
+     * Enables the acceptance of out of order multicast downlink frames
+     */
+    bool McFCntDownWindowOn;
+    /*
+     * Received multicast downlink frames, per multicast group. Bit N is set
+     * when the frame of counter McFCntDownX - N has been received.
+     */
+    uint32_t McFCntDownWindow[4];
     /*
      * LastDownFCnt stores the information which frame counter was used to unsecure the last frame.
      * This information is needed to compute ConfFCnt in B1 block for the MIC.
@@ -839,6 +853,23 @@ static LoRaMacCryptoStatus_t GetLastFcntDown( FCntIdentifier_t fCntID, uint32_t*
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
+/*
+ * Gets the received frames window of a multicast downlink counter
+ *
+ * \param[IN]     fCntID       - Frame counter identifier
+ *
+ * \retval                     - Window, NULL when out of order frames are not accepted
+ */
+static uint32_t* GetMcFCntDownWindow( FCntIdentifier_t fCntID )
+{
+    if( ( CryptoCtx.NvmCtx->McFCntDownWindowOn == false ) ||
+        ( fCntID < MC_FCNT_DOWN_0 ) || ( fCntID > MC_FCNT_DOWN_3 ) )
+    {
+        return NULL;
+    }
+    return &CryptoCtx.NvmCtx->McFCntDownWindow[fCntID - MC_FCNT_DOWN_0];
+}
+
 /*
  * Checks the downlink counter value
  *
@@ -850,6 +881,8 @@ static LoRaMacCryptoStatus_t GetLastFcntDown( FCntIdentifier_t fCntID, uint32_t*
 static bool CheckFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
 {
     uint32_t lastDown = 0;
+    uint32_t* window = GetMcFCntDownWindow( fCntID );
+
     if( GetLastFcntDown( fCntID, &lastDown ) != LORAMAC_CRYPTO_SUCCESS )
     {
         return false;
@@ -860,6 +893,11 @@ static bool CheckFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
     {
         return true;
     }
+    else if( ( window != NULL ) && ( ( lastDown - currentDown ) < MC_FCNT_DOWN_WINDOW_SIZE ) )
+    {
+        // Out of order multicast frame, accepted once
+        return ( *window & ( 1UL << ( lastDown - currentDown ) ) ) == 0;
+    }
     else
     {
         return false;
@@ -876,6 +914,28 @@ static bool CheckFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
  */
 static void UpdateFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
 {
+    uint32_t lastDown = 0;
+    uint32_t* window = GetMcFCntDownWindow( fCntID );
+
+    if( ( window != NULL ) && ( GetLastFcntDown( fCntID, &lastDown ) == LORAMAC_CRYPTO_SUCCESS ) )
+    {
+        if( lastDown == FCNT_DOWN_INITAL_VALUE )
+        {
+            *window = 1;
+        }
+        else if( currentDown > lastDown )
+        {
+            *window = ( ( currentDown - lastDown ) < MC_FCNT_DOWN_WINDOW_SIZE ) ? ( *window << ( currentDown - lastDown ) ) | 1 : 1;
+        }
+        else
+        {
+            // Out of order frame, the counter is kept
+            *window |= 1UL << ( lastDown - currentDown );
+            CryptoCtx.EventCryptoNvmCtxChanged( );
+            return;
+        }
+    }
+
     switch( fCntID )
     {
         case N_FCNT_DOWN:
@@ -921,6 +981,7 @@ static void ResetFCnts( void )
     CryptoCtx.NvmCtx->FCntList.McFCntDown1 = FCNT_DOWN_INITAL_VALUE;
     CryptoCtx.NvmCtx->FCntList.McFCntDown2 = FCNT_DOWN_INITAL_VALUE;
     CryptoCtx.NvmCtx->FCntList.McFCntDown3 = FCNT_DOWN_INITAL_VALUE;
+    memset1( ( uint8_t* )CryptoCtx.NvmCtx->McFCntDownWindow, 0, sizeof( CryptoCtx.NvmCtx->McFCntDownWindow ) );
 
     CryptoCtx.EventCryptoNvmCtxChanged( );
 }
@@ -973,6 +1034,42 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSetLrWanVersion( Version_t version )
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
+LoRaMacCryptoStatus_t LoRaMacCryptoSetMcFCntDownWindow( bool enable )
+{
+    uint32_t lastDown = 0;
+
+    if( enable != CryptoCtx.NvmCtx->McFCntDownWindowOn )
+    {
+        CryptoCtx.NvmCtx->McFCntDownWindowOn = enable;
+        memset1( ( uint8_t* )CryptoCtx.NvmCtx->McFCntDownWindow, 0, sizeof( CryptoCtx.NvmCtx->McFCntDownWindow ) );
+        if( enable == true )
+        {
+            // The frames received before the window was enabled are unknown.
+            // Mark the whole window as received to not accept them again.
+            for( uint8_t i = 0; i < 4; i++ )
+            {
+                if( ( GetLastFcntDown( ( FCntIdentifier_t )( MC_FCNT_DOWN_0 + i ), &lastDown ) == LORAMAC_CRYPTO_SUCCESS ) &&
+                    ( lastDown != FCNT_DOWN_INITAL_VALUE ) )
+                {
+                    CryptoCtx.NvmCtx->McFCntDownWindow[i] = 0xFFFFFFFF;
+                }
+            }
+        }
+        CryptoCtx.EventCryptoNvmCtxChanged( );
+    }
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
+LoRaMacCryptoStatus_t LoRaMacCryptoGetMcFCntDownWindow( bool* enabled )
+{
+    if( enabled == NULL )
+    {
+        return LORAMAC_CRYPTO_ERROR_NPE;
+    }
+    *enabled = CryptoCtx.NvmCtx->McFCntDownWindowOn;
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
 LoRaMacCryptoStatus_t LoRaMacCryptoRestoreNvmCtx( void* cryptoNvmCtx )
 {
     // Restore module context
@@ -1009,6 +1106,7 @@ LoRaMacCryptoStatus_t LoRaMacCryptoGetFCntDown( FCntIdentifier_t fCntID, uint16_
 {
     uint32_t lastDown = 0;
     int32_t fCntDiff = 0;
+    uint16_t lateFCnt = 0;
     LoRaMacCryptoStatus_t cryptoStatus = LORAMAC_CRYPTO_ERROR;
 
     if( currentDown == NULL )
@@ -1032,6 +1130,18 @@ LoRaMacCryptoStatus_t LoRaMacCryptoGetFCntDown( FCntIdentifier_t fCntID, uint16_
         // Add difference, consider roll-over
         fCntDiff = ( int32_t )( ( int64_t )frameFcnt - ( int64_t )( lastDown & 0x0000FFFF ) );
 
+        if( GetMcFCntDownWindow( fCntID ) != NULL )
+        {
+            // Out of order multicast frames within the window, before or after
+            // a roll-over of one uint16_t
+            lateFCnt = ( uint16_t )( ( lastDown & 0x0000FFFF ) - frameFcnt );
+            if( ( lateFCnt > 0 ) && ( lateFCnt < MC_FCNT_DOWN_WINDOW_SIZE ) && ( lateFCnt <= lastDown ) )
+            {
+                *currentDown = lastDown - lateFCnt;
+                return LORAMAC_CRYPTO_SUCCESS;
+            }
+        }
+
         if( fCntDiff > 0 )
         {  // Positive difference
             *currentDown = lastDown + fCntDiff;
@@ -1161,6 +1271,8 @@ LoRaMacCryptoStatus_t LoRaMacCryptoPrepareReJoinType1( LoRaMacMessageReJoinType1
         return LORAMAC_CRYPTO_ERROR_RJCOUNT1_OVERFLOW;
     }
 
+    macMsg->RJcount1 = CryptoCtx.NvmCtx->RJcount1;
+
     // Serialize message
     if( LoRaMacSerializerReJoinType1( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
     {
@@ -1200,6 +1312,8 @@ LoRaMacCryptoStatus_t LoRaMacCryptoPrepareReJoinType0or2( LoRaMacMessageReJoinTy
         return LORAMAC_CRYPTO_FAIL_RJCOUNT0_OVERFLOW;
     }
 
+    macMsg->RJcount0 = CryptoCtx.RJcount0;
+
     // Serialize message
     if( LoRaMacSerializerReJoinType0or2( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
     {
@@ -1518,11 +1632,11 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
         }
     }
 
-    // Re-serialize message to add the MIC
-    if( LoRaMacSerializerData( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
-    {
-        return LORAMAC_CRYPTO_ERROR_SERIALIZER;
-    }
+    // Add the MIC to the serialized message
+    macMsg->Buffer[macMsg->BufSize - 4] = macMsg->MIC & 0xFF;
+    macMsg->Buffer[macMsg->BufSize - 3] = ( macMsg->MIC >> 8 ) & 0xFF;
+    macMsg->Buffer[macMsg->BufSize - 2] = ( macMsg->MIC >> 16 ) & 0xFF;
+    macMsg->Buffer[macMsg->BufSize - 1] = ( macMsg->MIC >> 24 ) & 0xFF;
 
     return LORAMAC_CRYPTO_SUCCESS;
 }
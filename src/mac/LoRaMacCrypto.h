@@ -160,6 +160,25 @@ LoRaMacCryptoStatus_t LoRaMacCryptoInit( LoRaMacCryptoNvmEvent cryptoNvmCtxChang
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoSetLrWanVersion( Version_t version );
 
+/*!
+ * Enables the acceptance of out of order multicast downlink frames. A frame
+ * up to 31 counter values below the last received one is accepted once.
+ *
+ * \param[IN]     enable              - Out of order multicast frames accepted
+ *
+ * \retval                            - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoSetMcFCntDownWindow( bool enable );
+
+/*!
+ * Returns if out of order multicast downlink frames are accepted.
+ *
+ * \param[OUT]    enabled             - Out of order multicast frames accepted
+ *
+ * \retval                            - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoGetMcFCntDownWindow( bool* enabled );
+
 /*!
  * Restores the internal nvm context from passed pointer.
  *
@@ -0,0 +1,172 @@
+/*!
+ * \file      LoRaMacJoinScheduler.c
+ *
+ * \brief     LoRa MAC join request scheduler
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "utilities.h"
+#include "systime.h"
+#include "region/RegionCommon.h"
+#include "LoRaMacJoinScheduler.h"
+
+/*!
+ * \brief Computes the per device pseudo random value of a join attempt
+ *        (FNV-1a hash of the DevEUI and the attempt number)
+ *
+ * \param [IN] devEui  Device EUI
+ * \param [IN] attempt Attempt number
+ *
+ * \retval hash Pseudo random value
+ */
+static uint32_t JoinSchedulerHash( const uint8_t* devEui, uint16_t attempt )
+{
+    uint32_t hash = 2166136261UL;
+
+    for( uint8_t i = 0; i < 8; i++ )
+    {
+        hash = ( hash ^ devEui[i] ) * 16777619UL;
+    }
+    hash = ( hash ^ ( attempt & 0xFF ) ) * 16777619UL;
+    hash = ( hash ^ ( attempt >> 8 ) ) * 16777619UL;
+
+    // Final avalanche, consecutive attempts must give unrelated values
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6DUL;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+/*!
+ * \brief Draws the jitter of a join attempt
+ *
+ * \param [IN] devEui  Device EUI
+ * \param [IN] attempt Attempt number
+ *
+ * \retval jitter Jitter [s]
+ */
+static uint32_t JoinSchedulerGetJitter( const uint8_t* devEui, uint16_t attempt )
+{
+    uint32_t window = JOIN_SCHEDULER_WINDOW_MAX;
+
+    if( attempt < 16 )
+    {
+        window = MIN( ( uint32_t )JOIN_SCHEDULER_WINDOW_MIN << attempt, JOIN_SCHEDULER_WINDOW_MAX );
+    }
+    return JoinSchedulerHash( devEui, attempt ) % window;
+}
+
+/*!
+ * \brief Adds the time elapsed since the last update to the join procedure
+ *        time. The time base restarts at boot, the time before a restart is
+ *        not counted again.
+ *
+ * \param [IN/OUT] ctx Join scheduler context
+ * \param [IN]     now Current MCU time [s]
+ */
+static void JoinSchedulerUpdateTime( JoinSchedulerNvmCtx_t* ctx, uint32_t now )
+{
+    if( ( ctx->Started == true ) && ( now >= ctx->LastTime ) )
+    {
+        ctx->ElapsedTime += now - ctx->LastTime;
+    }
+    ctx->LastTime = now;
+}
+
+void LoRaMacJoinSchedulerInit( JoinSchedulerNvmCtx_t* ctx, bool enabled )
+{
+    memset1( ( uint8_t* )ctx, 0, sizeof( JoinSchedulerNvmCtx_t ) );
+    ctx->Enabled = enabled;
+}
+
+void LoRaMacJoinSchedulerRestore( JoinSchedulerNvmCtx_t* ctx, uint32_t now )
+{
+    ctx->LastTime = now;
+}
+
+uint32_t LoRaMacJoinSchedulerGetDelay( JoinSchedulerNvmCtx_t* ctx, uint32_t now, const uint8_t* devEui )
+{
+    if( ctx->Enabled == false )
+    {
+        return 0;
+    }
+
+    JoinSchedulerUpdateTime( ctx, now );
+    if( ctx->Started == false )
+    {
+        ctx->Started = true;
+        ctx->ElapsedTime = 0;
+        ctx->NextAttemptTime = JoinSchedulerGetJitter( devEui, ctx->Attempts );
+    }
+
+    if( ctx->NextAttemptTime > ctx->ElapsedTime )
+    {
+        return ( ctx->NextAttemptTime - ctx->ElapsedTime ) * 1000;
+    }
+    return 0;
+}
+
+int8_t LoRaMacJoinSchedulerGetDatarate( JoinSchedulerNvmCtx_t* ctx, const uint8_t* devEui, int8_t datarate, int8_t minDatarate )
+{
+    int8_t offset;
+
+    // The first attempt uses the requested datarate
+    if( ( ctx->Enabled == false ) || ( ctx->Attempts == 0 ) )
+    {
+        return datarate;
+    }
+    offset = ( int8_t )( ( JoinSchedulerHash( devEui, ctx->Attempts ) >> 16 ) % ( JOIN_SCHEDULER_DR_SPREAD + 1 ) );
+    return MAX( datarate - offset, minDatarate );
+}
+
+uint32_t LoRaMacJoinSchedulerGetElapsedTime( JoinSchedulerNvmCtx_t* ctx, uint32_t now )
+{
+    JoinSchedulerUpdateTime( ctx, now );
+    return ctx->ElapsedTime;
+}
+
+void LoRaMacJoinSchedulerOnJoinRequest( JoinSchedulerNvmCtx_t* ctx, uint32_t now, const uint8_t* devEui, uint32_t timeOnAir )
+{
+    SysTime_t elapsedTime = { .Seconds = 0, .SubSeconds = 0 };
+    uint32_t timeOff;
+
+    if( ctx->Enabled == false )
+    {
+        return;
+    }
+
+    JoinSchedulerUpdateTime( ctx, now );
+    if( ctx->Started == false )
+    {
+        ctx->Started = true;
+        ctx->ElapsedTime = 0;
+    }
+    if( ctx->Attempts < UINT16_MAX )
+    {
+        ctx->Attempts++;
+    }
+
+    // Join duty cycle time-off of the request, rounded up to the second
+    elapsedTime.Seconds = ctx->ElapsedTime;
+    timeOff = ( ( timeOnAir * ( RegionCommonGetJoinDc( elapsedTime ) - 1 ) ) + 999 ) / 1000;
+
+    ctx->NextAttemptTime = ctx->ElapsedTime + timeOff + JoinSchedulerGetJitter( devEui, ctx->Attempts );
+}
+
+void LoRaMacJoinSchedulerOnJoinAccept( JoinSchedulerNvmCtx_t* ctx )
+{
+    LoRaMacJoinSchedulerInit( ctx, ctx->Enabled );
+}
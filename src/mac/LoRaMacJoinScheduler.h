@@ -0,0 +1,169 @@
+/*!
+ * \file      LoRaMacJoinScheduler.h
+ *
+ * \brief     LoRa MAC join request scheduler
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  LORAMACJOINSCHEDULER LoRa MAC join request scheduler
+ *            Spreads the join requests of a fleet of devices over time, so
+ *            that the devices restarted by a power or gateway outage don't
+ *            retry in lock-step.
+ *
+ *            Each join request is delayed by a jitter drawn in a window
+ *            doubling at each attempt, from JOIN_SCHEDULER_WINDOW_MIN up to
+ *            JOIN_SCHEDULER_WINDOW_MAX seconds. The jitter is derived from
+ *            the DevEUI and the attempt number, so that it differs between
+ *            devices but is reproducible on a device. Attempts following a
+ *            join request are additionally delayed by the join duty cycle
+ *            (RegionCommonGetJoinDc) time-off of that request.
+ *            The datarate of the attempts is spread over the requested
+ *            datarate and the JOIN_SCHEDULER_DR_SPREAD datarates below it.
+ *
+ *            The context is part of the LoRaMac NVM context. The scheduler
+ *            accumulates the time elapsed since the start of the join
+ *            procedure, the next attempt time is relative to it. The
+ *            attempts history and the pending time-off thus survive a power
+ *            cycle, the time spent powered off is not counted. The current
+ *            time passed to the functions is SysTimeGetMcuTime seconds, it
+ *            does not jump when the network sets the system time.
+ * \{
+ */
+#ifndef __LORAMAC_JOIN_SCHEDULER_H__
+#define __LORAMAC_JOIN_SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * Jitter window of the first join request [s]
+ */
+#define JOIN_SCHEDULER_WINDOW_MIN                   16
+
+/*!
+ * Maximum jitter window [s]
+ */
+#define JOIN_SCHEDULER_WINDOW_MAX                   1024
+
+/*!
+ * Number of datarates below the requested one used by the attempts
+ */
+#define JOIN_SCHEDULER_DR_SPREAD                    1
+
+/*!
+ * Join scheduler context
+ */
+typedef struct sJoinSchedulerNvmCtx
+{
+    /*!
+     * Set to true if the join requests are scheduled
+     */
+    bool Enabled;
+    /*!
+     * Set to true once the first join request of the procedure is scheduled
+     */
+    bool Started;
+    /*!
+     * Number of join requests sent since the last join accept
+     */
+    uint16_t Attempts;
+    /*!
+     * Time elapsed since the start of the join procedure, up to LastTime [s]
+     */
+    uint32_t ElapsedTime;
+    /*!
+     * MCU time of the last ElapsedTime update. Restarts at boot [s]
+     */
+    uint32_t LastTime;
+    /*!
+     * Earliest time of the next join request, relative to the start of the
+     * join procedure [s]
+     */
+    uint32_t NextAttemptTime;
+}JoinSchedulerNvmCtx_t;
+
+/*!
+ * \brief Initializes the context and drops the attempts history
+ *
+ * \param [OUT] ctx     Join scheduler context
+ * \param [IN]  enabled Enables the join requests scheduling
+ */
+void LoRaMacJoinSchedulerInit( JoinSchedulerNvmCtx_t* ctx, bool enabled );
+
+/*!
+ * \brief Resumes the join procedure once the context has been restored after
+ *        a power cycle. The time spent powered off is not counted.
+ *
+ * \param [IN/OUT] ctx Join scheduler context
+ * \param [IN]     now Current MCU time [s]
+ */
+void LoRaMacJoinSchedulerRestore( JoinSchedulerNvmCtx_t* ctx, uint32_t now );
+
+/*!
+ * \brief Gets the delay to wait before sending the next join request. The
+ *        first call of a join procedure schedules its first request.
+ *
+ * \param [IN/OUT] ctx    Join scheduler context
+ * \param [IN]     now    Current MCU time [s]
+ * \param [IN]     devEui Device EUI
+ *
+ * \retval delay Delay before the join request [ms], 0 to send it now
+ */
+uint32_t LoRaMacJoinSchedulerGetDelay( JoinSchedulerNvmCtx_t* ctx, uint32_t now, const uint8_t* devEui );
+
+/*!
+ * \brief Gets the datarate of the next join request
+ *
+ * \param [IN] ctx         Join scheduler context
+ * \param [IN] devEui      Device EUI
+ * \param [IN] datarate    Requested datarate
+ * \param [IN] minDatarate Minimum uplink datarate of the region
+ *
+ * \retval datarate Datarate of the join request
+ */
+int8_t LoRaMacJoinSchedulerGetDatarate( JoinSchedulerNvmCtx_t* ctx, const uint8_t* devEui, int8_t datarate, int8_t minDatarate );
+
+/*!
+ * \brief Gets the time elapsed since the start of the join procedure, used
+ *        to select the join duty cycle
+ *
+ * \param [IN] ctx Join scheduler context
+ * \param [IN] now Current MCU time [s]
+ *
+ * \retval elapsedTime Elapsed time [s]
+ */
+uint32_t LoRaMacJoinSchedulerGetElapsedTime( JoinSchedulerNvmCtx_t* ctx, uint32_t now );
+
+/*!
+ * \brief Schedules the next join request once a join request has been sent
+ *
+ * \param [IN/OUT] ctx       Join scheduler context
+ * \param [IN]     now       Current MCU time [s]
+ * \param [IN]     devEui    Device EUI
+ * \param [IN]     timeOnAir Time on air of the join request [ms]
+ */
+void LoRaMacJoinSchedulerOnJoinRequest( JoinSchedulerNvmCtx_t* ctx, uint32_t now, const uint8_t* devEui, uint32_t timeOnAir );
+
+/*!
+ * \brief Ends the join procedure once the join accept has been received
+ *
+ * \param [IN/OUT] ctx Join scheduler context
+ */
+void LoRaMacJoinSchedulerOnJoinAccept( JoinSchedulerNvmCtx_t* ctx );
+
+/*! \} defgroup LORAMACJOINSCHEDULER */
+
+#endif // __LORAMAC_JOIN_SCHEDULER_H__
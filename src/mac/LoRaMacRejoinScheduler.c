@@ -0,0 +1,147 @@
+/*!
+ * \file      LoRaMacRejoinScheduler.c
+ *
+ * \brief     LoRa MAC rejoin request scheduler
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "utilities.h"
+#include "LoRaMacRejoinScheduler.h"
+
+/*!
+ * \brief Computes the time elapsed since a reference. A reference ahead of
+ *        the current time, the time base having restarted, is rebased on the
+ *        current time and restarts the period.
+ *
+ * \param [IN]     now  Current MCU time [s]
+ * \param [IN/OUT] time Reference time [s]
+ *
+ * \retval elapsedTime Elapsed time [s]
+ */
+static uint32_t RejoinSchedulerGetElapsedTime( uint32_t now, uint32_t* time )
+{
+    if( now < *time )
+    {
+        *time = now;
+    }
+    return now - *time;
+}
+
+void LoRaMacRejoinSchedulerInit( RejoinSchedulerNvmCtx_t* ctx, uint32_t now )
+{
+    memset1( ( uint8_t* )ctx, 0, sizeof( RejoinSchedulerNvmCtx_t ) );
+    ctx->Rejoin0Time = now;
+    ctx->Rejoin1Time = now;
+}
+
+void LoRaMacRejoinSchedulerRestore( RejoinSchedulerNvmCtx_t* ctx, uint32_t now )
+{
+    ctx->Rejoin0Time = now;
+    ctx->Rejoin1Time = now;
+    if( ctx->ForceRejoinCount > 0 )
+    {
+        // The time of the last forced rejoin is unknown, keep the spacing
+        ctx->ForceRejoinTime = now + ( 32UL << ctx->ForceRejoinPeriod );
+    }
+}
+
+void LoRaMacRejoinSchedulerOnSessionStart( RejoinSchedulerNvmCtx_t* ctx, uint32_t now )
+{
+    ctx->Rejoin0Enabled = false;
+    ctx->Rejoin0UplinkCounter = 0;
+    ctx->Rejoin0Time = now;
+    ctx->Rejoin1Time = now;
+    ctx->ForceRejoinCount = 0;
+}
+
+void LoRaMacRejoinSchedulerOnUplink( RejoinSchedulerNvmCtx_t* ctx )
+{
+    if( ( ctx->Rejoin0Enabled == true ) && ( ctx->Rejoin0UplinkCounter < UINT32_MAX ) )
+    {
+        ctx->Rejoin0UplinkCounter++;
+    }
+}
+
+bool LoRaMacRejoinSchedulerSetup( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, uint8_t maxTimeN, uint8_t maxCountN )
+{
+    ctx->Rejoin0Enabled = true;
+    ctx->Rejoin0MaxTimeN = maxTimeN & 0x0F;
+    ctx->Rejoin0MaxCountN = maxCountN & 0x0F;
+    ctx->Rejoin0UplinkCounter = 0;
+    ctx->Rejoin0Time = now;
+
+    // The MCU time is always available
+    return true;
+}
+
+void LoRaMacRejoinSchedulerForce( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, JoinReqIdentifier_t type, uint8_t period, uint8_t maxRetries, int8_t datarate )
+{
+    ctx->ForceRejoinCount = ( maxRetries & 0x07 ) + 1;
+    ctx->ForceRejoinType = type;
+    ctx->ForceRejoinPeriod = period & 0x07;
+    ctx->ForceRejoinDatarate = datarate;
+    ctx->ForceRejoinTime = now;
+}
+
+bool LoRaMacRejoinSchedulerGetPending( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, JoinReqIdentifier_t* type, int8_t* datarate )
+{
+    if( ( ctx->ForceRejoinCount > 0 ) && ( now >= ctx->ForceRejoinTime ) )
+    {
+        *type = ( JoinReqIdentifier_t )ctx->ForceRejoinType;
+        *datarate = ctx->ForceRejoinDatarate;
+        return true;
+    }
+    if( ( ctx->Rejoin0Enabled == true ) &&
+        ( ( ctx->Rejoin0UplinkCounter >= ( 1UL << ( ctx->Rejoin0MaxCountN + 4 ) ) ) ||
+          ( RejoinSchedulerGetElapsedTime( now, &ctx->Rejoin0Time ) >= ( 1UL << ( ctx->Rejoin0MaxTimeN + 10 ) ) ) ) )
+    {
+        *type = REJOIN_REQ_0;
+        return true;
+    }
+    if( ( ctx->Rejoin1Cycle != 0 ) &&
+        ( RejoinSchedulerGetElapsedTime( now, &ctx->Rejoin1Time ) >= ctx->Rejoin1Cycle ) )
+    {
+        *type = REJOIN_REQ_1;
+        return true;
+    }
+    return false;
+}
+
+void LoRaMacRejoinSchedulerOnRejoin( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, JoinReqIdentifier_t type )
+{
+    if( ( ctx->ForceRejoinCount > 0 ) && ( type == ( JoinReqIdentifier_t )ctx->ForceRejoinType ) )
+    {
+        ctx->ForceRejoinCount--;
+        ctx->ForceRejoinTime = now + ( 32UL << ctx->ForceRejoinPeriod ) + randr( 0, 32 );
+    }
+
+    switch( type )
+    {
+        case REJOIN_REQ_0:
+        {
+            ctx->Rejoin0UplinkCounter = 0;
+            ctx->Rejoin0Time = now;
+            break;
+        }
+        case REJOIN_REQ_1:
+        {
+            ctx->Rejoin1Time = now;
+            break;
+        }
+        default:
+            break;
+    }
+}
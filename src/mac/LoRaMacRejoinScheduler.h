@@ -0,0 +1,188 @@
+/*!
+ * \file      LoRaMacRejoinScheduler.h
+ *
+ * \brief     LoRa MAC rejoin request scheduler
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  LORAMACREJOINSCHEDULER LoRa MAC rejoin request scheduler
+ *            Decides when a LoRaWAN 1.1 device sends its rejoin requests:
+ *            - type 0, once RejoinParamSetupReq has been received, every
+ *              2^( MaxCountN + 4 ) uplinks or 2^( MaxTimeN + 10 ) seconds,
+ *              whichever comes first
+ *            - type 1, every Rejoin1Cycle seconds when not 0
+ *            - type 0 or 2 requested by ForceRejoinReq, Max_Retries + 1
+ *              times, spaced by at least 32 s * 2^Period + rand( 0, 32 ) s
+ *
+ *            The scheduler only tells which rejoin is due. The MAC sends it
+ *            at the end of a transaction, before going back to sleep, so a
+ *            rejoin never costs a wakeup of its own. A due rejoin which
+ *            can't be sent, e.g. duty cycle restricted, waits for the next
+ *            transaction.
+ *
+ *            The context is part of the LoRaMac NVM context. Times are
+ *            SysTimeGetMcuTime seconds, they don't jump when the network
+ *            sets the system time. The time base restarts at boot, the
+ *            periods then restart when the context is restored.
+ * \{
+ */
+#ifndef __LORAMAC_REJOIN_SCHEDULER_H__
+#define __LORAMAC_REJOIN_SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LoRaMacTypes.h"
+
+/*!
+ * Rejoin scheduler context
+ */
+typedef struct sRejoinSchedulerNvmCtx
+{
+    /*!
+     * Set to true once RejoinParamSetupReq enabled the periodic type 0 rejoins
+     */
+    bool Rejoin0Enabled;
+    /*!
+     * Type 0 rejoin after 2^( Rejoin0MaxCountN + 4 ) uplinks
+     */
+    uint8_t Rejoin0MaxCountN;
+    /*!
+     * Type 0 rejoin after 2^( Rejoin0MaxTimeN + 10 ) seconds
+     */
+    uint8_t Rejoin0MaxTimeN;
+    /*!
+     * Number of uplinks since the last type 0 rejoin
+     */
+    uint32_t Rejoin0UplinkCounter;
+    /*!
+     * Time of the last type 0 rejoin [s]
+     */
+    uint32_t Rejoin0Time;
+    /*!
+     * Type 1 rejoin period [s], 0 disables the type 1 rejoins
+     */
+    uint32_t Rejoin1Cycle;
+    /*!
+     * Time of the last type 1 rejoin [s]
+     */
+    uint32_t Rejoin1Time;
+    /*!
+     * Number of rejoins still requested by ForceRejoinReq
+     */
+    uint8_t ForceRejoinCount;
+    /*!
+     * Rejoin type requested by ForceRejoinReq [REJOIN_REQ_0, REJOIN_REQ_2]
+     */
+    uint8_t ForceRejoinType;
+    /*!
+     * Period field of ForceRejoinReq
+     */
+    uint8_t ForceRejoinPeriod;
+    /*!
+     * Datarate requested by ForceRejoinReq
+     */
+    int8_t ForceRejoinDatarate;
+    /*!
+     * Earliest time of the next forced rejoin [s]
+     */
+    uint32_t ForceRejoinTime;
+}RejoinSchedulerNvmCtx_t;
+
+/*!
+ * \brief Initializes the context. No rejoin is scheduled until the network
+ *        requests it or Rejoin1Cycle is set.
+ *
+ * \param [OUT] ctx Rejoin scheduler context
+ * \param [IN]  now Current MCU time [s]
+ */
+void LoRaMacRejoinSchedulerInit( RejoinSchedulerNvmCtx_t* ctx, uint32_t now );
+
+/*!
+ * \brief Rebases the stored times once the context has been restored after a
+ *        power cycle. The periods restart, the pending forced rejoins wait
+ *        for their minimum spacing.
+ *
+ * \param [IN/OUT] ctx Rejoin scheduler context
+ * \param [IN]     now Current MCU time [s]
+ */
+void LoRaMacRejoinSchedulerRestore( RejoinSchedulerNvmCtx_t* ctx, uint32_t now );
+
+/*!
+ * \brief Restarts the periodic rejoins and drops the network requests once a
+ *        new session has been established by a join accept
+ *
+ * \param [IN/OUT] ctx Rejoin scheduler context
+ * \param [IN]     now Current MCU time [s]
+ */
+void LoRaMacRejoinSchedulerOnSessionStart( RejoinSchedulerNvmCtx_t* ctx, uint32_t now );
+
+/*!
+ * \brief Counts an application uplink
+ *
+ * \param [IN/OUT] ctx Rejoin scheduler context
+ */
+void LoRaMacRejoinSchedulerOnUplink( RejoinSchedulerNvmCtx_t* ctx );
+
+/*!
+ * \brief Applies a RejoinParamSetupReq
+ *
+ * \param [IN/OUT] ctx       Rejoin scheduler context
+ * \param [IN]     now       Current MCU time [s]
+ * \param [IN]     maxTimeN  MaxTimeN field
+ * \param [IN]     maxCountN MaxCountN field
+ *
+ * \retval timeOk TimeOK bit of RejoinParamSetupAns
+ */
+bool LoRaMacRejoinSchedulerSetup( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, uint8_t maxTimeN, uint8_t maxCountN );
+
+/*!
+ * \brief Applies a ForceRejoinReq. The first rejoin is due immediately.
+ *
+ * \param [IN/OUT] ctx        Rejoin scheduler context
+ * \param [IN]     now        Current MCU time [s]
+ * \param [IN]     type       Rejoin type [REJOIN_REQ_0, REJOIN_REQ_2]
+ * \param [IN]     period     Period field
+ * \param [IN]     maxRetries Max_Retries field
+ * \param [IN]     datarate   Datarate of the rejoins
+ */
+void LoRaMacRejoinSchedulerForce( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, JoinReqIdentifier_t type, uint8_t period, uint8_t maxRetries, int8_t datarate );
+
+/*!
+ * \brief Gets the rejoin to be sent. The forced rejoins come first, then the
+ *        type 0 and the type 1 ones.
+ *
+ * \param [IN]  ctx      Rejoin scheduler context
+ * \param [IN]  now      Current MCU time [s]
+ * \param [OUT] type     Rejoin type
+ * \param [OUT] datarate Datarate of a forced rejoin, left unchanged when the
+ *                       rejoin is sent at the current datarate
+ *
+ * \retval pending Returns true if a rejoin is due
+ */
+bool LoRaMacRejoinSchedulerGetPending( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, JoinReqIdentifier_t* type, int8_t* datarate );
+
+/*!
+ * \brief Schedules the next rejoin once a rejoin has been sent
+ *
+ * \param [IN/OUT] ctx  Rejoin scheduler context
+ * \param [IN]     now  Current MCU time [s]
+ * \param [IN]     type Type of the rejoin sent
+ */
+void LoRaMacRejoinSchedulerOnRejoin( RejoinSchedulerNvmCtx_t* ctx, uint32_t now, JoinReqIdentifier_t type );
+
+/*! \} defgroup LORAMACREJOINSCHEDULER */
+
+#endif // __LORAMAC_REJOIN_SCHEDULER_H__
@@ -0,0 +1,75 @@
+/*!
+ * \file      LoRaMacRxTiming.c
+ *
+ * \brief     LoRa MAC adaptive receive window timing error
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "utilities.h"
+#include "LoRaMacRxTiming.h"
+
+void LoRaMacRxTimingInit( RxTimingCtx_t* ctx, bool enabled )
+{
+    ctx->Enabled = enabled;
+    ctx->NbSamples = 0;
+    ctx->NbMisses = 0;
+    ctx->ErrorPeak = 0;
+}
+
+void LoRaMacRxTimingOnRxDone( RxTimingCtx_t* ctx, int32_t error, uint32_t maxRxError )
+{
+    uint32_t absError = ( error < 0 ) ? -error : error;
+
+    ctx->NbMisses = 0;
+
+    if( absError > maxRxError )
+    {
+        // Outlier, the frame has been received outside of the expected window
+        // or its time on air is unknown ( e.g. FSK )
+        return;
+    }
+
+    ctx->ErrorPeak -= ctx->ErrorPeak / RX_TIMING_PEAK_DECAY;
+    ctx->ErrorPeak = MAX( ctx->ErrorPeak, absError * 16 );
+
+    if( ctx->NbSamples < RX_TIMING_MIN_SAMPLES )
+    {
+        ctx->NbSamples++;
+    }
+}
+
+void LoRaMacRxTimingOnRxMiss( RxTimingCtx_t* ctx )
+{
+    if( ctx->NbMisses < RX_TIMING_MAX_MISSES )
+    {
+        ctx->NbMisses++;
+    }
+    if( ctx->NbMisses >= RX_TIMING_MAX_MISSES )
+    {
+        // The timing error may have been underestimated, restart the measurements
+        ctx->NbSamples = 0;
+        ctx->ErrorPeak = 0;
+    }
+}
+
+uint32_t LoRaMacRxTimingGetRxError( RxTimingCtx_t* ctx, uint32_t maxRxError )
+{
+    if( ( ctx->Enabled == false ) || ( ctx->NbSamples < RX_TIMING_MIN_SAMPLES ) )
+    {
+        return maxRxError;
+    }
+    return MIN( ( ( ctx->ErrorPeak + 15 ) / 16 ) + RX_TIMING_MARGIN, maxRxError );
+}
@@ -0,0 +1,126 @@
+/*!
+ * \file      LoRaMacRxTiming.h
+ *
+ * \brief     LoRa MAC adaptive receive window timing error
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  LORAMACRXTIMING LoRa MAC adaptive receive window timing error
+ *            Estimates the timing error of the device from the downlinks
+ *            received in RX1 and RX2.
+ *
+ *            The timing error of a downlink is the difference between the
+ *            measured and expected preamble start:
+ *            error = ( RxDone - TimeOnAir ) - ( TxDone + ReceiveDelay )
+ *
+ *            The peak of the errors, decaying by 1/RX_TIMING_PEAK_DECAY at each
+ *            sample, plus RX_TIMING_MARGIN gives the timing error used to size
+ *            the RX1 and RX2 windows. It is bounded by the configured
+ *            SystemMaxRxError, which is used until RX_TIMING_MIN_SAMPLES
+ *            downlinks have been measured and after RX_TIMING_MAX_MISSES
+ *            consecutive expected downlinks have been missed.
+ * \{
+ */
+#ifndef __LORAMAC_RX_TIMING_H__
+#define __LORAMAC_RX_TIMING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * Number of measurements required before the timing error is reduced
+ */
+#define RX_TIMING_MIN_SAMPLES                       4
+
+/*!
+ * Number of consecutive missed downlinks after which the measurements are
+ * dropped
+ */
+#define RX_TIMING_MAX_MISSES                        2
+
+/*!
+ * Margin added to the measured peak error: timer resolution of the TxDone
+ * and RxDone timestamps and time on air rounding [ms]
+ */
+#define RX_TIMING_MARGIN                            3
+
+/*!
+ * Peak error decay factor
+ */
+#define RX_TIMING_PEAK_DECAY                        16
+
+/*!
+ * Receive window timing error context
+ */
+typedef struct sRxTimingCtx
+{
+    /*!
+     * Set to true if the timing error adaptation is enabled
+     */
+    bool Enabled;
+    /*!
+     * Number of measurements, saturated to RX_TIMING_MIN_SAMPLES
+     */
+    uint8_t NbSamples;
+    /*!
+     * Number of consecutive missed downlinks
+     */
+    uint8_t NbMisses;
+    /*!
+     * Decaying peak of the measured errors [1/16 ms]
+     */
+    uint32_t ErrorPeak;
+}RxTimingCtx_t;
+
+/*!
+ * \brief Initializes the context and drops the measurements
+ *
+ * \param [OUT] ctx     Timing error context
+ * \param [IN]  enabled Enables the timing error adaptation
+ */
+void LoRaMacRxTimingInit( RxTimingCtx_t* ctx, bool enabled );
+
+/*!
+ * \brief Accounts the timing error of a downlink received in RX1 or RX2
+ *
+ * \param [IN/OUT] ctx        Timing error context
+ * \param [IN]     error      Measured preamble start error [ms]
+ * \param [IN]     maxRxError Configured system maximum timing error [ms].
+ *                            Larger errors are treated as outliers.
+ */
+void LoRaMacRxTimingOnRxDone( RxTimingCtx_t* ctx, int32_t error, uint32_t maxRxError );
+
+/*!
+ * \brief Accounts an expected downlink (acknowledgement, join accept) which
+ *        has not been received
+ *
+ * \param [IN/OUT] ctx Timing error context
+ */
+void LoRaMacRxTimingOnRxMiss( RxTimingCtx_t* ctx );
+
+/*!
+ * \brief Gets the timing error to be used to compute the RX1 and RX2 windows
+ *
+ * \param [IN] ctx        Timing error context
+ * \param [IN] maxRxError Configured system maximum timing error [ms]
+ *
+ * \retval rxError Timing error [ms]
+ */
+uint32_t LoRaMacRxTimingGetRxError( RxTimingCtx_t* ctx, uint32_t maxRxError );
+
+/*! \} defgroup LORAMACRXTIMING */
+
+#endif // __LORAMAC_RX_TIMING_H__
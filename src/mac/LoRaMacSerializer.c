@@ -85,6 +85,13 @@ LoRaMacSerializerStatus_t LoRaMacSerializerReJoinType1( LoRaMacMessageReJoinType
     macMsg->Buffer[bufItr++] = macMsg->RJcount1 & 0xFF;
     macMsg->Buffer[bufItr++] = ( macMsg->RJcount1 >> 8 ) & 0xFF;
 
+    macMsg->Buffer[bufItr++] = macMsg->MIC & 0xFF;
+    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 8 ) & 0xFF;
+    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 16 ) & 0xFF;
+    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 24 ) & 0xFF;
+
+    macMsg->BufSize = bufItr;
+
     return LORAMAC_SERIALIZER_SUCCESS;
 }
 
@@ -116,6 +123,13 @@ LoRaMacSerializerStatus_t LoRaMacSerializerReJoinType0or2( LoRaMacMessageReJoinT
     macMsg->Buffer[bufItr++] = macMsg->RJcount0 & 0xFF;
     macMsg->Buffer[bufItr++] = ( macMsg->RJcount0 >> 8 ) & 0xFF;
 
+    macMsg->Buffer[bufItr++] = macMsg->MIC & 0xFF;
+    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 8 ) & 0xFF;
+    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 16 ) & 0xFF;
+    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 24 ) & 0xFF;
+
+    macMsg->BufSize = bufItr;
+
     return LORAMAC_SERIALIZER_SUCCESS;
 }
 
@@ -169,7 +183,11 @@ LoRaMacSerializerStatus_t LoRaMacSerializerData( LoRaMacMessageData_t* macMsg )
         macMsg->Buffer[bufItr++] = macMsg->FPort;
     }
 
-    memcpy1( &macMsg->Buffer[bufItr], macMsg->FRMPayload, macMsg->FRMPayloadSize );
+    // The payload may have been written in place by the MAC layer
+    if( &macMsg->Buffer[bufItr] != macMsg->FRMPayload )
+    {
+        memcpy1( &macMsg->Buffer[bufItr], macMsg->FRMPayload, macMsg->FRMPayloadSize );
+    }
     bufItr = bufItr + macMsg->FRMPayloadSize;
 
     macMsg->Buffer[bufItr++] = macMsg->MIC & 0xFF;
@@ -0,0 +1,59 @@
+/*!
+ * \file      LoRaMacTrace.c
+ *
+ * \brief     LoRa MAC binary trace implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "utilities.h"
+#include "timer.h"
+#include "LoRaMacTrace.h"
+
+#if defined( LORAMAC_TRACE_ENABLED )
+
+#if ( ( LORAMAC_TRACE_SIZE & ( LORAMAC_TRACE_SIZE - 1 ) ) != 0 )
+#error "LORAMAC_TRACE_SIZE must be a power of 2"
+#endif
+
+LoRaMacTraceBuffer_t LoRaMacTrace =
+{
+    .Magic = LORAMAC_TRACE_MAGIC,
+    .Size = LORAMAC_TRACE_SIZE,
+    .Count = 0,
+};
+
+void LoRaMacTraceRecord( uint8_t event, uint8_t arg8, uint16_t arg16 )
+{
+    LoRaMacTraceRecord_t* record;
+
+    CRITICAL_SECTION_BEGIN( );
+    record = &LoRaMacTrace.Records[LoRaMacTrace.Count & ( LORAMAC_TRACE_SIZE - 1 )];
+    LoRaMacTrace.Count++;
+    record->Timestamp = TimerGetCurrentTime( );
+    record->Event = event;
+    record->Arg8 = arg8;
+    record->Arg16 = arg16;
+    CRITICAL_SECTION_END( );
+}
+
+void LoRaMacTraceClear( void )
+{
+    CRITICAL_SECTION_BEGIN( );
+    LoRaMacTrace.Count = 0;
+    CRITICAL_SECTION_END( );
+}
+
+#endif
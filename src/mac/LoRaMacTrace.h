@@ -0,0 +1,214 @@
+/*!
+ * \file      LoRaMacTrace.h
+ *
+ * \brief     LoRa MAC binary trace implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  LORAMACTRACE LoRa MAC binary trace implementation
+ *            Records the MAC state transitions, the radio events, the MAC
+ *            timers and the MCPS/MLME primitives in a ring buffer of
+ *            timestamped 8 bytes records.
+ *
+ *            The trace is enabled by defining LORAMAC_TRACE_ENABLED (CMake
+ *            option LORAMAC_TRACE). Otherwise the LORAMAC_TRACE macro expands
+ *            to nothing.
+ *
+ *            The \ref LoRaMacTrace variable can be dumped with the debugger
+ *            and rendered as a timeline with cmake/mac-trace-decode.cmake:
+ *            (gdb) dump binary value mac-trace.bin LoRaMacTrace
+ * \{
+ */
+#ifndef __LORAMAC_TRACE_H__
+#define __LORAMAC_TRACE_H__
+
+#include <stdint.h>
+
+/*!
+ * Number of trace records. Must be a power of 2.
+ */
+#ifndef LORAMAC_TRACE_SIZE
+#define LORAMAC_TRACE_SIZE                          64
+#endif
+
+/*!
+ * Trace buffer identifier, "MTRC"
+ */
+#define LORAMAC_TRACE_MAGIC                         0x4352544D
+
+/*!
+ * Trace events
+ */
+typedef enum eLoRaMacTraceEvent
+{
+    /*!
+     * MAC state change. Arg8: MacFlags, Arg16: MacState
+     */
+    LORAMAC_TRACE_EVENT_MAC_STATE = 0,
+    /*!
+     * Radio transmission start. Arg8: channel, Arg16: frame size
+     */
+    LORAMAC_TRACE_EVENT_RADIO_TX,
+    /*!
+     * Radio reception start. Arg8: LoRaMacRxSlot_t, Arg16: timeout [ms], 0 continuous
+     */
+    LORAMAC_TRACE_EVENT_RADIO_RX,
+    /*!
+     * Radio Tx done interrupt
+     */
+    LORAMAC_TRACE_EVENT_RADIO_TX_DONE,
+    /*!
+     * Radio Rx done interrupt. Arg8: frame size, Arg16: RSSI [dBm]
+     */
+    LORAMAC_TRACE_EVENT_RADIO_RX_DONE,
+    /*!
+     * Radio Tx timeout interrupt
+     */
+    LORAMAC_TRACE_EVENT_RADIO_TX_TIMEOUT,
+    /*!
+     * Radio Rx error interrupt
+     */
+    LORAMAC_TRACE_EVENT_RADIO_RX_ERROR,
+    /*!
+     * Radio Rx timeout interrupt
+     */
+    LORAMAC_TRACE_EVENT_RADIO_RX_TIMEOUT,
+    /*!
+     * Timer start. Arg8: LoRaMacTraceTimer_t, Arg16: timeout [ms], saturated
+     */
+    LORAMAC_TRACE_EVENT_TIMER_START,
+    /*!
+     * Timer stop. Arg8: LoRaMacTraceTimer_t
+     */
+    LORAMAC_TRACE_EVENT_TIMER_STOP,
+    /*!
+     * Timer expiry. Arg8: LoRaMacTraceTimer_t
+     */
+    LORAMAC_TRACE_EVENT_TIMER_EXPIRED,
+    /*!
+     * MCPS-Request. Arg8: Mcps_t, Arg16: LoRaMacStatus_t
+     */
+    LORAMAC_TRACE_EVENT_MCPS_REQUEST,
+    /*!
+     * MLME-Request. Arg8: Mlme_t, Arg16: LoRaMacStatus_t
+     */
+    LORAMAC_TRACE_EVENT_MLME_REQUEST,
+    /*!
+     * MCPS-Confirm. Arg8: Mcps_t, Arg16: LoRaMacEventInfoStatus_t
+     */
+    LORAMAC_TRACE_EVENT_MCPS_CONFIRM,
+    /*!
+     * MLME-Confirm. Arg8: Mlme_t, Arg16: LoRaMacEventInfoStatus_t
+     */
+    LORAMAC_TRACE_EVENT_MLME_CONFIRM,
+    /*!
+     * MCPS-Indication. Arg8: port, Arg16: LoRaMacEventInfoStatus_t
+     */
+    LORAMAC_TRACE_EVENT_MCPS_INDICATION,
+}LoRaMacTraceEvent_t;
+
+/*!
+ * Traced MAC timers
+ */
+typedef enum eLoRaMacTraceTimer
+{
+    LORAMAC_TRACE_TIMER_TX_DELAYED = 0,
+    LORAMAC_TRACE_TIMER_RX_WINDOW_1,
+    LORAMAC_TRACE_TIMER_RX_WINDOW_2,
+    LORAMAC_TRACE_TIMER_ACK_TIMEOUT,
+}LoRaMacTraceTimer_t;
+
+/*!
+ * Trace record
+ */
+typedef struct sLoRaMacTraceRecord
+{
+    /*!
+     * Record time [ms]
+     */
+    uint32_t Timestamp;
+    /*!
+     * LoRaMacTraceEvent_t
+     */
+    uint8_t Event;
+    /*!
+     * Event specific argument
+     */
+    uint8_t Arg8;
+    /*!
+     * Event specific argument
+     */
+    uint16_t Arg16;
+}LoRaMacTraceRecord_t;
+
+/*!
+ * Trace buffer
+ */
+typedef struct sLoRaMacTraceBuffer
+{
+    /*!
+     * Set to LORAMAC_TRACE_MAGIC
+     */
+    uint32_t Magic;
+    /*!
+     * Number of records of the ring buffer
+     */
+    uint32_t Size;
+    /*!
+     * Total number of records written. The next record is written at
+     * index Count % Size
+     */
+    uint32_t Count;
+    /*!
+     * Ring buffer
+     */
+    LoRaMacTraceRecord_t Records[LORAMAC_TRACE_SIZE];
+}LoRaMacTraceBuffer_t;
+
+#if defined( LORAMAC_TRACE_ENABLED )
+
+/*!
+ * Trace buffer
+ */
+extern LoRaMacTraceBuffer_t LoRaMacTrace;
+
+/*!
+ * \brief Adds a record to the trace
+ *
+ * \remark May be called from interrupt context
+ *
+ * \param [IN] event LoRaMacTraceEvent_t
+ * \param [IN] arg8  Event specific argument
+ * \param [IN] arg16 Event specific argument
+ */
+void LoRaMacTraceRecord( uint8_t event, uint8_t arg8, uint16_t arg16 );
+
+/*!
+ * \brief Clears the trace
+ */
+void LoRaMacTraceClear( void );
+
+#define LORAMAC_TRACE( event, arg8, arg16 )         LoRaMacTraceRecord( ( event ), ( uint8_t )( arg8 ), ( uint16_t )( arg16 ) )
+
+#else
+
+#define LORAMAC_TRACE( event, arg8, arg16 )
+
+#endif
+
+/*! \} defgroup LORAMACTRACE */
+
+#endif // __LORAMAC_TRACE_H__
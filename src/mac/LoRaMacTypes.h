@@ -465,6 +465,10 @@ typedef enum eLoRaMacMoteCmd
      * DeviceTimeReq
      */
     MOTE_MAC_DEVICE_TIME_REQ         = 0x0D,
+    /*!
+     * RejoinParamSetupAns
+     */
+    MOTE_MAC_REJOIN_PARAM_ANS        = 0x0F,
     /*!
      * PingSlotInfoReq
      */
@@ -534,6 +538,14 @@ typedef enum eLoRaMacSrvCmd
      * DeviceTimeAns
      */
     SRV_MAC_DEVICE_TIME_ANS          = 0x0D,
+    /*!
+     * ForceRejoinReq
+     */
+    SRV_MAC_FORCE_REJOIN_REQ         = 0x0E,
+    /*!
+     * RejoinParamSetupReq
+     */
+    SRV_MAC_REJOIN_PARAM_REQ         = 0x0F,
     /*!
      * PingSlotInfoAns
      */
@@ -610,6 +622,10 @@ typedef enum eLoRaMacFrameType
      * LoRaMAC confirmed down-link frame
      */
     FRAME_TYPE_DATA_CONFIRMED_DOWN   = 0x05,
+    /*!
+     * LoRaMAC rejoin request
+     */
+    FRAME_TYPE_REJOIN                = 0x06,
     /*!
      * LoRaMAC proprietary frame
      */
@@ -28,782 +28,156 @@
  *
  * \author    Daniel Jaeckle ( STACKFORCE )
 */
-#include "utilities.h"
-
 #include "RegionCommon.h"
+#include "RegionDynamic.h"
 #include "RegionCN779.h"
 
-// Definitions
-#define CHANNELS_MASK_SIZE              1
+#if ( CN779_MAX_NB_CHANNELS > REGION_DYNAMIC_MAX_NB_CHANNELS ) || ( CN779_MAX_NB_BANDS > REGION_DYNAMIC_MAX_NB_BANDS )
+#error "CN779 channels or bands do not fit in the dynamic channel plan context"
+#endif
 
 /*!
- * Region specific context
+ * Default channels
  */
-typedef struct sRegionCN779NvmCtx
+static const ChannelParams_t DefaultChannelsCN779[] =
 {
-    /*!
-     * LoRaMAC channels
-     */
-    ChannelParams_t Channels[ CN779_MAX_NB_CHANNELS ];
-    /*!
-     * LoRaMac bands
-     */
-    Band_t Bands[ CN779_MAX_NB_BANDS ];
-    /*!
-     * LoRaMac channels mask
-     */
-    uint16_t ChannelsMask[ CHANNELS_MASK_SIZE ];
-    /*!
-     * LoRaMac channels default mask
-     */
-    uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
-}RegionCN779NvmCtx_t;
+    CN779_LC1,
+    CN779_LC2,
+    CN779_LC3,
+};
 
-/*
- * Non-volatile module context.
+/*!
+ * Bands
  */
-static RegionCN779NvmCtx_t NvmCtx;
-
-// Static functions
-static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
-{
-    uint8_t nextLowerDr = 0;
-
-    if( dr == minDr )
-    {
-        nextLowerDr = minDr;
-    }
-    else
-    {
-        nextLowerDr = dr - 1;
-    }
-    return nextLowerDr;
-}
-
-static uint32_t GetBandwidth( uint32_t drIndex )
+static const Band_t BandsCN779[] =
 {
-    switch( BandwidthsCN779[drIndex] )
-    {
-        default:
-        case 125000:
-            return 0;
-        case 250000:
-            return 1;
-        case 500000:
-            return 2;
-    }
-}
-
-static int8_t LimitTxPower( int8_t txPower, int8_t maxBandTxPower, int8_t datarate, uint16_t* channelsMask )
-{
-    int8_t txPowerResult = txPower;
-
-    // Limit tx power to the band max
-    txPowerResult =  MAX( txPower, maxBandTxPower );
-
-    return txPowerResult;
-}
+    CN779_BAND0,
+};
 
-static bool VerifyRfFreq( uint32_t freq )
-{
-    // Check radio driver support
-    if( Radio.CheckRfFrequency( freq ) == false )
-    {
-        return false;
-    }
-
-    if( ( freq < 779500000 ) || ( freq > 786500000 ) )
-    {
-        return false;
-    }
-    return true;
-}
-
-static uint8_t CountNbOfEnabledChannels( bool joined, uint8_t datarate, uint16_t* channelsMask, ChannelParams_t* channels, Band_t* bands, uint8_t* enabledChannels, uint8_t* delayTx )
+/*!
+ * Frequency ranges and their band
+ */
+static const RegionDynamicFreqRange_t FreqRangesCN779[] =
 {
-    uint8_t nbEnabledChannels = 0;
-    uint8_t delayTransmission = 0;
+    { 779500000, 786500000, 0 },
+};
 
-    for( uint8_t i = 0, k = 0; i < CN779_MAX_NB_CHANNELS; i += 16, k++ )
-    {
-        for( uint8_t j = 0; j < 16; j++ )
-        {
-            if( ( channelsMask[k] & ( 1 << j ) ) != 0 )
-            {
-                if( channels[i + j].Frequency == 0 )
-                { // Check if the channel is enabled
-                    continue;
-                }
-                if( joined == false )
-                {
-                    if( ( CN779_JOIN_CHANNELS & ( 1 << j ) ) == 0 )
-                    {
-                        continue;
-                    }
-                }
-                if( RegionCommonValueInRange( datarate, channels[i + j].DrRange.Fields.Min,
-                                              channels[i + j].DrRange.Fields.Max ) == false )
-                { // Check if the current channel selection supports the given datarate
-                    continue;
-                }
-                if( bands[channels[i + j].Band].TimeOff > 0 )
-                { // Check if the band is available for transmission
-                    delayTransmission++;
-                    continue;
-                }
-                enabledChannels[nbEnabledChannels++] = i + j;
-            }
-        }
-    }
-
-    *delayTx = delayTransmission;
-    return nbEnabledChannels;
-}
+/*!
+ * Region descriptor
+ */
+static const RegionDynamicParams_t RegionCN779 =
+{
+    .MaxNbChannels                = CN779_MAX_NB_CHANNELS,
+    .NbDefaultChannels            = CN779_NUMB_DEFAULT_CHANNELS,
+    .NbChannelsCfList             = CN779_NUMB_CHANNELS_CF_LIST,
+    .DefaultChannels              = DefaultChannelsCN779,
+    .JoinChannels                 = CN779_JOIN_CHANNELS,
+    .NbBands                      = CN779_MAX_NB_BANDS,
+    .Bands                        = BandsCN779,
+    .NbFreqRanges                 = sizeof( FreqRangesCN779 ) / sizeof( RegionDynamicFreqRange_t ),
+    .FreqRanges                   = FreqRangesCN779,
+    .Datarates                    = DataratesCN779,
+    .Bandwidths                   = BandwidthsCN779,
+    .MaxPayloadOfDatarate         = MaxPayloadOfDatarateCN779,
+    .MaxPayloadOfDatarateRepeater = MaxPayloadOfDatarateRepeaterCN779,
+    .TxMinDatarate                = CN779_TX_MIN_DATARATE,
+    .TxMaxDatarate                = CN779_TX_MAX_DATARATE,
+    .RxMinDatarate                = CN779_RX_MIN_DATARATE,
+    .RxMaxDatarate                = CN779_RX_MAX_DATARATE,
+    .DefaultDatarate              = CN779_DEFAULT_DATARATE,
+    .MinRx1DrOffset               = CN779_MIN_RX1_DR_OFFSET,
+    .MaxRx1DrOffset               = CN779_MAX_RX1_DR_OFFSET,
+    .DefaultRx1DrOffset           = CN779_DEFAULT_RX1_DR_OFFSET,
+    .MinTxPower                   = CN779_MIN_TX_POWER,
+    .MaxTxPower                   = CN779_MAX_TX_POWER,
+    .DefaultTxPower               = CN779_DEFAULT_TX_POWER,
+    .DefaultMaxEirp               = CN779_DEFAULT_MAX_EIRP,
+    .DefaultAntennaGain           = CN779_DEFAULT_ANTENNA_GAIN,
+    .AdrAckLimit                  = CN779_ADR_ACK_LIMIT,
+    .AdrAckDelay                  = CN779_ADR_ACK_DELAY,
+    .DutyCycleEnabled             = CN779_DUTY_CYCLE_ENABLED,
+    .MaxRxWindow                  = CN779_MAX_RX_WINDOW,
+    .ReceiveDelay1                = CN779_RECEIVE_DELAY1,
+    .ReceiveDelay2                = CN779_RECEIVE_DELAY2,
+    .JoinAcceptDelay1             = CN779_JOIN_ACCEPT_DELAY1,
+    .JoinAcceptDelay2             = CN779_JOIN_ACCEPT_DELAY2,
+    .MaxFCntGap                   = CN779_MAX_FCNT_GAP,
+    .AckTimeout                   = CN779_ACKTIMEOUT,
+    .AckTimeoutRnd                = CN779_ACK_TIMEOUT_RND,
+    .Rx2Frequency                 = CN779_RX_WND_2_FREQ,
+    .Rx2Datarate                  = CN779_RX_WND_2_DR,
+    .BeaconFrequency              = CN779_BEACON_CHANNEL_FREQ,
+    .BeaconSize                   = CN779_BEACON_SIZE,
+    .Rfu1Size                     = CN779_RFU1_SIZE,
+    .Rfu2Size                     = CN779_RFU2_SIZE,
+    .BeaconDatarate               = CN779_BEACON_CHANNEL_DR,
+    .BeaconBandwidth              = CN779_BEACON_CHANNEL_BW,
+    .PingSlotDatarate             = CN779_PING_SLOT_CHANNEL_DR,
+};
 
 PhyParam_t RegionCN779GetPhyParam( GetPhyParams_t* getPhy )
 {
-    PhyParam_t phyParam = { 0 };
-
-    switch( getPhy->Attribute )
-    {
-        case PHY_MIN_RX_DR:
-        {
-            phyParam.Value = CN779_RX_MIN_DATARATE;
-            break;
-        }
-        case PHY_MIN_TX_DR:
-        {
-            phyParam.Value = CN779_TX_MIN_DATARATE;
-            break;
-        }
-        case PHY_DEF_TX_DR:
-        {
-            phyParam.Value = CN779_DEFAULT_DATARATE;
-            break;
-        }
-        case PHY_NEXT_LOWER_TX_DR:
-        {
-            phyParam.Value = GetNextLowerTxDr( getPhy->Datarate, CN779_TX_MIN_DATARATE );
-            break;
-        }
-        case PHY_MAX_TX_POWER:
-        {
-            phyParam.Value = CN779_MAX_TX_POWER;
-            break;
-        }
-        case PHY_DEF_TX_POWER:
-        {
-            phyParam.Value = CN779_DEFAULT_TX_POWER;
-            break;
-        }
-        case PHY_DEF_ADR_ACK_LIMIT:
-        {
-            phyParam.Value = CN779_ADR_ACK_LIMIT;
-            break;
-        }
-        case PHY_DEF_ADR_ACK_DELAY:
-        {
-            phyParam.Value = CN779_ADR_ACK_DELAY;
-            break;
-        }
-        case PHY_MAX_PAYLOAD:
-        {
-            phyParam.Value = MaxPayloadOfDatarateCN779[getPhy->Datarate];
-            break;
-        }
-        case PHY_MAX_PAYLOAD_REPEATER:
-        {
-            phyParam.Value = MaxPayloadOfDatarateRepeaterCN779[getPhy->Datarate];
-            break;
-        }
-        case PHY_DUTY_CYCLE:
-        {
-            phyParam.Value = CN779_DUTY_CYCLE_ENABLED;
-            break;
-        }
-        case PHY_MAX_RX_WINDOW:
-        {
-            phyParam.Value = CN779_MAX_RX_WINDOW;
-            break;
-        }
-        case PHY_RECEIVE_DELAY1:
-        {
-            phyParam.Value = CN779_RECEIVE_DELAY1;
-            break;
-        }
-        case PHY_RECEIVE_DELAY2:
-        {
-            phyParam.Value = CN779_RECEIVE_DELAY2;
-            break;
-        }
-        case PHY_JOIN_ACCEPT_DELAY1:
-        {
-            phyParam.Value = CN779_JOIN_ACCEPT_DELAY1;
-            break;
-        }
-        case PHY_JOIN_ACCEPT_DELAY2:
-        {
-            phyParam.Value = CN779_JOIN_ACCEPT_DELAY2;
-            break;
-        }
-        case PHY_MAX_FCNT_GAP:
-        {
-            phyParam.Value = CN779_MAX_FCNT_GAP;
-            break;
-        }
-        case PHY_ACK_TIMEOUT:
-        {
-            phyParam.Value = ( CN779_ACKTIMEOUT + randr( -CN779_ACK_TIMEOUT_RND, CN779_ACK_TIMEOUT_RND ) );
-            break;
-        }
-        case PHY_DEF_DR1_OFFSET:
-        {
-            phyParam.Value = CN779_DEFAULT_RX1_DR_OFFSET;
-            break;
-        }
-        case PHY_DEF_RX2_FREQUENCY:
-        {
-            phyParam.Value = CN779_RX_WND_2_FREQ;
-            break;
-        }
-        case PHY_DEF_RX2_DR:
-        {
-            phyParam.Value = CN779_RX_WND_2_DR;
-            break;
-        }
-        case PHY_CHANNELS_MASK:
-        {
-            phyParam.ChannelsMask = NvmCtx.ChannelsMask;
-            break;
-        }
-        case PHY_CHANNELS_DEFAULT_MASK:
-        {
-            phyParam.ChannelsMask = NvmCtx.ChannelsDefaultMask;
-            break;
-        }
-        case PHY_MAX_NB_CHANNELS:
-        {
-            phyParam.Value = CN779_MAX_NB_CHANNELS;
-            break;
-        }
-        case PHY_CHANNELS:
-        {
-            phyParam.Channels = NvmCtx.Channels;
-            break;
-        }
-        case PHY_DEF_UPLINK_DWELL_TIME:
-        case PHY_DEF_DOWNLINK_DWELL_TIME:
-        {
-            phyParam.Value = 0;
-            break;
-        }
-        case PHY_DEF_MAX_EIRP:
-        {
-            phyParam.fValue = CN779_DEFAULT_MAX_EIRP;
-            break;
-        }
-        case PHY_DEF_ANTENNA_GAIN:
-        {
-            phyParam.fValue = CN779_DEFAULT_ANTENNA_GAIN;
-            break;
-        }
-        case PHY_BEACON_CHANNEL_FREQ:
-        {
-            phyParam.Value = CN779_BEACON_CHANNEL_FREQ;
-            break;
-        }
-        case PHY_BEACON_FORMAT:
-        {
-            phyParam.BeaconFormat.BeaconSize = CN779_BEACON_SIZE;
-            phyParam.BeaconFormat.Rfu1Size = CN779_RFU1_SIZE;
-            phyParam.BeaconFormat.Rfu2Size = CN779_RFU2_SIZE;
-            break;
-        }
-        case PHY_BEACON_CHANNEL_DR:
-        {
-            phyParam.Value = CN779_BEACON_CHANNEL_DR;
-            break;
-        }
-        case PHY_PING_SLOT_CHANNEL_DR:
-        {
-            phyParam.Value = CN779_PING_SLOT_CHANNEL_DR;
-            break;
-        }
-        default:
-        {
-            break;
-        }
-    }
-
-    return phyParam;
+    return RegionDynamicGetPhyParam( &RegionCN779, getPhy );
 }
 
 void RegionCN779SetBandTxDone( SetBandTxDoneParams_t* txDone )
 {
-    RegionCommonSetBandTxDone( txDone->Joined, &NvmCtx.Bands[NvmCtx.Channels[txDone->Channel].Band], txDone->LastTxDoneTime );
+    RegionDynamicSetBandTxDone( &RegionCN779, txDone );
 }
 
 void RegionCN779InitDefaults( InitDefaultsParams_t* params )
 {
-    Band_t bands[CN779_MAX_NB_BANDS] =
-    {
-        CN779_BAND0
-    };
-
-    switch( params->Type )
-    {
-        case INIT_TYPE_INIT:
-        {
-            // Initialize bands
-            memcpy1( ( uint8_t* )NvmCtx.Bands, ( uint8_t* )bands, sizeof( Band_t ) * CN779_MAX_NB_BANDS );
-
-            // Channels
-            NvmCtx.Channels[0] = ( ChannelParams_t ) CN779_LC1;
-            NvmCtx.Channels[1] = ( ChannelParams_t ) CN779_LC2;
-            NvmCtx.Channels[2] = ( ChannelParams_t ) CN779_LC3;
-
-            // Initialize the channels default mask
-            NvmCtx.ChannelsDefaultMask[0] = LC( 1 ) + LC( 2 ) + LC( 3 );
-            // Update the channels mask
-            RegionCommonChanMaskCopy( NvmCtx.ChannelsMask, NvmCtx.ChannelsDefaultMask, 1 );
-            break;
-        }
-        case INIT_TYPE_RESTORE_CTX:
-        {
-            if( params->NvmCtx != 0 )
-            {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
-            }
-            break;
-        }
-        case INIT_TYPE_RESTORE_DEFAULT_CHANNELS:
-        {
-            // Restore channels default mask
-            NvmCtx.ChannelsMask[0] |= NvmCtx.ChannelsDefaultMask[0];
-
-            // Channels
-            NvmCtx.Channels[0] = ( ChannelParams_t ) CN779_LC1;
-            NvmCtx.Channels[1] = ( ChannelParams_t ) CN779_LC2;
-            NvmCtx.Channels[2] = ( ChannelParams_t ) CN779_LC3;
-            break;
-        }
-        default:
-        {
-            break;
-        }
-    }
+    RegionDynamicInitDefaults( &RegionCN779, params );
 }
 
 void* RegionCN779GetNvmCtx( GetNvmCtxParams_t* params )
 {
-    params->nvmCtxSize = sizeof( RegionCN779NvmCtx_t );
-    return &NvmCtx;
+    return RegionDynamicGetNvmCtx( &RegionCN779, params );
 }
 
 bool RegionCN779Verify( VerifyParams_t* verify, PhyAttribute_t phyAttribute )
 {
-    switch( phyAttribute )
-    {
-        case PHY_FREQUENCY:
-        {
-            return VerifyRfFreq( verify->Frequency );
-        }
-        case PHY_TX_DR:
-        {
-            return RegionCommonValueInRange( verify->DatarateParams.Datarate, CN779_TX_MIN_DATARATE, CN779_TX_MAX_DATARATE );
-        }
-        case PHY_DEF_TX_DR:
-        {
-            return RegionCommonValueInRange( verify->DatarateParams.Datarate, DR_0, DR_5 );
-        }
-        case PHY_RX_DR:
-        {
-            return RegionCommonValueInRange( verify->DatarateParams.Datarate, CN779_RX_MIN_DATARATE, CN779_RX_MAX_DATARATE );
-        }
-        case PHY_DEF_TX_POWER:
-        case PHY_TX_POWER:
-        {
-            // Remark: switched min and max!
-            return RegionCommonValueInRange( verify->TxPower, CN779_MAX_TX_POWER, CN779_MIN_TX_POWER );
-        }
-        case PHY_DUTY_CYCLE:
-        {
-            return CN779_DUTY_CYCLE_ENABLED;
-        }
-        default:
-            return false;
-    }
+    return RegionDynamicVerify( &RegionCN779, verify, phyAttribute );
 }
 
 void RegionCN779ApplyCFList( ApplyCFListParams_t* applyCFList )
 {
-    ChannelParams_t newChannel;
-    ChannelAddParams_t channelAdd;
-    ChannelRemoveParams_t channelRemove;
-
-    // Setup default datarate range
-    newChannel.DrRange.Value = ( DR_5 << 4 ) | DR_0;
-
-    // Size of the optional CF list
-    if( applyCFList->Size != 16 )
-    {
-        return;
-    }
-
-    // Last byte CFListType must be 0 to indicate the CFList contains a list of frequencies
-    if( applyCFList->Payload[15] != 0 )
-    {
-        return;
-    }
-
-    // Last byte is RFU, don't take it into account
-    for( uint8_t i = 0, chanIdx = CN779_NUMB_DEFAULT_CHANNELS; chanIdx < CN779_MAX_NB_CHANNELS; i+=3, chanIdx++ )
-    {
-        if( chanIdx < ( CN779_NUMB_CHANNELS_CF_LIST + CN779_NUMB_DEFAULT_CHANNELS ) )
-        {
-            // Channel frequency
-            newChannel.Frequency = (uint32_t) applyCFList->Payload[i];
-            newChannel.Frequency |= ( (uint32_t) applyCFList->Payload[i + 1] << 8 );
-            newChannel.Frequency |= ( (uint32_t) applyCFList->Payload[i + 2] << 16 );
-            newChannel.Frequency *= 100;
-
-            // Initialize alternative frequency to 0
-            newChannel.Rx1Frequency = 0;
-        }
-        else
-        {
-            newChannel.Frequency = 0;
-            newChannel.DrRange.Value = 0;
-            newChannel.Rx1Frequency = 0;
-        }
-
-        if( newChannel.Frequency != 0 )
-        {
-            channelAdd.NewChannel = &newChannel;
-            channelAdd.ChannelId = chanIdx;
-
-            // Try to add all channels
-            RegionCN779ChannelAdd( &channelAdd );
-        }
-        else
-        {
-            channelRemove.ChannelId = chanIdx;
-
-            RegionCN779ChannelsRemove( &channelRemove );
-        }
-    }
+    RegionDynamicApplyCFList( &RegionCN779, applyCFList );
 }
 
 bool RegionCN779ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 {
-    switch( chanMaskSet->ChannelsMaskType )
-    {
-        case CHANNELS_MASK:
-        {
-            RegionCommonChanMaskCopy( NvmCtx.ChannelsMask, chanMaskSet->ChannelsMaskIn, 1 );
-            break;
-        }
-        case CHANNELS_DEFAULT_MASK:
-        {
-            RegionCommonChanMaskCopy( NvmCtx.ChannelsDefaultMask, chanMaskSet->ChannelsMaskIn, 1 );
-            break;
-        }
-        default:
-            return false;
-    }
-    return true;
+    return RegionDynamicChanMaskSet( &RegionCN779, chanMaskSet );
 }
 
 void RegionCN779ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
-
-    // Get the datarate, perform a boundary check
-    rxConfigParams->Datarate = MIN( datarate, CN779_RX_MAX_DATARATE );
-    rxConfigParams->Bandwidth = GetBandwidth( rxConfigParams->Datarate );
-
-    if( rxConfigParams->Datarate == DR_7 )
-    { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesCN779[rxConfigParams->Datarate] );
-    }
-    else
-    { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesCN779[rxConfigParams->Datarate], BandwidthsCN779[rxConfigParams->Datarate] );
-    }
-
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionDynamicComputeRxWindowParameters( &RegionCN779, datarate, minRxSymbols, rxError, rxConfigParams );
 }
 
 bool RegionCN779RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
 {
-    RadioModems_t modem;
-    int8_t dr = rxConfig->Datarate;
-    uint8_t maxPayload = 0;
-    int8_t phyDr = 0;
-    uint32_t frequency = rxConfig->Frequency;
-
-    if( Radio.GetStatus( ) != RF_IDLE )
-    {
-        return false;
-    }
-
-    if( rxConfig->RxSlot == RX_SLOT_WIN_1 )
-    {
-        // Apply window 1 frequency
-        frequency = NvmCtx.Channels[rxConfig->Channel].Frequency;
-        // Apply the alternative RX 1 window frequency, if it is available
-        if( NvmCtx.Channels[rxConfig->Channel].Rx1Frequency != 0 )
-        {
-            frequency = NvmCtx.Channels[rxConfig->Channel].Rx1Frequency;
-        }
-    }
-
-    // Read the physical datarate from the datarates table
-    phyDr = DataratesCN779[dr];
-
-    Radio.SetChannel( frequency );
-
-    // Radio configuration
-    if( dr == DR_7 )
-    {
-        modem = MODEM_FSK;
-        Radio.SetRxConfig( modem, 50000, phyDr * 1000, 0, 83333, 5, rxConfig->WindowTimeout, false, 0, true, 0, 0, false, rxConfig->RxContinuous );
-    }
-    else
-    {
-        modem = MODEM_LORA;
-        Radio.SetRxConfig( modem, rxConfig->Bandwidth, phyDr, 1, 0, 8, rxConfig->WindowTimeout, false, 0, false, 0, 0, true, rxConfig->RxContinuous );
-    }
-
-    if( rxConfig->RepeaterSupport == true )
-    {
-        maxPayload = MaxPayloadOfDatarateRepeaterCN779[dr];
-    }
-    else
-    {
-        maxPayload = MaxPayloadOfDatarateCN779[dr];
-    }
-    Radio.SetMaxPayloadLength( modem, maxPayload + LORA_MAC_FRMPAYLOAD_OVERHEAD );
-
-    *datarate = (uint8_t) dr;
-    return true;
+    return RegionDynamicRxConfig( &RegionCN779, rxConfig, datarate );
 }
 
 bool RegionCN779TxConfig( TxConfigParams_t* txConfig, int8_t* txPower, TimerTime_t* txTimeOnAir )
 {
-    RadioModems_t modem;
-    int8_t phyDr = DataratesCN779[txConfig->Datarate];
-    int8_t txPowerLimited = LimitTxPower( txConfig->TxPower, NvmCtx.Bands[NvmCtx.Channels[txConfig->Channel].Band].TxMaxPower, txConfig->Datarate, NvmCtx.ChannelsMask );
-    uint32_t bandwidth = GetBandwidth( txConfig->Datarate );
-    int8_t phyTxPower = 0;
-
-    // Calculate physical TX power
-    phyTxPower = RegionCommonComputeTxPower( txPowerLimited, txConfig->MaxEirp, txConfig->AntennaGain );
-
-    // Setup the radio frequency
-    Radio.SetChannel( NvmCtx.Channels[txConfig->Channel].Frequency );
-
-    if( txConfig->Datarate == DR_7 )
-    { // High Speed FSK channel
-        modem = MODEM_FSK;
-        Radio.SetTxConfig( modem, phyTxPower, 25000, bandwidth, phyDr * 1000, 0, 5, false, true, 0, 0, false, 4000 );
-    }
-    else
-    {
-        modem = MODEM_LORA;
-        Radio.SetTxConfig( modem, phyTxPower, 0, bandwidth, phyDr, 1, 8, false, true, 0, 0, false, 4000 );
-    }
-
-    // Setup maximum payload lenght of the radio driver
-    Radio.SetMaxPayloadLength( modem, txConfig->PktLen );
-    // Get the time-on-air of the next tx frame
-    *txTimeOnAir = Radio.TimeOnAir( modem, txConfig->PktLen );
-
-    *txPower = txPowerLimited;
-    return true;
+    return RegionDynamicTxConfig( &RegionCN779, txConfig, txPower, txTimeOnAir );
 }
 
 uint8_t RegionCN779LinkAdrReq( LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, int8_t* txPowOut, uint8_t* nbRepOut, uint8_t* nbBytesParsed )
 {
-    uint8_t status = 0x07;
-    RegionCommonLinkAdrParams_t linkAdrParams;
-    uint8_t nextIndex = 0;
-    uint8_t bytesProcessed = 0;
-    uint16_t chMask = 0;
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
-    RegionCommonLinkAdrReqVerifyParams_t linkAdrVerifyParams;
-
-    while( bytesProcessed < linkAdrReq->PayloadSize )
-    {
-        // Get ADR request parameters
-        nextIndex = RegionCommonParseLinkAdrReq( &( linkAdrReq->Payload[bytesProcessed] ), &linkAdrParams );
-
-        if( nextIndex == 0 )
-            break; // break loop, since no more request has been found
-
-        // Update bytes processed
-        bytesProcessed += nextIndex;
-
-        // Revert status, as we only check the last ADR request for the channel mask KO
-        status = 0x07;
-
-        // Setup temporary channels mask
-        chMask = linkAdrParams.ChMask;
-
-        // Verify channels mask
-        if( ( linkAdrParams.ChMaskCtrl == 0 ) && ( chMask == 0 ) )
-        {
-            status &= 0xFE; // Channel mask KO
-        }
-        else if( ( ( linkAdrParams.ChMaskCtrl >= 1 ) && ( linkAdrParams.ChMaskCtrl <= 5 )) ||
-                ( linkAdrParams.ChMaskCtrl >= 7 ) )
-        {
-            // RFU
-            status &= 0xFE; // Channel mask KO
-        }
-        else
-        {
-            for( uint8_t i = 0; i < CN779_MAX_NB_CHANNELS; i++ )
-            {
-                if( linkAdrParams.ChMaskCtrl == 6 )
-                {
-                    if( NvmCtx.Channels[i].Frequency != 0 )
-                    {
-                        chMask |= 1 << i;
-                    }
-                }
-                else
-                {
-                    if( ( ( chMask & ( 1 << i ) ) != 0 ) &&
-                        ( NvmCtx.Channels[i].Frequency == 0 ) )
-                    {// Trying to enable an undefined channel
-                        status &= 0xFE; // Channel mask KO
-                    }
-                }
-            }
-        }
-    }
-
-    // Get the minimum possible datarate
-    getPhy.Attribute = PHY_MIN_TX_DR;
-    getPhy.UplinkDwellTime = linkAdrReq->UplinkDwellTime;
-    phyParam = RegionCN779GetPhyParam( &getPhy );
-
-    linkAdrVerifyParams.Status = status;
-    linkAdrVerifyParams.AdrEnabled = linkAdrReq->AdrEnabled;
-    linkAdrVerifyParams.Datarate = linkAdrParams.Datarate;
-    linkAdrVerifyParams.TxPower = linkAdrParams.TxPower;
-    linkAdrVerifyParams.NbRep = linkAdrParams.NbRep;
-    linkAdrVerifyParams.CurrentDatarate = linkAdrReq->CurrentDatarate;
-    linkAdrVerifyParams.CurrentTxPower = linkAdrReq->CurrentTxPower;
-    linkAdrVerifyParams.CurrentNbRep = linkAdrReq->CurrentNbRep;
-    linkAdrVerifyParams.NbChannels = CN779_MAX_NB_CHANNELS;
-    linkAdrVerifyParams.ChannelsMask = &chMask;
-    linkAdrVerifyParams.MinDatarate = ( int8_t )phyParam.Value;
-    linkAdrVerifyParams.MaxDatarate = CN779_TX_MAX_DATARATE;
-    linkAdrVerifyParams.Channels = NvmCtx.Channels;
-    linkAdrVerifyParams.MinTxPower = CN779_MIN_TX_POWER;
-    linkAdrVerifyParams.MaxTxPower = CN779_MAX_TX_POWER;
-    linkAdrVerifyParams.Version = linkAdrReq->Version;
-
-    // Verify the parameters and update, if necessary
-    status = RegionCommonLinkAdrReqVerifyParams( &linkAdrVerifyParams, &linkAdrParams.Datarate, &linkAdrParams.TxPower, &linkAdrParams.NbRep );
-
-    // Update channelsMask if everything is correct
-    if( status == 0x07 )
-    {
-        // Set the channels mask to a default value
-        memset1( ( uint8_t* ) NvmCtx.ChannelsMask, 0, sizeof( NvmCtx.ChannelsMask ) );
-        // Update the channels mask
-        NvmCtx.ChannelsMask[0] = chMask;
-    }
-
-    // Update status variables
-    *drOut = linkAdrParams.Datarate;
-    *txPowOut = linkAdrParams.TxPower;
-    *nbRepOut = linkAdrParams.NbRep;
-    *nbBytesParsed = bytesProcessed;
-
-    return status;
+    return RegionDynamicLinkAdrReq( &RegionCN779, linkAdrReq, drOut, txPowOut, nbRepOut, nbBytesParsed );
 }
 
 uint8_t RegionCN779RxParamSetupReq( RxParamSetupReqParams_t* rxParamSetupReq )
 {
-    uint8_t status = 0x07;
-
-    // Verify radio frequency
-    if( VerifyRfFreq( rxParamSetupReq->Frequency ) == false )
-    {
-        status &= 0xFE; // Channel frequency KO
-    }
-
-    // Verify datarate
-    if( RegionCommonValueInRange( rxParamSetupReq->Datarate, CN779_RX_MIN_DATARATE, CN779_RX_MAX_DATARATE ) == false )
-    {
-        status &= 0xFD; // Datarate KO
-    }
-
-    // Verify datarate offset
-    if( RegionCommonValueInRange( rxParamSetupReq->DrOffset, CN779_MIN_RX1_DR_OFFSET, CN779_MAX_RX1_DR_OFFSET ) == false )
-    {
-        status &= 0xFB; // Rx1DrOffset range KO
-    }
-
-    return status;
+    return RegionDynamicRxParamSetupReq( &RegionCN779, rxParamSetupReq );
 }
 
 uint8_t RegionCN779NewChannelReq( NewChannelReqParams_t* newChannelReq )
 {
-    uint8_t status = 0x03;
-    ChannelAddParams_t channelAdd;
-    ChannelRemoveParams_t channelRemove;
-
-    if( newChannelReq->NewChannel->Frequency == 0 )
-    {
-        channelRemove.ChannelId = newChannelReq->ChannelId;
-
-        // Remove
-        if( RegionCN779ChannelsRemove( &channelRemove ) == false )
-        {
-            status &= 0xFC;
-        }
-    }
-    else
-    {
-        channelAdd.NewChannel = newChannelReq->NewChannel;
-        channelAdd.ChannelId = newChannelReq->ChannelId;
-
-        switch( RegionCN779ChannelAdd( &channelAdd ) )
-        {
-            case LORAMAC_STATUS_OK:
-            {
-                break;
-            }
-            case LORAMAC_STATUS_FREQUENCY_INVALID:
-            {
-                status &= 0xFE;
-                break;
-            }
-            case LORAMAC_STATUS_DATARATE_INVALID:
-            {
-                status &= 0xFD;
-                break;
-            }
-            case LORAMAC_STATUS_FREQ_AND_DR_INVALID:
-            {
-                status &= 0xFC;
-                break;
-            }
-            default:
-            {
-                status &= 0xFC;
-                break;
-            }
-        }
-    }
-
-    return status;
+    return RegionDynamicNewChannelReq( &RegionCN779, newChannelReq );
 }
 
 int8_t RegionCN779TxParamSetupReq( TxParamSetupReqParams_t* txParamSetupReq )
@@ -813,27 +187,7 @@ int8_t RegionCN779TxParamSetupReq( TxParamSetupReqParams_t* txParamSetupReq )
 
 uint8_t RegionCN779DlChannelReq( DlChannelReqParams_t* dlChannelReq )
 {
-    uint8_t status = 0x03;
-
-    // Verify if the frequency is supported
-    if( VerifyRfFreq( dlChannelReq->Rx1Frequency ) == false )
-    {
-        status &= 0xFE;
-    }
-
-    // Verify if an uplink frequency exists
-    if( NvmCtx.Channels[dlChannelReq->ChannelId].Frequency == 0 )
-    {
-        status &= 0xFD;
-    }
-
-    // Apply Rx1 frequency, if the status is OK
-    if( status == 0x03 )
-    {
-        NvmCtx.Channels[dlChannelReq->ChannelId].Rx1Frequency = dlChannelReq->Rx1Frequency;
-    }
-
-    return status;
+    return RegionDynamicDlChannelReq( &RegionCN779, dlChannelReq );
 }
 
 int8_t RegionCN779AlternateDr( int8_t currentDr, AlternateDrType_t type )
@@ -843,186 +197,35 @@ int8_t RegionCN779AlternateDr( int8_t currentDr, AlternateDrType_t type )
 
 void RegionCN779CalcBackOff( CalcBackOffParams_t* calcBackOff )
 {
-    RegionCommonCalcBackOffParams_t calcBackOffParams;
-
-    calcBackOffParams.Channels = NvmCtx.Channels;
-    calcBackOffParams.Bands = NvmCtx.Bands;
-    calcBackOffParams.LastTxIsJoinRequest = calcBackOff->LastTxIsJoinRequest;
-    calcBackOffParams.Joined = calcBackOff->Joined;
-    calcBackOffParams.DutyCycleEnabled = calcBackOff->DutyCycleEnabled;
-    calcBackOffParams.Channel = calcBackOff->Channel;
-    calcBackOffParams.ElapsedTime = calcBackOff->ElapsedTime;
-    calcBackOffParams.TxTimeOnAir = calcBackOff->TxTimeOnAir;
-
-    RegionCommonCalcBackOff( &calcBackOffParams );
+    RegionDynamicCalcBackOff( &RegionCN779, calcBackOff );
 }
 
 LoRaMacStatus_t RegionCN779NextChannel( NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff )
 {
-    uint8_t nbEnabledChannels = 0;
-    uint8_t delayTx = 0;
-    uint8_t enabledChannels[CN779_MAX_NB_CHANNELS] = { 0 };
-    TimerTime_t nextTxDelay = 0;
-
-    if( RegionCommonCountChannels( NvmCtx.ChannelsMask, 0, 1 ) == 0 )
-    { // Reactivate default channels
-        NvmCtx.ChannelsMask[0] |= LC( 1 ) + LC( 2 ) + LC( 3 );
-    }
-
-    TimerTime_t elapsed = TimerGetElapsedTime( nextChanParams->LastAggrTx );
-    if( ( nextChanParams->LastAggrTx == 0 ) || ( nextChanParams->AggrTimeOff <= elapsed ) )
-    {
-        // Reset Aggregated time off
-        *aggregatedTimeOff = 0;
-
-        // Update bands Time OFF
-        nextTxDelay = RegionCommonUpdateBandTimeOff( nextChanParams->Joined, nextChanParams->DutyCycleEnabled, NvmCtx.Bands, CN779_MAX_NB_BANDS );
-
-        // Search how many channels are enabled
-        nbEnabledChannels = CountNbOfEnabledChannels( nextChanParams->Joined, nextChanParams->Datarate,
-                                                      NvmCtx.ChannelsMask, NvmCtx.Channels,
-                                                      NvmCtx.Bands, enabledChannels, &delayTx );
-    }
-    else
-    {
-        delayTx++;
-        nextTxDelay = nextChanParams->AggrTimeOff - elapsed;
-    }
-
-    if( nbEnabledChannels > 0 )
-    {
-        // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
-
-        *time = 0;
-        return LORAMAC_STATUS_OK;
-    }
-    else
-    {
-        if( delayTx > 0 )
-        {
-            // Delay transmission due to AggregatedTimeOff or to a band time off
-            *time = nextTxDelay;
-            return LORAMAC_STATUS_DUTYCYCLE_RESTRICTED;
-        }
-        // Datarate not supported by any channel, restore defaults
-        NvmCtx.ChannelsMask[0] |= LC( 1 ) + LC( 2 ) + LC( 3 );
-        *time = 0;
-        return LORAMAC_STATUS_NO_CHANNEL_FOUND;
-    }
+    return RegionDynamicNextChannel( &RegionCN779, nextChanParams, channel, time, aggregatedTimeOff );
 }
 
 LoRaMacStatus_t RegionCN779ChannelAdd( ChannelAddParams_t* channelAdd )
 {
-    bool drInvalid = false;
-    bool freqInvalid = false;
-    uint8_t id = channelAdd->ChannelId;
-
-    if( id < CN779_NUMB_DEFAULT_CHANNELS )
-    {
-        return LORAMAC_STATUS_FREQ_AND_DR_INVALID;
-    }
-
-    if( id >= CN779_MAX_NB_CHANNELS )
-    {
-        return LORAMAC_STATUS_PARAMETER_INVALID;
-    }
-
-    // Validate the datarate range
-    if( RegionCommonValueInRange( channelAdd->NewChannel->DrRange.Fields.Min, CN779_TX_MIN_DATARATE, CN779_TX_MAX_DATARATE ) == false )
-    {
-        drInvalid = true;
-    }
-    if( RegionCommonValueInRange( channelAdd->NewChannel->DrRange.Fields.Max, CN779_TX_MIN_DATARATE, CN779_TX_MAX_DATARATE ) == false )
-    {
-        drInvalid = true;
-    }
-    if( channelAdd->NewChannel->DrRange.Fields.Min > channelAdd->NewChannel->DrRange.Fields.Max )
-    {
-        drInvalid = true;
-    }
-
-    // Check frequency
-    if( freqInvalid == false )
-    {
-        if( VerifyRfFreq( channelAdd->NewChannel->Frequency ) == false )
-        {
-            freqInvalid = true;
-        }
-    }
-
-    // Check status
-    if( ( drInvalid == true ) && ( freqInvalid == true ) )
-    {
-        return LORAMAC_STATUS_FREQ_AND_DR_INVALID;
-    }
-    if( drInvalid == true )
-    {
-        return LORAMAC_STATUS_DATARATE_INVALID;
-    }
-    if( freqInvalid == true )
-    {
-        return LORAMAC_STATUS_FREQUENCY_INVALID;
-    }
-
-    memcpy1( ( uint8_t* ) &(NvmCtx.Channels[id]), ( uint8_t* ) channelAdd->NewChannel, sizeof( NvmCtx.Channels[id] ) );
-    NvmCtx.Channels[id].Band = 0;
-    NvmCtx.ChannelsMask[0] |= ( 1 << id );
-    return LORAMAC_STATUS_OK;
+    return RegionDynamicChannelAdd( &RegionCN779, channelAdd );
 }
 
-bool RegionCN779ChannelsRemove( ChannelRemoveParams_t* channelRemove  )
+bool RegionCN779ChannelsRemove( ChannelRemoveParams_t* channelRemove )
 {
-    uint8_t id = channelRemove->ChannelId;
-
-    if( id < CN779_NUMB_DEFAULT_CHANNELS )
-    {
-        return false;
-    }
-
-    // Remove the channel from the list of channels
-    NvmCtx.Channels[id] = ( ChannelParams_t ){ 0, 0, { 0 }, 0 };
-
-    return RegionCommonChanDisable( NvmCtx.ChannelsMask, id, CN779_MAX_NB_CHANNELS );
+    return RegionDynamicChannelsRemove( &RegionCN779, channelRemove );
 }
 
 void RegionCN779SetContinuousWave( ContinuousWaveParams_t* continuousWave )
 {
-    int8_t txPowerLimited = LimitTxPower( continuousWave->TxPower, NvmCtx.Bands[NvmCtx.Channels[continuousWave->Channel].Band].TxMaxPower, continuousWave->Datarate, NvmCtx.ChannelsMask );
-    int8_t phyTxPower = 0;
-    uint32_t frequency = NvmCtx.Channels[continuousWave->Channel].Frequency;
-
-    // Calculate physical TX power
-    phyTxPower = RegionCommonComputeTxPower( txPowerLimited, continuousWave->MaxEirp, continuousWave->AntennaGain );
-
-    Radio.SetTxContinuousWave( frequency, phyTxPower, continuousWave->Timeout );
+    RegionDynamicSetContinuousWave( &RegionCN779, continuousWave );
 }
 
 uint8_t RegionCN779ApplyDrOffset( uint8_t downlinkDwellTime, int8_t dr, int8_t drOffset )
 {
-    int8_t datarate = dr - drOffset;
-
-    if( datarate < 0 )
-    {
-        datarate = DR_0;
-    }
-    return datarate;
+    return RegionDynamicApplyDrOffset( downlinkDwellTime, dr, drOffset );
 }
 
 void RegionCN779RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
 {
-    RegionCommonRxBeaconSetupParams_t regionCommonRxBeaconSetup;
-
-    regionCommonRxBeaconSetup.Datarates = DataratesCN779;
-    regionCommonRxBeaconSetup.Frequency = rxBeaconSetup->Frequency;
-    regionCommonRxBeaconSetup.BeaconSize = CN779_BEACON_SIZE;
-    regionCommonRxBeaconSetup.BeaconDatarate = CN779_BEACON_CHANNEL_DR;
-    regionCommonRxBeaconSetup.BeaconChannelBW = CN779_BEACON_CHANNEL_BW;
-    regionCommonRxBeaconSetup.RxTime = rxBeaconSetup->RxTime;
-    regionCommonRxBeaconSetup.SymbolTimeout = rxBeaconSetup->SymbolTimeout;
-
-    RegionCommonRxBeaconSetup( &regionCommonRxBeaconSetup );
-
-    // Store downlink datarate
-    *outDr = CN779_BEACON_CHANNEL_DR;
+    RegionDynamicRxBeaconSetup( &RegionCN779, rxBeaconSetup, outDr );
 }
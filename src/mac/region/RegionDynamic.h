@@ -0,0 +1,504 @@
+/*!
+ * \file      RegionDynamic.h
+ *
+ * \brief     Shared implementation of the regions with a dynamic channel plan
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \defgroup  REGIONDYNAMIC Dynamic channel plan region engine
+ *            Implementation shared by the regions with an EU868 like dynamic
+ *            channel plan: up to 16 channels, default channels which cannot
+ *            be removed, channels added by the CFList or NewChannelReq, and
+ *            DR_7 FSK. The regions only provide a constant
+ *            \ref RegionDynamicParams_t descriptor and forward their API to
+ *            the engine, so that enabling several of them costs their tables
+ *            only.
+ *
+ *            The engine holds a single non-volatile context, sized for the
+ *            largest region. It belongs to the region in use.
+ * \{
+ */
+#ifndef __REGION_DYNAMIC_H__
+#define __REGION_DYNAMIC_H__
+
+#include "region/Region.h"
+
+/*!
+ * Maximum number of channels of the dynamic channel plan regions
+ */
+#define REGION_DYNAMIC_MAX_NB_CHANNELS              16
+
+/*!
+ * Maximum number of bands of the dynamic channel plan regions
+ */
+#define REGION_DYNAMIC_MAX_NB_BANDS                 6
+
+/*!
+ * Frequency range of a band
+ */
+typedef struct sRegionDynamicFreqRange
+{
+    /*!
+     * Lowest frequency of the range [Hz], included
+     */
+    uint32_t MinFreq;
+    /*!
+     * Highest frequency of the range [Hz], included
+     */
+    uint32_t MaxFreq;
+    /*!
+     * Band of the channels in the range
+     */
+    uint8_t Band;
+}RegionDynamicFreqRange_t;
+
+/*!
+ * Region descriptor
+ */
+typedef struct sRegionDynamicParams
+{
+    /*!
+     * Maximum number of channels, up to \ref REGION_DYNAMIC_MAX_NB_CHANNELS
+     */
+    uint8_t MaxNbChannels;
+    /*!
+     * Number of default channels
+     */
+    uint8_t NbDefaultChannels;
+    /*!
+     * Number of channels of the CFList
+     */
+    uint8_t NbChannelsCfList;
+    /*!
+     * Default channels, NbDefaultChannels entries
+     */
+    const ChannelParams_t* DefaultChannels;
+    /*!
+     * Mask of the channels used by the join requests
+     */
+    uint16_t JoinChannels;
+    /*!
+     * Number of bands, up to \ref REGION_DYNAMIC_MAX_NB_BANDS
+     */
+    uint8_t NbBands;
+    /*!
+     * Bands, NbBands entries
+     */
+    const Band_t* Bands;
+    /*!
+     * Number of frequency ranges
+     */
+    uint8_t NbFreqRanges;
+    /*!
+     * Allowed frequency ranges and their band, NbFreqRanges entries
+     */
+    const RegionDynamicFreqRange_t* FreqRanges;
+    /*!
+     * Datarates table, indexed by datarate
+     */
+    const uint8_t* Datarates;
+    /*!
+     * Bandwidths table [Hz], indexed by datarate
+     */
+    const uint32_t* Bandwidths;
+    /*!
+     * Maximum payload table, indexed by datarate
+     */
+    const uint8_t* MaxPayloadOfDatarate;
+    /*!
+     * Maximum payload table with repeater support, indexed by datarate
+     */
+    const uint8_t* MaxPayloadOfDatarateRepeater;
+    /*!
+     * Minimal uplink datarate
+     */
+    int8_t TxMinDatarate;
+    /*!
+     * Maximal uplink datarate
+     */
+    int8_t TxMaxDatarate;
+    /*!
+     * Minimal downlink datarate
+     */
+    int8_t RxMinDatarate;
+    /*!
+     * Maximal downlink datarate
+     */
+    int8_t RxMaxDatarate;
+    /*!
+     * Default datarate
+     */
+    int8_t DefaultDatarate;
+    /*!
+     * Minimal RX1 datarate offset
+     */
+    uint8_t MinRx1DrOffset;
+    /*!
+     * Maximal RX1 datarate offset
+     */
+    uint8_t MaxRx1DrOffset;
+    /*!
+     * Default RX1 datarate offset
+     */
+    uint8_t DefaultRx1DrOffset;
+    /*!
+     * Minimal Tx output power
+     */
+    int8_t MinTxPower;
+    /*!
+     * Maximal Tx output power
+     */
+    int8_t MaxTxPower;
+    /*!
+     * Default Tx output power
+     */
+    int8_t DefaultTxPower;
+    /*!
+     * Default maximum EIRP [dBm]
+     */
+    float DefaultMaxEirp;
+    /*!
+     * Default antenna gain [dBi]
+     */
+    float DefaultAntennaGain;
+    /*!
+     * ADR Ack limit
+     */
+    uint16_t AdrAckLimit;
+    /*!
+     * ADR Ack delay
+     */
+    uint16_t AdrAckDelay;
+    /*!
+     * Duty cycle enforced
+     */
+    bool DutyCycleEnabled;
+    /*!
+     * Maximum RX window duration [ms]
+     */
+    uint32_t MaxRxWindow;
+    /*!
+     * Receive delay 1 [ms]
+     */
+    uint32_t ReceiveDelay1;
+    /*!
+     * Receive delay 2 [ms]
+     */
+    uint32_t ReceiveDelay2;
+    /*!
+     * Join accept delay 1 [ms]
+     */
+    uint32_t JoinAcceptDelay1;
+    /*!
+     * Join accept delay 2 [ms]
+     */
+    uint32_t JoinAcceptDelay2;
+    /*!
+     * Maximum frame counter gap
+     */
+    uint32_t MaxFCntGap;
+    /*!
+     * Ack timeout [ms]
+     */
+    uint32_t AckTimeout;
+    /*!
+     * Random ack timeout limits [ms]
+     */
+    int32_t AckTimeoutRnd;
+    /*!
+     * RX2 default frequency [Hz]
+     */
+    uint32_t Rx2Frequency;
+    /*!
+     * RX2 default datarate
+     */
+    int8_t Rx2Datarate;
+    /*!
+     * Beacon frequency [Hz]
+     */
+    uint32_t BeaconFrequency;
+    /*!
+     * Beacon size
+     */
+    uint8_t BeaconSize;
+    /*!
+     * Size of the RFU 1 field of the beacon
+     */
+    uint8_t Rfu1Size;
+    /*!
+     * Size of the RFU 2 field of the beacon
+     */
+    uint8_t Rfu2Size;
+    /*!
+     * Datarate of the beacon channel
+     */
+    int8_t BeaconDatarate;
+    /*!
+     * Bandwidth of the beacon channel, index of the bandwidths table
+     */
+    uint8_t BeaconBandwidth;
+    /*!
+     * Datarate of the ping slot channel
+     */
+    int8_t PingSlotDatarate;
+}RegionDynamicParams_t;
+
+/*!
+ * \brief The function gets a value of a specific phy attribute.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] getPhy Pointer to the function parameters.
+ *
+ * \retval Returns a structure containing the PHY parameter.
+ */
+PhyParam_t RegionDynamicGetPhyParam( const RegionDynamicParams_t* region, GetPhyParams_t* getPhy );
+
+/*!
+ * \brief Updates the last TX done parameters of the current channel.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] txDone Pointer to the function parameters.
+ */
+void RegionDynamicSetBandTxDone( const RegionDynamicParams_t* region, SetBandTxDoneParams_t* txDone );
+
+/*!
+ * \brief Initializes the channels masks and the channels.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] params Sets the initialization type.
+ */
+void RegionDynamicInitDefaults( const RegionDynamicParams_t* region, InitDefaultsParams_t* params );
+
+/*!
+ * \brief Returns a pointer to the internal context and its size.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [OUT] params Pointer to the function parameters.
+ *
+ * \retval      Points to a structure where the module store its non-volatile context.
+ */
+void* RegionDynamicGetNvmCtx( const RegionDynamicParams_t* region, GetNvmCtxParams_t* params );
+
+/*!
+ * \brief Verifies a parameter.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] verify Pointer to the function parameters.
+ *
+ * \param [IN] phyAttribute Sets the initialization type.
+ *
+ * \retval Returns true, if the parameter is valid.
+ */
+bool RegionDynamicVerify( const RegionDynamicParams_t* region, VerifyParams_t* verify, PhyAttribute_t phyAttribute );
+
+/*!
+ * \brief The function parses the input buffer and sets up the channels of the
+ *        CF list.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] applyCFList Pointer to the function parameters.
+ */
+void RegionDynamicApplyCFList( const RegionDynamicParams_t* region, ApplyCFListParams_t* applyCFList );
+
+/*!
+ * \brief Sets a channels mask.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] chanMaskSet Pointer to the function parameters.
+ *
+ * \retval Returns true, if the channels mask could be set.
+ */
+bool RegionDynamicChanMaskSet( const RegionDynamicParams_t* region, ChanMaskSetParams_t* chanMaskSet );
+
+/*!
+ * Computes the Rx window timeout and offset.
+ *
+ * \param [IN] region         Region descriptor.
+ *
+ * \param [IN] datarate       Rx window datarate index to be used
+ *
+ * \param [IN] minRxSymbols   Minimum required number of symbols to detect an Rx frame.
+ *
+ * \param [IN] rxError        System maximum timing error of the receiver. In milliseconds
+ *                            The receiver will turn on in a [-rxError : +rxError] ms
+ *                            interval around RxOffset
+ *
+ * \param [OUT]rxConfigParams Returns updated WindowTimeout and WindowOffset fields.
+ */
+void RegionDynamicComputeRxWindowParameters( const RegionDynamicParams_t* region, int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams );
+
+/*!
+ * \brief Configuration of the RX windows.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] rxConfig Pointer to the function parameters.
+ *
+ * \param [OUT] datarate The datarate index which was set.
+ *
+ * \retval Returns true, if the configuration was applied successfully.
+ */
+bool RegionDynamicRxConfig( const RegionDynamicParams_t* region, RxConfigParams_t* rxConfig, int8_t* datarate );
+
+/*!
+ * \brief TX configuration.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] txConfig Pointer to the function parameters.
+ *
+ * \param [OUT] txPower The tx power index which was set.
+ *
+ * \param [OUT] txTimeOnAir The time-on-air of the frame.
+ *
+ * \retval Returns true, if the configuration was applied successfully.
+ */
+bool RegionDynamicTxConfig( const RegionDynamicParams_t* region, TxConfigParams_t* txConfig, int8_t* txPower, TimerTime_t* txTimeOnAir );
+
+/*!
+ * \brief The function processes a Link ADR Request.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] linkAdrReq Pointer to the function parameters.
+ *
+ * \retval Returns the status of the operation, according to the LoRaMAC specification.
+ */
+uint8_t RegionDynamicLinkAdrReq( const RegionDynamicParams_t* region, LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, int8_t* txPowOut, uint8_t* nbRepOut, uint8_t* nbBytesParsed );
+
+/*!
+ * \brief The function processes a RX Parameter Setup Request.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] rxParamSetupReq Pointer to the function parameters.
+ *
+ * \retval Returns the status of the operation, according to the LoRaMAC specification.
+ */
+uint8_t RegionDynamicRxParamSetupReq( const RegionDynamicParams_t* region, RxParamSetupReqParams_t* rxParamSetupReq );
+
+/*!
+ * \brief The function processes a Channel Request.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] newChannelReq Pointer to the function parameters.
+ *
+ * \retval Returns the status of the operation, according to the LoRaMAC specification.
+ */
+uint8_t RegionDynamicNewChannelReq( const RegionDynamicParams_t* region, NewChannelReqParams_t* newChannelReq );
+
+/*!
+ * \brief The function processes a DlChannel Request.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] dlChannelReq Pointer to the function parameters.
+ *
+ * \retval Returns the status of the operation, according to the LoRaMAC specification.
+ */
+uint8_t RegionDynamicDlChannelReq( const RegionDynamicParams_t* region, DlChannelReqParams_t* dlChannelReq );
+
+/*!
+ * \brief Calculates the back-off time.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] calcBackOff Pointer to the function parameters.
+ */
+void RegionDynamicCalcBackOff( const RegionDynamicParams_t* region, CalcBackOffParams_t* calcBackOff );
+
+/*!
+ * \brief Searches and set the next random available channel
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [OUT] channel Next channel to use for TX.
+ *
+ * \param [OUT] time Time to wait for the next transmission according to the duty
+ *              cycle.
+ *
+ * \param [OUT] aggregatedTimeOff Updates the aggregated time off.
+ *
+ * \retval Function status [1: OK, 0: Unable to find a channel on the current datarate]
+ */
+LoRaMacStatus_t RegionDynamicNextChannel( const RegionDynamicParams_t* region, NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff );
+
+/*!
+ * \brief Adds a channel.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] channelAdd Pointer to the function parameters.
+ *
+ * \retval Status of the operation.
+ */
+LoRaMacStatus_t RegionDynamicChannelAdd( const RegionDynamicParams_t* region, ChannelAddParams_t* channelAdd );
+
+/*!
+ * \brief Removes a channel.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] channelRemove Pointer to the function parameters.
+ *
+ * \retval Returns true, if the channel was removed successfully.
+ */
+bool RegionDynamicChannelsRemove( const RegionDynamicParams_t* region, ChannelRemoveParams_t* channelRemove );
+
+/*!
+ * \brief Sets the radio into continuous wave mode.
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] continuousWave Pointer to the function parameters.
+ */
+void RegionDynamicSetContinuousWave( const RegionDynamicParams_t* region, ContinuousWaveParams_t* continuousWave );
+
+/*!
+ * \brief Computes new datarate according to the given offset
+ *
+ * \param [IN] downlinkDwellTime Downlink dwell time configuration. 0: No limit, 1: 400ms
+ *
+ * \param [IN] dr Current datarate
+ *
+ * \param [IN] drOffset Offset to be applied
+ *
+ * \retval newDr Computed datarate.
+ */
+uint8_t RegionDynamicApplyDrOffset( uint8_t downlinkDwellTime, int8_t dr, int8_t drOffset );
+
+/*!
+ * \brief Sets the radio into beacon reception mode
+ *
+ * \param [IN] region Region descriptor.
+ *
+ * \param [IN] rxBeaconSetup Pointer to the function parameters
+ *
+ * \param [OUT] outDr Datarate used to receive the beacon
+ */
+void RegionDynamicRxBeaconSetup( const RegionDynamicParams_t* region, RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
+
+/*! \} defgroup REGIONDYNAMIC */
+
+#endif // __REGION_DYNAMIC_H__
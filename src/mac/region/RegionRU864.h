@@ -219,6 +219,11 @@
  */
 #define RU864_BEACON_CHANNEL_BW                     0
 
+/*!
+ * Ping slot channel datarate
+ */
+#define RU864_PING_SLOT_CHANNEL_DR                  DR_3
+
 /*!
  * Maximum number of bands
  */
@@ -68,6 +68,12 @@ void AES_CMAC_SetKey(AES_CMAC_CTX *ctx, const uint8_t key[AES_CMAC_KEY_LENGTH])
        aes_set_key( key, AES_CMAC_KEY_LENGTH, &ctx->rijndael);
 }
     
+void AES_CMAC_Restart(AES_CMAC_CTX *ctx)
+{
+    memset1(ctx->X, 0, sizeof ctx->X);
+    ctx->M_n = 0;
+}
+
 void AES_CMAC_Update(AES_CMAC_CTX *ctx, const uint8_t *data, uint32_t len)
 {
             uint32_t mlen;
@@ -53,6 +53,8 @@ typedef struct _AES_CMAC_CTX {
 //__BEGIN_DECLS
 void     AES_CMAC_Init(AES_CMAC_CTX * ctx);
 void     AES_CMAC_SetKey(AES_CMAC_CTX * ctx, const uint8_t key[AES_CMAC_KEY_LENGTH]);
+/* Restarts a computation keeping the key schedule set by AES_CMAC_SetKey */
+void     AES_CMAC_Restart(AES_CMAC_CTX * ctx);
 void     AES_CMAC_Update(AES_CMAC_CTX * ctx, const uint8_t * data, uint32_t len);
           //          __attribute__((__bounded__(__string__,2,3)));
 void     AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX  * ctx);
@@ -81,6 +81,13 @@ static SecureElementNvCtx_t SeNvmCtx;
 
 static SecureElementNvmEvent SeNvmCtxChanged;
 
+/*
+ * Identifiers of the keys currently expanded into the AES and CMAC contexts.
+ * The key schedule computation is skipped when the same key is used again.
+ */
+static KeyIdentifier_t AesContextKeyID = NO_KEY;
+static KeyIdentifier_t CmacContextKeyID = NO_KEY;
+
 /*
  * Local functions
  */
@@ -115,6 +122,23 @@ static void DummyCB( void )
     return;
 }
 
+/*
+ * Invalidates the AES and CMAC contexts key schedules computed with the given key
+ *
+ * \param[IN]  keyID          - Key identifier. NO_KEY invalidates all contexts
+ */
+static void InvalidateKeySchedules( KeyIdentifier_t keyID )
+{
+    if( ( keyID == NO_KEY ) || ( AesContextKeyID == keyID ) )
+    {
+        AesContextKeyID = NO_KEY;
+    }
+    if( ( keyID == NO_KEY ) || ( CmacContextKeyID == keyID ) )
+    {
+        CmacContextKeyID = NO_KEY;
+    }
+}
+
 /*
  * Computes a CMAC of a message using provided initial Bx block
  *
@@ -136,14 +160,21 @@ static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer,
 
     uint8_t Cmac[16];
 
-    AES_CMAC_Init( SeNvmCtx.AesCmacCtx );
-
     Key_t* keyItem;
     SecureElementStatus_t retval = GetKeyByID( keyID, &keyItem );
 
     if( retval == SECURE_ELEMENT_SUCCESS )
     {
-        AES_CMAC_SetKey( SeNvmCtx.AesCmacCtx, keyItem->KeyValue );
+        if( CmacContextKeyID != keyID )
+        {
+            AES_CMAC_Init( SeNvmCtx.AesCmacCtx );
+            AES_CMAC_SetKey( SeNvmCtx.AesCmacCtx, keyItem->KeyValue );
+            CmacContextKeyID = keyID;
+        }
+        else
+        {
+            AES_CMAC_Restart( SeNvmCtx.AesCmacCtx );
+        }
 
         if( micBxBuffer != NULL )
         {
@@ -202,6 +233,8 @@ SecureElementStatus_t SecureElementInit( SecureElementNvmEvent seNvmCtxChanged )
     memset1( SeNvmCtx.DevEui, 0, SE_EUI_SIZE );
     memset1( SeNvmCtx.JoinEui, 0, SE_EUI_SIZE );
 
+    InvalidateKeySchedules( NO_KEY );
+
     // Assign callback
     if( seNvmCtxChanged != 0 )
     {
@@ -221,6 +254,7 @@ SecureElementStatus_t SecureElementRestoreNvmCtx( void* seNvmCtx )
     if( seNvmCtx != 0 )
     {
         memcpy1( ( uint8_t* ) &SeNvmCtx, ( uint8_t* ) seNvmCtx, sizeof( SeNvmCtx ) );
+        InvalidateKeySchedules( NO_KEY );
         return SECURE_ELEMENT_SUCCESS;
     }
     else
@@ -254,6 +288,7 @@ SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
                 retval = SecureElementAesEncrypt( key, 16, MC_KE_KEY, decryptedKey );
 
                 memcpy1( SeNvmCtx.KeyList[i].KeyValue, decryptedKey, KEY_SIZE );
+                InvalidateKeySchedules( keyID );
                 SeNvmCtxChanged( );
 
                 return retval;
@@ -261,6 +296,7 @@ SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
             else
             {
                 memcpy1( SeNvmCtx.KeyList[i].KeyValue, key, KEY_SIZE );
+                InvalidateKeySchedules( keyID );
                 SeNvmCtxChanged( );
                 return SECURE_ELEMENT_SUCCESS;
             }
@@ -317,14 +353,17 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
         return SECURE_ELEMENT_ERROR_BUF_SIZE;
     }
 
-    memset1( SeNvmCtx.AesContext.ksch, '\0', 240 );
-
     Key_t* pItem;
     SecureElementStatus_t retval = GetKeyByID( keyID, &pItem );
 
     if( retval == SECURE_ELEMENT_SUCCESS )
     {
-        aes_set_key( pItem->KeyValue, 16, &SeNvmCtx.AesContext );
+        if( AesContextKeyID != keyID )
+        {
+            memset1( SeNvmCtx.AesContext.ksch, '\0', 240 );
+            aes_set_key( pItem->KeyValue, 16, &SeNvmCtx.AesContext );
+            AesContextKeyID = keyID;
+        }
 
         uint8_t block = 0;
 
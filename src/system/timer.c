@@ -46,6 +46,11 @@
  */
 static TimerEvent_t *TimerListHead = NULL;
 
+/*!
+ * Programmed alarm deadline, relative to the RTC timer context
+ */
+static uint32_t TimerAlarmDeadline = 0;
+
 /*!
  * \brief Adds or replace the head timer of the list.
  *
@@ -75,6 +80,15 @@ static void TimerInsertTimer( TimerEvent_t *obj );
  */
 static void TimerSetTimeout( TimerEvent_t *obj );
 
+/*!
+ * \brief Computes the latest alarm deadline meeting the expiry time and
+ *        slack of every timer in the list
+ *
+ * \param [IN] obj Head of the list
+ * \retval deadline Alarm deadline
+ */
+static uint32_t TimerGetDeadline( TimerEvent_t *obj );
+
 /*!
  * \brief Check if the Object to be added is not already in the list
  *
@@ -87,6 +101,7 @@ void TimerInit( TimerEvent_t *obj, void ( *callback )( void *context ) )
 {
     obj->Timestamp = 0;
     obj->ReloadValue = 0;
+    obj->Slack = 0;
     obj->IsStarted = false;
     obj->IsNext2Expire = false;
     obj->Callback = callback;
@@ -133,6 +148,13 @@ void TimerStart( TimerEvent_t *obj )
         else
         {
             TimerInsertTimer( obj );
+
+            // The new timer may not wait for the programmed alarm
+            if( ( TimerListHead->IsNext2Expire == true ) &&
+                ( ( obj->Timestamp + obj->Slack ) < TimerAlarmDeadline ) )
+            {
+                TimerSetTimeout( TimerListHead );
+            }
         }
     }
     CRITICAL_SECTION_END( );
@@ -217,7 +239,7 @@ void TimerIrqHandler( void )
     }
 
     // Remove all the expired object from the list
-    while( ( TimerListHead != NULL ) && ( TimerListHead->Timestamp < RtcGetTimerElapsedTime( ) ) )
+    while( ( TimerListHead != NULL ) && ( TimerListHead->Timestamp <= RtcGetTimerElapsedTime( ) ) )
     {
         cur = TimerListHead;
         TimerListHead = TimerListHead->Next;
@@ -343,6 +365,11 @@ void TimerSetValue( TimerEvent_t *obj, uint32_t value )
     obj->ReloadValue = ticks;
 }
 
+void TimerSetSlack( TimerEvent_t *obj, uint32_t slack )
+{
+    obj->Slack = RtcMs2Tick( slack );
+}
+
 TimerTime_t TimerGetCurrentTime( void )
 {
     uint32_t now = RtcGetTimerValue( );
@@ -372,7 +399,24 @@ static void TimerSetTimeout( TimerEvent_t *obj )
     {
         obj->Timestamp = RtcGetTimerElapsedTime( ) + minTicks;
     }
-    RtcSetAlarm( obj->Timestamp );
+    TimerAlarmDeadline = TimerGetDeadline( obj );
+    RtcSetAlarm( TimerAlarmDeadline );
+}
+
+static uint32_t TimerGetDeadline( TimerEvent_t *obj )
+{
+    TimerEvent_t* cur = obj->Next;
+    uint32_t deadline = obj->Timestamp + obj->Slack;
+
+    // The list is sorted, only the timers expiring before the deadline may
+    // advance it
+    while( ( cur != NULL ) && ( cur->Timestamp < deadline ) )
+    {
+        deadline = MIN( deadline, cur->Timestamp + cur->Slack );
+        cur = cur->Next;
+    }
+    // Never before the head expiry
+    return MAX( deadline, obj->Timestamp );
 }
 
 TimerTime_t TimerTempCompensation( TimerTime_t period, float temperature )
@@ -34,6 +34,7 @@ typedef struct TimerEvent_s
 {
     uint32_t Timestamp;                  //! Current timer value
     uint32_t ReloadValue;                //! Timer delay value
+    uint32_t Slack;                      //! Allowed expiry delay
     bool IsStarted;                      //! Is the timer currently running
     bool IsNext2Expire;                  //! Is the next timer to expire
     void ( *Callback )( void* context ); //! Timer IRQ callback function
@@ -112,6 +113,20 @@ void TimerReset( TimerEvent_t *obj );
  */
 void TimerSetValue( TimerEvent_t *obj, uint32_t value );
 
+/*!
+ * \brief Sets the timer slack
+ *
+ * \remark The timer may expire up to slack milliseconds late, so that it is
+ *         handled on the same wake up as the other timers expiring in the
+ *         meantime. Timers are exact by default (slack 0). Timing critical
+ *         timers (e.g. RX windows, ping slots) must keep a slack of 0.
+ *         Takes effect on the next TimerStart.
+ *
+ * \param [IN] obj   Structure containing the timer object parameters
+ * \param [IN] slack Maximum expiry delay [ms]
+ */
+void TimerSetSlack( TimerEvent_t *obj, uint32_t slack );
+
 /*!
  * \brief Read the current time
  *